@@ -7,18 +7,27 @@
 * \brief The FoamGrid class
 */
 
+#include <algorithm>
 #include <list>
 #include <set>
+#include <utility>
+#include <vector>
 
 #include <dune/common/parallel/collectivecommunication.hh>
 #include <dune/common/tuples.hh>
 #include <dune/common/stdstreams.hh>
+#include <dune/grid/common/backuprestore.hh>
 #include <dune/grid/common/capabilities.hh>
 #include <dune/grid/common/grid.hh>
 
 // Implementation classes
 #include "foamgrid/foamgridvertex.hh"
 #include "foamgrid/foamgridedge.hh"
+#include "foamgrid/foamgridentitystorage.hh"
+#include "foamgrid/foamgridadjacency.hh"
+#include "foamgrid/foamgridcoordinates.hh"
+#include "foamgrid/foamgridboundingboxtree.hh"
+#include "foamgrid/foamgridmemoryusage.hh"
 //#include "foamgrid/foamgridelements.hh""
 
 // The components of the FoamGrid interface
@@ -36,18 +45,18 @@
 namespace Dune {
 
 // Forward declaration
-template <int dimworld>
+template <int dimworld, class ct = double>
 class FoamGrid;
 
 
 /** \brief Encapsulates loads of types exported by FoamGrid */
-template<int dimworld>
+template<int dimworld, class ct = double>
 struct FoamGridFamily
 {
     typedef GridTraits<
         1,   // dim
         dimworld,   // dimworld
-        Dune::FoamGrid<dimworld>,
+        Dune::FoamGrid<dimworld, ct>,
         FoamGridGeometry,
         FoamGridEntity,
         FoamGridEntityPointer,
@@ -58,13 +67,13 @@ struct FoamGridFamily
         FoamGridLevelIntersectionIterator,
         FoamGridHierarchicIterator,
         FoamGridLeafIterator,
-        FoamGridLevelIndexSet< const FoamGrid<dimworld> >,
-        FoamGridLeafIndexSet< const FoamGrid<dimworld> >,
-        FoamGridIdSet< const FoamGrid<dimworld> >,  // global IdSet
+        FoamGridLevelIndexSet< const FoamGrid<dimworld, ct> >,
+        FoamGridLeafIndexSet< const FoamGrid<dimworld, ct> >,
+        FoamGridIdSet< const FoamGrid<dimworld, ct> >,  // global IdSet
         unsigned int,   // global id type
-        FoamGridIdSet< const FoamGrid<dimworld> >,  // local IdSet
+        FoamGridIdSet< const FoamGrid<dimworld, ct> >,  // local IdSet
         unsigned int,   // local id type
-        CollectiveCommunication<Dune::FoamGrid<dimworld> > ,
+        CollectiveCommunication<Dune::FoamGrid<dimworld, ct> > ,
         FoamGridLevelGridViewTraits,
         FoamGridLeafGridViewTraits,
         FoamGridEntitySeed
@@ -76,10 +85,11 @@ struct FoamGridFamily
 /** \brief An implementation of the Dune grid interface: a 2d simplicial grid in an n-dimensional world
  *
 * \tparam dimworld Dimension of the world space
+* \tparam ct The type used for the coordinates
 */
-template <int dimworld>
+template <int dimworld, class ct>
 class FoamGrid :
-        public GridDefaultImplementation  <1, dimworld, double, FoamGridFamily<dimworld> >
+        public GridDefaultImplementation  <1, dimworld, ct, FoamGridFamily<dimworld, ct> >
 {
 
     friend class FoamGridLevelIndexSet<const FoamGrid >;
@@ -99,6 +109,8 @@ class FoamGrid :
     template <class GridType_>
     friend class GridFactory;
 
+    friend struct BackupRestoreFacility<FoamGrid>;
+
     template<int codim_, int dim_, class GridImp_>
     friend class FoamGridEntity;
 
@@ -120,20 +132,23 @@ class FoamGrid :
     //**********************************************************
 
     //! type of the used GridFamily for this grid
-    typedef FoamGridFamily<dimworld>  GridFamily;
+    typedef FoamGridFamily<dimworld, ct>  GridFamily;
 
     //! Exports various types belonging to this grid class
-    typedef typename FoamGridFamily<dimworld>::Traits Traits;
+    typedef typename FoamGridFamily<dimworld, ct>::Traits Traits;
 
     //! The type used to store coordinates
-    typedef double ctype;
+    typedef ct ctype;
 
     /** \brief Constructor, constructs an empty grid
      */
     FoamGrid()
         : leafGridView_(*this),
           globalRefined(),
-          numBoundarySegments_()
+          numBoundarySegments_(),
+          indexGeneration_(0),
+          compactionThreshold_(0.25),
+          bytesReclaimed_(0)
     {
         std::fill(freeIdCounter_.begin(), freeIdCounter_.end(), 0);
     }
@@ -161,7 +176,7 @@ class FoamGrid :
             if (level<0 || level>maxLevel())
                 DUNE_THROW(Dune::GridError, "LevelIterator in nonexisting level " << level << " requested!");
 
-            return Dune::FoamGridLevelIterator<codim,All_Partition, const Dune::FoamGrid<dimworld> >(Dune::get<dimension-codim>(entityImps_[level]).begin());
+            return Dune::FoamGridLevelIterator<codim,All_Partition, const Dune::FoamGrid<dimworld, ct> >(Dune::get<dimension-codim>(entityImps_[level]).begin());
         }
 
 
@@ -171,7 +186,7 @@ class FoamGrid :
             if (level<0 || level>maxLevel())
                 DUNE_THROW(GridError, "LevelIterator in nonexisting level " << level << " requested!");
 
-            return Dune::FoamGridLevelIterator<codim,All_Partition, const Dune::FoamGrid<dimworld> >(Dune::get<dimension-codim>(entityImps_[level]).end());
+            return Dune::FoamGridLevelIterator<codim,All_Partition, const Dune::FoamGrid<dimworld, ct> >(Dune::get<dimension-codim>(entityImps_[level]).end());
         }
 
 
@@ -181,7 +196,7 @@ class FoamGrid :
             if (level<0 || level>maxLevel())
                 DUNE_THROW(Dune::GridError, "LevelIterator in nonexisting level " << level << " requested!");
 
-            return Dune::FoamGridLevelIterator<codim,PiType, const Dune::FoamGrid<dimworld> >(Dune::get<dimension-codim>(entityImps_[level]).begin());
+            return Dune::FoamGridLevelIterator<codim,PiType, const Dune::FoamGrid<dimworld, ct> >(Dune::get<dimension-codim>(entityImps_[level]).begin());
         }
 
 
@@ -191,7 +206,7 @@ class FoamGrid :
             if (level<0 || level>maxLevel())
                 DUNE_THROW(GridError, "LevelIterator in nonexisting level " << level << " requested!");
 
-            return Dune::FoamGridLevelIterator<codim,PiType, const Dune::FoamGrid<dimworld> >(Dune::get<dimension-codim>(entityImps_[level]).end());
+            return Dune::FoamGridLevelIterator<codim,PiType, const Dune::FoamGrid<dimworld, ct> >(Dune::get<dimension-codim>(entityImps_[level]).end());
         }
 
 
@@ -289,6 +304,57 @@ class FoamGrid :
         }
 
 
+        /** \brief Where the leaf entities come from, relative to the leaf grid before the last adapt()
+         *
+         * Use it to carry data attached to the leaf entities over to the adapted grid.
+         * The map is invalid unless the leaf grid was last changed by adapt(), grow()
+         * or flatten().
+         */
+        const FoamGridLeafIndexMap<dimension>& leafIndexMap() const
+        {
+            return leafIndexSet().indexMap_;
+        }
+
+
+        /** \brief How the leaf entities are numbered, see FoamGridLeafOrdering */
+        FoamGridLeafOrdering leafOrdering() const
+        {
+            return leafIndexSet().ordering();
+        }
+
+
+        /** \brief Change how the leaf entities are numbered, see FoamGridLeafOrdering
+         *
+         * The leaf indices are recomputed right away, which invalidates the leaf index map.
+         */
+        void setLeafOrdering(FoamGridLeafOrdering ordering);
+
+
+        /** \brief Vertex coordinates and element connectivity of the leaf grid, in leaf index order
+         *
+         * The store is filled on first access after the indices have changed.  Hence this
+         * method is not thread-safe; call it once before sharing the store between threads.
+         */
+        const FoamGridCoordinateStore<dimworld,ctype>& leafCoordinates() const;
+
+
+        /** \brief Vertex coordinates and element connectivity of a level, in level index order
+         *
+         * The store is filled on first access after the indices have changed.  Hence this
+         * method is not thread-safe; call it once before sharing the store between threads.
+         */
+        const FoamGridCoordinateStore<dimworld,ctype>& levelCoordinates(int level) const;
+
+
+        /** \brief The memory used by the grid, per level and codim and per data structure
+         *
+         * The cost is proportional to the number of levels, so it can be logged after
+         * every adaptation step.  GridFactory::memoryUsage() reports the memory of the
+         * factory.
+         */
+        FoamGridMemoryUsage memoryUsage() const;
+
+
         //! View for the leaf grid
         template<PartitionIteratorType pitype>
         typename Traits::template Partition<pitype>::LeafGridView
@@ -324,6 +390,7 @@ class FoamGrid :
 
         /** \brief Refine the grid uniformly
          * \param refCount Number of times the grid is to be refined uniformly
+         * \throw InvalidStateException if changes are queued for grow()
         */
         void globalRefine (int refCount);
 
@@ -344,11 +411,11 @@ class FoamGrid :
 
             /** \todo Why do I need those const_casts here? */
             if (refCount>=1)
-                const_cast<FoamGridEntityImp<2,dimworld>*>(this->getRealImplementation(*e).target_)->markState_ = FoamGridEntityImp<2,dimworld>::REFINE;
+                const_cast<FoamGridEntityImp<1,dimworld,ctype>*>(this->getRealImplementation(*e).target_)->markState_ = FoamGridEntityImp<1,dimworld,ctype>::REFINE;
             else if (refCount<0)
-                const_cast<FoamGridEntityImp<2,dimworld>*>(this->getRealImplementation(*e).target_)->markState_ = FoamGridEntityImp<2,dimworld>::COARSEN;
+                const_cast<FoamGridEntityImp<1,dimworld,ctype>*>(this->getRealImplementation(*e).target_)->markState_ = FoamGridEntityImp<1,dimworld,ctype>::COARSEN;
             else
-                const_cast<FoamGridEntityImp<2,dimworld>*>(this->getRealImplementation(*e).target_)->markState_ = FoamGridEntityImp<2,dimworld>::DO_NOTHING;
+                const_cast<FoamGridEntityImp<1,dimworld,ctype>*>(this->getRealImplementation(*e).target_)->markState_ = FoamGridEntityImp<1,dimworld,ctype>::DO_NOTHING;
 
             return true;
         }
@@ -359,9 +426,9 @@ class FoamGrid :
         */
         int getMark(const typename Traits::template Codim<0>::EntityPointer & e) const
         {
-            if (this->getRealImplementation(*e).target_->markState_ == FoamGridEntityImp<2,dimworld>::REFINE)
+            if (this->getRealImplementation(*e).target_->markState_ == FoamGridEntityImp<1,dimworld,ctype>::REFINE)
                 return 1;
-            if (this->getRealImplementation(*e).target_->markState_ == FoamGridEntityImp<2,dimworld>::COARSEN)
+            if (this->getRealImplementation(*e).target_->markState_ == FoamGridEntityImp<1,dimworld,ctype>::COARSEN)
                 return -1;
 
             return 0;
@@ -371,11 +438,140 @@ class FoamGrid :
         bool preAdapt();
 
         //! Triggers the grid refinement process
+        //! \throw InvalidStateException if changes are queued for grow()
         bool adapt();
 
         /** \brief Clean up refinement markers */
         void postAdapt();
 
+        /** \brief Make the leaf grid the new macro grid and release all coarser levels
+         *
+         * The leaf entities are copied to a new level 0 in leaf index order.  They keep
+         * their leaf indices, their ids and their boundary segment indices, so the level
+         * indices of level 0 equal the leaf indices afterwards, and the leaf index map
+         * records every entity as kept.  The elements have no father anymore and cannot
+         * be coarsened beyond this grid.
+         *
+         * All entities, entity pointers and iterators of the grid are invalidated.
+         * Refinement marks are dropped.  Call it when the grid will not be coarsened
+         * again, to save the memory of the hierarchy.
+         */
+        void flatten();
+
+        /** \brief Move the entities of every level into dense storage
+         *
+         * Coarsening and grow() leave dead slots in the entity storage of the levels,
+         * which are never reused.  This relocates the live entities of each level with
+         * dead slots into as few blocks as possible, keeping their order, and rewrites
+         * all pointers between the entities.  Indices and ids do not change, but all
+         * entities, entity pointers and iterators of the grid are invalidated.
+         *
+         * \return The number of bytes of entity storage released
+         */
+        std::size_t compactStorage();
+
+        /** \brief The number of bytes released by the compaction in the last postAdapt() */
+        std::size_t bytesReclaimed() const
+        {
+            return bytesReclaimed_;
+        }
+
+        /** \brief The fraction of dead slots above which postAdapt() compacts a level
+         *
+         * The default is 0.25.  A threshold of 1 or more disables the compaction
+         * in postAdapt().
+         */
+        double compactionThreshold() const
+        {
+            return compactionThreshold_;
+        }
+
+        /** \brief Set the fraction of dead slots above which postAdapt() compacts a level */
+        void setCompactionThreshold(double threshold)
+        {
+            compactionThreshold_ = threshold;
+        }
+
+        /*@}*/
+
+        /** @name Runtime growth of the network
+         *
+         * New vertices and elements are queued with insertVertex() and insertElement(),
+         * leaf elements are queued for removal with removeElement(), and grow() applies
+         * all of them at once.  Like adapt(), grow() marks the inserted elements as new
+         * and records the changes of the leaf indices in leafIndexMap(); call postAdapt()
+         * afterwards.  The cost is proportional to the number of queued changes, except
+         * that removing elements renumbers the levels they lived on.
+         *
+         * An inserted element lives on the level of the coarsest copies of the leaf
+         * vertices it is attached to, and has no father.  Only elements without father
+         * can be removed.  The grid cannot be adapted, refined or flattened while changes
+         * are queued.  Elements and removals that grow() cannot apply are rejected when
+         * they are queued, leaving the queues unchanged.
+         */
+        /*@{*/
+
+        /** \brief Queue a new vertex for the next call to grow()
+         *
+         * \return The number of the vertex in this growth step, to refer to it in insertElement()
+         */
+        unsigned int insertVertex(const FieldVector<ctype,dimworld>& pos)
+        {
+            growthVertices_.push_back(pos);
+            growthComponents_.push_back(growthVertices_.size()-1);
+            growthLevels_.push_back(-1);
+            return growthVertices_.size()-1;
+        }
+
+        /** \brief Queue a new element from a leaf vertex to a queued vertex
+         *
+         * \return The number of the element in this growth step
+         */
+        unsigned int insertElement(const typename Traits::template Codim<dimension>::Entity& vertex,
+                                   unsigned int newVertex)
+        {
+            return insertElement(growthVertex(vertex), growthVertex(newVertex));
+        }
+
+        /** \brief Queue a new element between two queued vertices */
+        unsigned int insertElement(unsigned int newVertex0, unsigned int newVertex1)
+        {
+            return insertElement(growthVertex(newVertex0), growthVertex(newVertex1));
+        }
+
+        /** \brief Queue a new element between two leaf vertices */
+        unsigned int insertElement(const typename Traits::template Codim<dimension>::Entity& vertex0,
+                                   const typename Traits::template Codim<dimension>::Entity& vertex1)
+        {
+            return insertElement(growthVertex(vertex0), growthVertex(vertex1));
+        }
+
+        /** \brief Queue a leaf element for removal by the next call to grow()
+         *
+         * \throw GridError if the element is not a leaf or already queued
+         * \throw NotImplemented if the element has a father
+         */
+        void removeElement(const typename Traits::template Codim<0>::Entity& element)
+        {
+            FoamGridEntityImp<1,dimworld,ctype>* target
+                = const_cast<FoamGridEntityImp<1,dimworld,ctype>*>(this->getRealImplementation(element).target_);
+            if (!target->isLeaf())
+                DUNE_THROW(GridError, "Only leaf elements can be removed");
+            if (target->father_)
+                DUNE_THROW(NotImplemented, "Only leaf elements without father can be removed");
+            if (std::find(growthRemovals_.begin(), growthRemovals_.end(), target) != growthRemovals_.end())
+                DUNE_THROW(GridError, "The element is already queued for removal");
+            growthRemovals_.push_back(target);
+        }
+
+        /** \brief Insert and remove the queued vertices and elements
+         *
+         * Queued vertices that are not used by a queued element are dropped.
+         *
+         * \return Whether the grid has changed
+         */
+        bool grow();
+
         /*@}*/
 
         /** @name Methods for parallel computations */
@@ -456,40 +652,78 @@ class FoamGrid :
 
     private:
 
-        //! \brief erases pointers in father elements to vanished entities of the element
-        void erasePointersToEntities(std::list<FoamGridEntityImp<2,dimworld> >& elements);
-
         //! \brief Erase Entities from memory that vanished due to coarsening.
-        //! \warning This method has to be called first for i=0.
         //! \tparam i The dimension of the entities.
         //! \param  levelEntities The vector with the level entitied
         template<int i>
-        void eraseVanishedEntities(std::list<FoamGridEntityImp<i,dimworld> >& levelEntities);
+        void eraseVanishedEntities(FoamGridEntityStorage<FoamGridEntityImp<i,dimworld,ctype> >& levelEntities);
 
-    //! \brief Coarsen an Element
+    //! \brief Whether an element marked for coarsening can be coarsened
+    //!
+    //! This is the case if it has a father and its sibling is a leaf
+    //! that is marked for coarsening as well.
+    bool mayCoarsen(const FoamGridEntityImp<1,dimworld,ctype>& element) const;
+
+    //! \brief Coarsen an Element, i.e. remove it and its sibling
     //! \param element The element to coarsen
-    void coarsenSimplexElement(FoamGridEntityImp<2,dimworld>& element);
+    void coarsenLineElement(FoamGridEntityImp<1,dimworld,ctype>& element);
 
-    //! \brief refine an Element
+    //! \brief Bisect an element
     //! \param element The element to refine
     //! \param refCount How many times to refine the element
-    void refineSimplexElement(FoamGridEntityImp<2,dimworld>& element,
-                       int refCount);
+    void refineLineElement(FoamGridEntityImp<1,dimworld,ctype>& element, int refCount);
+
+    //! \brief Make sure that a level exists, create it and its index set otherwise
+    void addLevel(std::size_t level);
 
-    //void refineLineElement(FoamGridEntityImp<1,dimworld>& element, int refCount);
+    //! \brief Move the entities of a level into dense storage and rewrite the pointers to them
+    //! \pre The level indices of the level are up to date
+    //! \return The number of bytes of entity storage released
+    std::size_t compactLevel(int level);
 
-    /**
-     * \brief Overwrites the neighbours of this and descendant edges
+    /** \brief An end point of an element queued by insertElement()
      *
-     * After returning all neighbours the previously pointed to the
-     * father will point to the son element
-     * \param edge The edge to start overwriting with.
-     * \param son The son element to substitute the father with.
-     * \param father Pointer to the father element that is to be substituted.
+     * Either the coarsest copy of a leaf vertex, or a null pointer and the number of
+     * a queued vertex.
      */
-    void overwriteFineLevelNeighbours(FoamGridEntityImp<1,dimworld>& edge,
-                                      FoamGridEntityImp<2,dimworld>* son,
-                                      FoamGridEntityImp<2,dimworld>* father);
+    struct GrowthVertex
+    {
+        const FoamGridEntityImp<0,dimworld,ctype>* vertex;
+        unsigned int newVertex;
+    };
+
+    //! \brief Queue an element between two end points, return its number
+    //! \throw GridError if both end points are at the same position
+    //! \throw NotImplemented if the end points are on different levels
+    unsigned int insertElement(const GrowthVertex& vertex0, const GrowthVertex& vertex1);
+
+    //! \brief The representative of the queued vertices connected to a queued vertex
+    unsigned int growthComponent(unsigned int newVertex);
+
+    //! \brief The end point for a leaf vertex
+    GrowthVertex growthVertex(const typename Traits::template Codim<dimension>::Entity& vertex) const;
+
+    //! \brief The end point for a queued vertex
+    GrowthVertex growthVertex(unsigned int newVertex) const
+    {
+        if (newVertex >= growthVertices_.size())
+            DUNE_THROW(GridError, "Vertex " << newVertex << " has not been queued by insertVertex()");
+        GrowthVertex result = {nullptr, newVertex};
+        return result;
+    }
+
+    //! \brief Give the boundary vertices touched by grow() consecutive boundary segment indices
+    //! \param touched The coarsest copies of the old vertices whose number of elements may have changed,
+    //!                 and whether each was on the boundary before
+    //! \param inserted The inserted vertices
+    void updateBoundarySegments(std::vector<std::pair<FoamGridEntityImp<0,dimworld,ctype>*, bool> >& touched,
+                                const std::vector<FoamGridEntityImp<0,dimworld,ctype>*>& inserted);
+
+    //! \brief The coarsest copy of a vertex
+    static const FoamGridEntityImp<0,dimworld,ctype>* coarsestCopy(const FoamGridEntityImp<0,dimworld,ctype>* vertex);
+
+    //! \brief Set the boundary segment index of a vertex and of all its finer copies
+    static void setBoundaryId(FoamGridEntityImp<0,dimworld,ctype>& vertex, unsigned int id);
 
     template<class C, class T>
     void check_for_duplicates(C& cont, const T& elem, std::size_t vertexIndex)
@@ -503,12 +737,20 @@ class FoamGrid :
         //! compute the grid indices and ids
     void setIndices();
 
+    //! \brief Rebuild the vertex-to-element adjacency of a level
+    //! \pre The level indices of the vertices are up to date
+    void updateAdjacency(int level);
+
         //! Collective communication interface
         typename Traits::CollectiveCommunication ccobj_;
 
-    // Stores the lists of vertices, edges, elements for each level
-    std::vector<tuple<std::list<FoamGridEntityImp<0,dimworld> >,
-                      std::list<FoamGridEntityImp<1,dimworld> > > > entityImps_;
+    /** \brief The vertices, the elements and the vertex-to-element adjacency of one level */
+    typedef tuple<FoamGridEntityStorage<FoamGridEntityImp<0,dimworld,ctype> >,
+                  FoamGridEntityStorage<FoamGridEntityImp<1,dimworld,ctype> >,
+                  FoamGridLevelAdjacency<dimworld,ctype> > LevelEntities;
+
+    // Stores the vertices, elements and adjacency for each level
+    std::vector<LevelEntities> entityImps_;
 
         //! Our set of level indices
         std::vector<FoamGridLevelIndexSet<const FoamGrid>*> levelIndexSets_;
@@ -532,6 +774,39 @@ class FoamGrid :
 
     // True if the last call to preadapt returned true
     bool willCoarsen;
+
+    /** \brief Incremented whenever the level and leaf indices are recomputed */
+    unsigned long indexGeneration_;
+
+    /** \brief The fraction of dead slots above which postAdapt() compacts a level */
+    double compactionThreshold_;
+
+    /** \brief The bytes released by the compaction in the last postAdapt() */
+    std::size_t bytesReclaimed_;
+
+    /** \brief The vertices queued by insertVertex() */
+    std::vector<FieldVector<ctype,dimworld> > growthVertices_;
+
+    /** \brief For each queued vertex another one connected to it by queued elements
+     *
+     * The representatives of these components point to themselves.
+     */
+    std::vector<unsigned int> growthComponents_;
+
+    /** \brief For the representative of a component the level of its vertices, or -1 if unknown */
+    std::vector<int> growthLevels_;
+
+    /** \brief The end points of the elements queued by insertElement() */
+    std::vector<array<GrowthVertex,2> > growthElements_;
+
+    /** \brief The elements queued by removeElement() */
+    std::vector<FoamGridEntityImp<1,dimworld,ctype>*> growthRemovals_;
+
+    /** \brief Cached coordinates of the leaf grid, see leafCoordinates() */
+    mutable FoamGridCoordinateStore<dimworld,ctype> leafCoordinates_;
+
+    /** \brief Cached coordinates of each level, see levelCoordinates() */
+    mutable std::vector<FoamGridCoordinateStore<dimworld,ctype> > levelCoordinates_;
 }; // end Class FoamGrid
 
 #include "foamgrid/foamgrid.cc"
@@ -543,8 +818,8 @@ namespace Capabilities
       *
       * FoamGrid implements all codimensions, hence this is always true
       */
-    template<int dimworld,int codim>
-    struct hasEntity< FoamGrid<dimworld>, codim>
+    template<int dimworld, class ct, int codim>
+    struct hasEntity< FoamGrid<dimworld, ct>, codim>
     {
         static const bool v = true;
     };
@@ -552,23 +827,32 @@ namespace Capabilities
 
     /** \brief True if the grid can be run on a distributed machine
       */
-    template <int dimworld>
-    struct isParallel< FoamGrid<dimworld> >
+    template <int dimworld, class ct>
+    struct isParallel< FoamGrid<dimworld, ct> >
     {
         static const bool v = false;
     };
 
 
+    /** \brief FoamGrid can be written to and restored from a binary backup
+      */
+    template<int dimworld, class ct>
+    struct hasBackupRestoreFacilities< FoamGrid<dimworld, ct> >
+    {
+        static const bool v = true;
+    };
+
+
     //! \todo Please doc me !
-    template<int dimworld>
-    struct isLevelwiseConforming< FoamGrid<dimworld> >
+    template<int dimworld, class ct>
+    struct isLevelwiseConforming< FoamGrid<dimworld, ct> >
     {
         static const bool v = false;
     };
 
     //! \todo Please doc me !
-    template<int dimworld>
-    struct isLeafwiseConforming< FoamGrid<dimworld> >
+    template<int dimworld, class ct>
+    struct isLeafwiseConforming< FoamGrid<dimworld, ct> >
     {
         static const bool v = false;
     };
@@ -581,5 +865,23 @@ namespace Capabilities
 // However since the factory needs to know the grid the include directive
 // comes here at the end.
 #include "foamgrid/foamgridfactory.hh"
+#include "foamgrid/foamgridbackuprestore.hh"
+
+// The grid is compiled into libdunefoamgrid for these world dimensions and
+// coordinate types, see lib/dunefoamgrid.cc.  Define DUNE_FOAMGRID_HEADER_ONLY
+// to instantiate it in every translation unit instead.
+#ifndef DUNE_FOAMGRID_HEADER_ONLY
+namespace Dune {
+
+extern template class FoamGrid<1>;
+extern template class FoamGrid<2>;
+extern template class FoamGrid<3>;
+
+extern template class FoamGrid<1, float>;
+extern template class FoamGrid<2, float>;
+extern template class FoamGrid<3, float>;
+
+} // namespace Dune
+#endif
 
 #endif
@@ -1,39 +1,17 @@
 // Refine the grid uniformly
-template <int dimworld>
-void Dune::FoamGrid<dimworld>::globalRefine (int refCount)
+template <int dimworld, class ct>
+void Dune::FoamGrid<dimworld,ct>::globalRefine (int refCount)
 {
+  if (!growthVertices_.empty() || !growthElements_.empty() || !growthRemovals_.empty())
+    DUNE_THROW(InvalidStateException, "globalRefine() called while changes are queued for grow()");
+
   willCoarsen=false;
 
   if (maxLevel()+refCount<0)
     DUNE_THROW(GridError, "Grid has only " << maxLevel() << " levels. Cannot do "
                            << " globalRefine(" << refCount << ")");
 
-  // The leafiterator is simply successively visiting all levels from fine to coarse
-  // and just checking whether the isLeaf flag is set. Using it to identify
-  // elements that need refinement would produce an endless loop, as the newly
-  // added elements
-  // would later be identified as elements that still need refinement.
   std::size_t oldLevels =entityImps_.size();
-  typedef typename
-    std::vector<tuple<std::list<FoamGridEntityImp<0,dimworld> >,
-                      std::list<FoamGridEntityImp<1,dimworld> >,
-                      std::list<FoamGridEntityImp<2,dimworld> > > >::reverse_iterator
-                LevelIterator;
-
-  // Allocate space for the new levels. Thus the rend iterator will not get
-  // invalid due to newly added levels.
-  entityImps_.reserve(oldLevels+refCount);
-  levelIndexSets_.reserve(oldLevels+refCount);
-  LevelIterator level = entityImps_.rbegin();
-
-  // Add tuples for the new levels.
-  for (int i=0; i < refCount; ++i)
-  {
-    entityImps_.push_back(tuple<std::list<FoamGridEntityImp<0,dimworld> >,
-                                std::list<FoamGridEntityImp<1,dimworld> >,
-                                std::list<FoamGridEntityImp<2,dimworld> > >());
-    levelIndexSets_.push_back(new FoamGridLevelIndexSet<const FoamGrid >());
-  }
 
   if (refCount < 0)
   {
@@ -55,6 +33,8 @@ void Dune::FoamGrid<dimworld>::globalRefine (int refCount)
         postAdapt();
       }
 
+      // The index map only describes the last of the steps
+      leafGridView_.indexSet_.indexMap_.invalidate();
       globalRefined=0;
       return;
     }
@@ -70,34 +50,21 @@ void Dune::FoamGrid<dimworld>::globalRefine (int refCount)
 
       // To be able to create the leaf level we need to set
       // the sons of the entities of maxlevel to null
-      typename std::list<FoamGridEntityImp<0,dimworld> >::iterator vIt
+      typename FoamGridEntityStorage<FoamGridEntityImp<0,dimworld,ctype> >::iterator vIt
         = Dune::get<0>(entityImps_[maxLevel()]).begin();
-      typename std::list<FoamGridEntityImp<0,dimworld> >::iterator vEndIt
+      typename FoamGridEntityStorage<FoamGridEntityImp<0,dimworld,ctype> >::iterator vEndIt
         = Dune::get<0>(entityImps_[maxLevel()]).end();
       for (; vIt!=vEndIt; ++vIt)
         vIt->son_=nullptr;
 
-      typename std::list<FoamGridEntityImp<1,dimworld> >::iterator edIt
+      typename FoamGridEntityStorage<FoamGridEntityImp<1,dimworld,ctype> >::iterator elIt
         = Dune::get<1>(entityImps_[maxLevel()]).begin();
-      typename std::list<FoamGridEntityImp<1,dimworld> >::iterator edEndIt
+      typename FoamGridEntityStorage<FoamGridEntityImp<1,dimworld,ctype> >::iterator elEndIt
         = Dune::get<1>(entityImps_[maxLevel()]).end();
-      for (; edIt!=edEndIt; ++edIt)
-      {
-        edIt->sons_[0]=nullptr;
-        edIt->sons_[1]=nullptr;
-        edIt->nSons_=0;
-      }
-
-      typename std::list<FoamGridEntityImp<2,dimworld> >::iterator elIt
-        = Dune::get<2>(entityImps_[maxLevel()]).begin();
-      typename std::list<FoamGridEntityImp<2,dimworld> >::iterator elEndIt
-        = Dune::get<2>(entityImps_[maxLevel()]).end();
       for (; elIt!=elEndIt; ++elIt)
       {
         elIt->sons_[0]=nullptr;
         elIt->sons_[1]=nullptr;
-        elIt->sons_[2]=nullptr;
-        elIt->sons_[3]=nullptr;
         elIt->nSons_=0;
       }
     }
@@ -105,40 +72,26 @@ void Dune::FoamGrid<dimworld>::globalRefine (int refCount)
   }
   else
   {
-    // sanity check whether the above asssumption really holds.
-    assert(&entityImps_[oldLevels-1]==&(*level));
+    // Create all new levels up front. The storage iterators used below
+    // would become invalid if entityImps_ was reallocated.
+    addLevel(oldLevels-1+refCount);
 
-    // Do the actual refinement.
-    // We start with the finest level
-    std::size_t levelIndex;
-    for (levelIndex=oldLevels-1; level!=entityImps_.rend(); ++level, --levelIndex)
+    // Refine the leaf elements of all old levels, from fine to coarse.  The sons
+    // are appended to the next finer level, which has been visited already.
+    for (std::size_t level=oldLevels; level-- > 0; )
     {
-      typedef typename std::list<FoamGridEntityImp<2,dimworld> >::iterator ElementIterator;
-      bool foundLeaf=false;
+      typedef typename FoamGridEntityStorage<FoamGridEntityImp<1,dimworld,ctype> >::iterator ElementIterator;
 
-      for (ElementIterator element=Dune::get<2>(*level).begin(); element != Dune::get<2>(*level).end(); ++element)
-        if(element->isLeaf())
-        {
-          foundLeaf = true;
-          dverb << "refining element " << &(*element) << std::endl;
-          if (element->type().isTriangle())
-            refineSimplexElement(*element, refCount);
-// 	  if (element->type().isLine())
-// 	    refineLineElement(*element,refCount);
-          else
-            DUNE_THROW(NotImplemented, "Refinement only supported for triangles!");
-        }
-
-      if (!foundLeaf)
-        break;
+      for (ElementIterator element=Dune::get<1>(entityImps_[level]).begin();
+           element != Dune::get<1>(entityImps_[level]).end(); ++element)
+        if (element->isLeaf())
+          refineLineElement(*element, refCount);
     }
-
-    for (levelIndex+=2;levelIndex!=entityImps_.size(); ++levelIndex)
-      levelIndexSets_[levelIndex]->update(*this, levelIndex);
   }
 
   // Update the leaf indices
-  leafIndexSet().update(*this);
+  leafGridView_.indexSet_.update(*this);
+  ++indexGeneration_;
 
   globalRefined=std::max(globalRefined+refCount,0);
   postAdapt();
@@ -146,8 +99,8 @@ void Dune::FoamGrid<dimworld>::globalRefine (int refCount)
 
 
 //f Book-keeping routine to be called before adaptation
-template <int dimworld>
-bool Dune::FoamGrid<dimworld>::preAdapt()
+template <int dimworld, class ct>
+bool Dune::FoamGrid<dimworld,ct>::preAdapt()
 {
   // Loop over all leaf entities and check whether they might be
   // coarsened. If there is one return true.
@@ -157,155 +110,119 @@ bool Dune::FoamGrid<dimworld>::preAdapt()
 
   for (Iterator elem=this->leafbegin<0>(), end = this->leafend<0>(); elem != end; ++elem)
   {
-    int mark=getMark(*elem);
-    addLevels=std::max(addLevels, elem->level()+mark-maxLevel());
+    FoamGridEntityImp<1,dimworld,ctype>& element
+      = *const_cast<FoamGridEntityImp<1,dimworld,ctype>*>(this->getRealImplementation(*elem).target_);
 
-    if (mark<0)
+    if (element.markState_==FoamGridEntityImp<1,dimworld,ctype>::REFINE)
+      addLevels=std::max(addLevels, elem->level()+1-maxLevel());
+
+    if (element.markState_==FoamGridEntityImp<1,dimworld,ctype>::COARSEN)
     {
-      // If this element is marked for coarsening, but another child
-      // of this element's father is marked for refinement, then we
-      // need to reset the marker to doNothing
-      bool otherChildRefined=false;
-      FoamGridEntityImp<2,dimworld>& father = *this->getRealImplementation(*elem).target_->father_;
-      typedef typename array<FoamGridEntityImp<2,dimworld>*,4>::iterator ChildrenIter;
-      for (ChildrenIter child=father.sons_.begin(); child != father.sons_.end(); ++child)
-        otherChildRefined = otherChildRefined ||
-                            (*child)->markState_==FoamGridEntityImp<2,dimworld>::REFINE;
-
-      if (otherChildRefined)
-      {
-        for (ChildrenIter child=father.sons_.begin(); child != father.sons_.end(); ++child)
-          if ((*child)->markState_==FoamGridEntityImp<2,dimworld>::COARSEN)
-            (*child)->markState_=FoamGridEntityImp<2,dimworld>::DO_NOTHING;
-      }
+      // An element can only be coarsened together with its sibling.
+      // If the sibling is not marked for coarsening as well, then we
+      // need to reset the marker to doNothing.
+      if (mayCoarsen(element))
+        willCoarsen = true;
       else
-        willCoarsen = willCoarsen || mark<0;
+        element.markState_=FoamGridEntityImp<1,dimworld,ctype>::DO_NOTHING;
     }
   }
 
   if (addLevels)
-  {
-    entityImps_.push_back(tuple<std::list<FoamGridEntityImp<0,dimworld> >,
-                                std::list<FoamGridEntityImp<1,dimworld> >,
-                                std::list<FoamGridEntityImp<2,dimworld> > >());
-    levelIndexSets_.push_back(new FoamGridLevelIndexSet<const FoamGrid >());
-  }
+    addLevel(maxLevel()+1);
 
   return willCoarsen;
 }
 
 
 // Triggers the grid refinement process
-template <int dimworld>
-bool Dune::FoamGrid<dimworld>::adapt()
+template <int dimworld, class ct>
+bool Dune::FoamGrid<dimworld,ct>::adapt()
 {
-  std::set<std::size_t> levelsChanged;
-  bool haveRefined=false;
+  typedef FoamGridEntityImp<1,dimworld,ctype> Element;
+
+  if (!growthVertices_.empty() || !growthElements_.empty() || !growthRemovals_.empty())
+    DUNE_THROW(InvalidStateException, "adapt() called while changes are queued for grow()");
+
+  FoamGridLeafIndexSet<const FoamGrid>& leafIndexSet = leafGridView_.indexSet_;
+  leafIndexSet.beginAdaptation();
+
+  // Collect the elements to refine and to coarsen first.  The leaf iterator
+  // walks over the array of the leaf index set, which is patched below.
+  std::vector<Element*> refine, coarsen;
 
-  // Loop over all leaf elements and refine/coarsen those that marked for it.
   typedef typename Traits::template Codim<0>::LeafIterator Iterator;
   for (Iterator elem=this->leafbegin<0>(), end = this->leafend<0>();
        elem != end; ++elem)
   {
-    int mark=getMark(*elem);
-    if (mark>0)
-    {
-      // Refine Triangles
-      if (elem->type().isTriangle())
-      {
-        refineSimplexElement(*const_cast<FoamGridEntityImp<2,dimworld>*>(this->getRealImplementation(*elem).target_), 1);
-        levelsChanged.insert(elem->level()+1);
-        haveRefined=true;
-      }
-      else
-        DUNE_THROW(NotImplemented, "Refinement only supported for triangles!");
-    }
+    Element& element = *const_cast<Element*>(this->getRealImplementation(*elem).target_);
 
-    if (mark<0) // If simplex was allready treated by coarsenSimplex mark will be 0
-    {
-      // Coarsen triangles
-      if (elem->type().isTriangle())
-      {
-        assert(elem->level());
-        coarsenSimplexElement(*const_cast<FoamGridEntityImp<2,dimworld>*>(this->getRealImplementation(*elem).target_));
-        levelsChanged.insert(elem->level());
-      }
-      else
-        DUNE_THROW(NotImplemented, "Refinement only supported for triangles!");
-    }
+    if (element.markState_==Element::REFINE)
+      refine.push_back(&element);
+    // Both sons are marked, coarsen once for the first one
+    else if (element.markState_==Element::COARSEN && element.refinementIndex_==0 && mayCoarsen(element))
+      coarsen.push_back(&element);
   }
 
-  if (!willCoarsen)
-    return haveRefined;
-
-  typedef typename std::set<std::size_t>::const_reverse_iterator SIter;
-  for (SIter level=levelsChanged.rbegin(); level!=levelsChanged.rend(); ++level)
+  if (refine.empty() && coarsen.empty())
   {
-    // First delete the pointer
-    erasePointersToEntities(Dune::get<2>(entityImps_[*level]));
+    globalRefined=0;
+    return false;
+  }
 
-    // Now delete the actual vertices.
-    eraseVanishedEntities(Dune::get<0>(entityImps_[*level]));
+  // Refine first, such that coarsening sees which vertex copies are still in use.
+  // New entities are numbered as they are created, on their level and on the leaf.
 
-    // erase vanished edges
-    {
-      typedef typename std::list<FoamGridEntityImp<1,dimworld> >::iterator EdgeIter;
-      for (EdgeIter edge=Dune::get<1>(entityImps_[*level]).begin(),
-           edgeEnd=Dune::get<1>(entityImps_[*level]).end();
-           edge != Dune::get<1>(entityImps_[*level]).end();)
-      {
-        bool hasSameLevelElements=false;
-        typedef typename std::vector<const FoamGridEntityImp<2,dimworld>*>::const_iterator ElementIter;
-        for (ElementIter elem=edge->elements_.begin();
-             elem != edge->elements_.end(); ++elem)
-          hasSameLevelElements = hasSameLevelElements || (*elem)->level()==*level;
+  for (std::size_t i=0; i<refine.size(); i++)
+  {
+    refineLineElement(*refine[i], 1);
+    leafIndexSet.refine(*refine[i]);
+  }
 
-        assert(edge->willVanish_!=hasSameLevelElements);
+  std::set<std::size_t> levelsCoarsened;
+  for (std::size_t i=0; i<coarsen.size(); i++)
+  {
+    leafIndexSet.coarsen(*coarsen[i]->father_);
+    levelsCoarsened.insert(coarsen[i]->level());
+    coarsenLineElement(*coarsen[i]);
+  }
 
-        if (!hasSameLevelElements)
-        {
-          assert(edge->willVanish_);
-          // erase returns next position
-          edge=Dune::get<1>(entityImps_[*level]).erase(edge);
-        }
-        else
-          // increment
-          ++edge;
-      }
-    }
+  leafIndexSet.compact();
+  leafIndexSet.applyOrdering();
 
-    // And the elements
-    eraseVanishedEntities(Dune::get<2>(entityImps_[*level]));
+  // Erase the vanished entities and renumber the levels that lost entities,
+  // from fine to coarse.  Levels that only gained entities are up to date.
+  typedef typename std::set<std::size_t>::const_reverse_iterator SIter;
+  for (SIter level=levelsCoarsened.rbegin(); level!=levelsCoarsened.rend(); ++level)
+  {
+    eraseVanishedEntities(Dune::get<1>(entityImps_[*level]));
+    eraseVanishedEntities(Dune::get<0>(entityImps_[*level]));
 
-    if (Dune::get<0>(entityImps_[*level]).size())
-    {
-      assert(Dune::get<1>(entityImps_[*level]).size() &&
-             Dune::get<2>(entityImps_[*level]).size());
-      // Update the level indices.
+    if (Dune::get<1>(entityImps_[*level]).size())
       levelIndexSets_[*level]->update(*this, *level);
-    }
     else
     {
-      assert(!Dune::get<1>(entityImps_[*level]).size() &&
-             !Dune::get<2>(entityImps_[*level]).size());
+      assert(!Dune::get<0>(entityImps_[*level]).size());
       if (static_cast<int>(*level)==maxLevel())
+      {
         entityImps_.pop_back();
+        delete levelIndexSets_.back();
+        levelIndexSets_.pop_back();
+      }
     }
   }
 
-  if (levelsChanged.size())
-    // Update the leaf indices
-    leafIndexSet().update(*this);
+  ++indexGeneration_;
   globalRefined=0;
 
-  return haveRefined;
+  return !refine.empty();
 }
 
 
 
 // Clean up refinement markers
-template <int dimworld>
-void Dune::FoamGrid<dimworld>::postAdapt()
+template <int dimworld, class ct>
+void Dune::FoamGrid<dimworld,ct>::postAdapt()
 {
   willCoarsen=false;
 
@@ -314,52 +231,402 @@ void Dune::FoamGrid<dimworld>::postAdapt()
 
   for (Iterator elem=this->leafbegin<0>(), end = this->leafend<0>(); elem != end; ++elem)
   {
-    FoamGridEntityImp<2,dimworld>& element=*const_cast<FoamGridEntityImp<2,dimworld>*>(this->getRealImplementation(*elem).target_);
+    FoamGridEntityImp<1,dimworld,ctype>& element=*const_cast<FoamGridEntityImp<1,dimworld,ctype>*>(this->getRealImplementation(*elem).target_);
     element.isNew_=false;
+    element.markState_=FoamGridEntityImp<1,dimworld,ctype>::DO_NOTHING;
     assert(!element.willVanish_);
     if (element.father_)
-      element.father_->markState_=FoamGridEntityImp<2,dimworld>::DO_NOTHING;
+      element.father_->markState_=FoamGridEntityImp<1,dimworld,ctype>::DO_NOTHING;
   }
+
+  // Defragment the levels that lost many entities, unless grow() still refers to them
+  bytesReclaimed_=0;
+  if (growthElements_.empty() && growthRemovals_.empty())
+    for (int level=0; level<=maxLevel(); level++)
+    {
+      const std::size_t slots = Dune::get<0>(entityImps_[level]).slots() + Dune::get<1>(entityImps_[level]).slots();
+      const std::size_t size = Dune::get<0>(entityImps_[level]).size() + Dune::get<1>(entityImps_[level]).size();
+      if (slots > size && slots-size > compactionThreshold_*slots)
+        bytesReclaimed_ += compactLevel(level);
+    }
 }
 
 
-// Erases pointers in father elements to vanished entities of the element
-template <int dimworld>
-void Dune::FoamGrid<dimworld>::erasePointersToEntities(std::list<FoamGridEntityImp<2,dimworld> >& elements)
+// Make the leaf grid the new level 0
+template <int dimworld, class ct>
+void Dune::FoamGrid<dimworld,ct>::flatten()
 {
-  typedef typename std::list<FoamGridEntityImp<2,dimworld> >::iterator EntityIterator;
-  for(EntityIterator element=elements.begin();
-      element != elements.end(); ++element)
+  typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+  typedef FoamGridEntityImp<1,dimworld,ctype> Element;
+
+  if (maxLevel()<=0)
+    return;
+
+  if (!growthVertices_.empty() || !growthElements_.empty() || !growthRemovals_.empty())
+    DUNE_THROW(InvalidStateException, "flatten() called while changes are queued for grow()");
+
+  FoamGridLeafIndexSet<const FoamGrid>& leafIndexSet = leafGridView_.indexSet_;
+  const std::vector<const Vertex*>& leafVertices = Dune::get<0>(leafIndexSet.leafEntities_);
+  const std::vector<const Element*>& leafElements = Dune::get<1>(leafIndexSet.leafEntities_);
+
+  // Copy the leaf entities in leaf index order, such that level and leaf indices agree
+  LevelEntities level;
+  FoamGridEntityStorage<Vertex>& vertices = Dune::get<0>(level);
+  FoamGridEntityStorage<Element>& elements = Dune::get<1>(level);
+  vertices.reserve(leafVertices.size());
+  elements.reserve(leafElements.size());
+
+  std::vector<const Vertex*> newVertices(leafVertices.size());
+  for (std::size_t i=0; i<leafVertices.size(); i++)
+  {
+    vertices.push_back(Vertex(0, leafVertices[i]->pos_, leafVertices[i]->id_));
+    vertices.back().boundaryId_=leafVertices[i]->boundaryId_;
+    newVertices[i]=&vertices.back();
+  }
+
+  std::vector<const Element*> newElements(leafElements.size());
+  for (std::size_t i=0; i<leafElements.size(); i++)
+  {
+    elements.push_back(Element(newVertices[leafElements[i]->vertex_[0]->leafIndex_],
+                               newVertices[leafElements[i]->vertex_[1]->leafIndex_],
+                               0, leafElements[i]->id_));
+    newElements[i]=&elements.back();
+  }
+
+  // Release the hierarchy.  Moving the storage keeps the new entities in place.
+  entityImps_.clear();
+  entityImps_.push_back(std::move(level));
+
+  for (std::size_t i=1; i<levelIndexSets_.size(); i++)
+    delete levelIndexSets_[i];
+  levelIndexSets_.resize(1);
+  levelCoordinates_.clear();
+
+  levelIndexSets_[0]->update(*this, 0);
+  updateAdjacency(0);
+  leafIndexSet.transfer(newVertices, newElements);
+
+  ++indexGeneration_;
+  globalRefined=0;
+}
+
+
+// Move the entities of all levels into dense storage
+template <int dimworld, class ct>
+std::size_t Dune::FoamGrid<dimworld,ct>::compactStorage()
+{
+  if (!growthElements_.empty() || !growthRemovals_.empty())
+    DUNE_THROW(InvalidStateException, "compactStorage() called while changes are queued for grow()");
+
+  std::size_t bytes = 0;
+  for (int level=0; level<=maxLevel(); level++)
+    if (Dune::get<0>(entityImps_[level]).slots() > Dune::get<0>(entityImps_[level]).size()
+        || Dune::get<1>(entityImps_[level]).slots() > Dune::get<1>(entityImps_[level]).size())
+      bytes += compactLevel(level);
+
+  return bytes;
+}
+
+
+// Insert and remove the queued vertices and elements
+template <int dimworld, class ct>
+bool Dune::FoamGrid<dimworld,ct>::grow()
+{
+  typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+  typedef FoamGridEntityImp<1,dimworld,ctype> Element;
+
+  if (growthElements_.empty() && growthRemovals_.empty())
+  {
+    growthVertices_.clear();
+    growthComponents_.clear();
+    growthLevels_.clear();
+    return false;
+  }
+
+  // The components of queued vertices got their levels in insertElement().  Those not
+  // attached to the grid go to level 0, vertices without queued elements are dropped.
+  const std::size_t numNew = growthVertices_.size();
+  std::vector<int> vertexLevel(numNew, -1);
+  for (std::size_t e=0; e<growthElements_.size(); e++)
+    for (int i=0; i<2; i++)
+      if (!growthElements_[e][i].vertex)
+      {
+        const unsigned int v = growthElements_[e][i].newVertex;
+        vertexLevel[v] = std::max(growthLevels_[growthComponent(v)], 0);
+      }
+
+  // Remember which old vertices were on the boundary before anything changes
+  std::vector<std::pair<Vertex*, bool> > touched;
+  for (std::size_t r=0; r<growthRemovals_.size(); r++)
+    for (int i=0; i<2; i++)
+    {
+      Vertex* vertex = const_cast<Vertex*>(growthRemovals_[r]->vertex_[i]);
+      touched.push_back(std::make_pair(vertex, vertex->nElements_==1));
+    }
+  for (std::size_t e=0; e<growthElements_.size(); e++)
+    for (int i=0; i<2; i++)
+      if (growthElements_[e][i].vertex)
+      {
+        Vertex* vertex = const_cast<Vertex*>(growthElements_[e][i].vertex);
+        touched.push_back(std::make_pair(vertex, vertex->nElements_==1));
+      }
+
+  FoamGridLeafIndexSet<const FoamGrid>& leafIndexSet = leafGridView_.indexSet_;
+  leafIndexSet.beginAdaptation();
+
+  // Removed elements are only erased below, once all levels are up to date
+  std::set<std::size_t> levelsShrunk;
+  for (std::size_t r=0; r<growthRemovals_.size(); r++)
+  {
+    Element& element = *growthRemovals_[r];
+    if (element.willVanish_)
+      continue;
+
+    element.willVanish_=true;
+    leafIndexSet.remove(element);
+    levelsShrunk.insert(element.level());
+    for (int i=0; i<2; i++)
+      Dune::get<2>(entityImps_[element.level()]).remove(*const_cast<Vertex*>(element.vertex_[i]), &element);
+  }
+
+  // Append the new entities to their levels, they are numbered as they are created
+  std::vector<Vertex*> newVertices(numNew, nullptr);
+  for (std::size_t v=0; v<numNew; v++)
+    if (vertexLevel[v]>=0)
+    {
+      FoamGridEntityStorage<Vertex>& vertices = Dune::get<0>(entityImps_[vertexLevel[v]]);
+      vertices.push_back(Vertex(vertexLevel[v], growthVertices_[v], freeIdCounter_[0]++));
+      newVertices[v] = &vertices.back();
+      levelIndexSets_[vertexLevel[v]]->insert(vertices.back());
+      leafIndexSet.insert(vertices.back(), v);
+    }
+
+  for (std::size_t e=0; e<growthElements_.size(); e++)
+  {
+    Vertex* ends[2];
+    for (int i=0; i<2; i++)
+      ends[i] = growthElements_[e][i].vertex ? const_cast<Vertex*>(growthElements_[e][i].vertex)
+                                             : newVertices[growthElements_[e][i].newVertex];
+
+    const int level = ends[0]->level();
+    FoamGridEntityStorage<Element>& elements = Dune::get<1>(entityImps_[level]);
+    elements.push_back(Element(ends[0], ends[1], level, freeIdCounter_[1]++));
+    Element& element = elements.back();
+    element.isNew_=true;
+    levelIndexSets_[level]->insert(element);
+    leafIndexSet.insert(element, e);
+
+    for (int i=0; i<2; i++)
+      Dune::get<2>(entityImps_[level]).insert(*ends[i], &element);
+  }
+
+  // Old vertices without any element left vanish
+  for (std::size_t t=0; t<touched.size(); t++)
+  {
+    Vertex* vertex = touched[t].first;
+    if (vertex->nElements_==0 && !vertex->willVanish_)
+    {
+      assert(vertex->isLeaf());
+      vertex->willVanish_=true;
+      leafIndexSet.remove(*vertex);
+      levelsShrunk.insert(vertex->level());
+    }
+  }
+
+  leafIndexSet.compact();
+
+  std::vector<Vertex*> inserted;
+  for (std::size_t v=0; v<numNew; v++)
+    if (newVertices[v])
+      inserted.push_back(newVertices[v]);
+  updateBoundarySegments(touched, inserted);
+
+  leafIndexSet.applyOrdering();
+
+  // Erase the vanished entities and renumber the levels that lost entities
+  typedef typename std::set<std::size_t>::const_reverse_iterator SIter;
+  for (SIter level=levelsShrunk.rbegin(); level!=levelsShrunk.rend(); ++level)
+  {
+    eraseVanishedEntities(Dune::get<1>(entityImps_[*level]));
+    eraseVanishedEntities(Dune::get<0>(entityImps_[*level]));
+
+    if (Dune::get<1>(entityImps_[*level]).size() || static_cast<int>(*level)!=maxLevel())
+      levelIndexSets_[*level]->update(*this, *level);
+    else
+    {
+      assert(!Dune::get<0>(entityImps_[*level]).size());
+      entityImps_.pop_back();
+      delete levelIndexSets_.back();
+      levelIndexSets_.pop_back();
+    }
+  }
+
+  growthVertices_.clear();
+  growthComponents_.clear();
+  growthLevels_.clear();
+  growthElements_.clear();
+  growthRemovals_.clear();
+
+  ++indexGeneration_;
+  return true;
+}
+
+
+// Give the boundary vertices touched by grow() consecutive boundary segment indices
+template <int dimworld, class ct>
+void Dune::FoamGrid<dimworld,ct>::updateBoundarySegments(std::vector<std::pair<FoamGridEntityImp<0,dimworld,ctype>*, bool> >& touched,
+                                                      const std::vector<FoamGridEntityImp<0,dimworld,ctype>*>& inserted)
+{
+  typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+
+  // A vertex may have been touched several times, always with the same old state
+  std::sort(touched.begin(), touched.end());
+  touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+  std::vector<unsigned int> freed;
+  std::vector<Vertex*> needed;
+  for (std::size_t t=0; t<touched.size(); t++)
+  {
+    Vertex* vertex = touched[t].first;
+    const bool boundary = !vertex->willVanish_ && vertex->nElements_==1;
+    if (touched[t].second && !boundary)
+      freed.push_back(vertex->boundaryId_);
+    else if (!touched[t].second && boundary)
+      needed.push_back(vertex);
+  }
+  for (std::size_t v=0; v<inserted.size(); v++)
+    if (inserted[v]->nElements_==1)
+      needed.push_back(inserted[v]);
+
+  // Reuse the freed indices first, append the others
+  while (!needed.empty() && !freed.empty())
+  {
+    setBoundaryId(*needed.back(), freed.back());
+    needed.pop_back();
+    freed.pop_back();
+  }
+  for (std::size_t v=0; v<needed.size(); v++)
+    setBoundaryId(*needed[v], numBoundarySegments_++);
+
+  if (freed.empty())
+    return;
+
+  // Fewer boundary segments than before: move the ones with the highest indices
+  // into the gaps.  This needs a pass over the leaf vertices to find them.
+  const std::size_t newSize = numBoundarySegments_ - freed.size();
+  std::vector<Vertex*> highest(freed.size(), nullptr);
+  const std::vector<const Vertex*>& leafVertices = Dune::get<0>(leafIndexSet().leafEntities_);
+  for (std::size_t v=0; v<leafVertices.size(); v++)
   {
-    if(element->willVanish_)
+    Vertex* vertex = const_cast<Vertex*>(coarsestCopy(leafVertices[v]));
+    if (vertex->nElements_==1 && vertex->boundaryId_>=newSize)
+      highest[vertex->boundaryId_-newSize] = vertex;
+  }
+
+  typename std::vector<Vertex*>::iterator moving = highest.begin();
+  for (std::size_t f=0; f<freed.size(); f++)
+    if (freed[f]<newSize)
     {
-      FoamGridEntityImp<2,dimworld>& father=*element->father_;
-
-      for (unsigned int i=0; i<father.nSons_; i++)
-        father.sons_[i]=nullptr;
-      for (unsigned int i=0; i<father.corners(); i++)
-        if (father.vertex_[i]->son_!=nullptr)
-          if (father.vertex_[i]->son_->willVanish_)
-            father.vertex_[i]->son_=nullptr;
-      for (unsigned int i=0; i<father.corners(); i++)
-        if (father.edges_[i]->sons_[0]!=nullptr
-            && father.edges_[i]->sons_[0]->willVanish_)
-          for (unsigned int j=0; j<2; j++)
-          {
-            assert(father.edges_[i]->sons_[j]!=nullptr);
-            assert(father.edges_[i]->sons_[j]->willVanish_);
-            father.edges_[i]->sons_[j]=nullptr;
-          }
+      while (*moving==nullptr)
+        ++moving;
+      setBoundaryId(**moving++, freed[f]);
     }
+
+  numBoundarySegments_ = newSize;
+}
+
+
+// Set the boundary segment index of a vertex and of all its finer copies
+template <int dimworld, class ct>
+void Dune::FoamGrid<dimworld,ct>::setBoundaryId(FoamGridEntityImp<0,dimworld,ctype>& vertex, unsigned int id)
+{
+  for (FoamGridEntityImp<0,dimworld,ctype>* copy = &vertex; copy; copy = copy->son_)
+    copy->boundaryId_ = id;
+}
+
+
+// The coarsest copy of a vertex
+template <int dimworld, class ct>
+const Dune::FoamGridEntityImp<0,dimworld,ct>*
+Dune::FoamGrid<dimworld,ct>::coarsestCopy(const FoamGridEntityImp<0,dimworld,ctype>* vertex)
+{
+  if (vertex->nElements_==0)
+    return vertex;
+
+  const FoamGridEntityImp<1,dimworld,ctype>* element = vertex->elements()[0];
+  return FoamGridVertexCopies<dimworld,ctype>::coarsest(element, (element->vertex_[0]==vertex) ? 0 : 1);
+}
+
+
+// The end point of a queued element at a leaf vertex
+template <int dimworld, class ct>
+typename Dune::FoamGrid<dimworld,ct>::GrowthVertex
+Dune::FoamGrid<dimworld,ct>::growthVertex(const typename Traits::template Codim<dimension>::Entity& vertex) const
+{
+  const FoamGridEntityImp<0,dimworld,ctype>* target = this->getRealImplementation(vertex).target_;
+  if (!target->isLeaf())
+    DUNE_THROW(GridError, "Elements can only be attached to leaf vertices");
+
+  GrowthVertex result = {coarsestCopy(target), 0};
+  return result;
+}
+
+
+// Queue an element between two end points, after checking that grow() can insert it
+template <int dimworld, class ct>
+unsigned int Dune::FoamGrid<dimworld,ct>::insertElement(const GrowthVertex& vertex0, const GrowthVertex& vertex1)
+{
+  // A segment of length zero has no Jacobian inverse; this also rejects self-loops
+  const FieldVector<ctype,dimworld>& pos0 = vertex0.vertex ? vertex0.vertex->pos_ : growthVertices_[vertex0.newVertex];
+  const FieldVector<ctype,dimworld>& pos1 = vertex1.vertex ? vertex1.vertex->pos_ : growthVertices_[vertex1.newVertex];
+  if (pos0 == pos1)
+    DUNE_THROW(GridError, "An element cannot connect two vertices at the same position " << pos0);
+
+  // Old vertices have the level of their coarsest copy, queued vertices that of their component
+  const int level0 = vertex0.vertex ? static_cast<int>(vertex0.vertex->level()) : growthLevels_[growthComponent(vertex0.newVertex)];
+  const int level1 = vertex1.vertex ? static_cast<int>(vertex1.vertex->level()) : growthLevels_[growthComponent(vertex1.newVertex)];
+  if (level0>=0 && level1>=0 && level0!=level1)
+    DUNE_THROW(NotImplemented, "Cannot connect vertices whose coarsest copies are on different levels");
+
+  const int level = std::max(level0, level1);
+  if (!vertex0.vertex && !vertex1.vertex)
+  {
+    const unsigned int root = growthComponent(vertex0.newVertex);
+    growthComponents_[growthComponent(vertex1.newVertex)] = root;
+    growthLevels_[root] = level;
+  }
+  for (int i=0; i<2; i++)
+  {
+    const GrowthVertex& end = (i==0) ? vertex0 : vertex1;
+    if (!end.vertex)
+      growthLevels_[growthComponent(end.newVertex)] = level;
   }
+
+  array<GrowthVertex,2> element = {{vertex0, vertex1}};
+  growthElements_.push_back(element);
+  return growthElements_.size()-1;
+}
+
+
+// The representative of the component of a queued vertex
+template <int dimworld, class ct>
+unsigned int Dune::FoamGrid<dimworld,ct>::growthComponent(unsigned int newVertex)
+{
+  while (growthComponents_[newVertex]!=newVertex)
+  {
+    growthComponents_[newVertex] = growthComponents_[growthComponents_[newVertex]];
+    newVertex = growthComponents_[newVertex];
+  }
+  return newVertex;
 }
 
+
 // Erase Entities from memory that vanished due to coarsening.
-template <int dimworld>
+template <int dimworld, class ct>
 template<int i>
-void Dune::FoamGrid<dimworld>::eraseVanishedEntities(std::list<FoamGridEntityImp<i,dimworld> >& levelEntities)
+void Dune::FoamGrid<dimworld,ct>::eraseVanishedEntities(FoamGridEntityStorage<FoamGridEntityImp<i,dimworld,ctype> >& levelEntities)
 {
-  typedef typename std::list<FoamGridEntityImp<i,dimworld> >::iterator EntityIterator;
+  typedef typename FoamGridEntityStorage<FoamGridEntityImp<i,dimworld,ctype> >::iterator EntityIterator;
   for (EntityIterator entity=levelEntities.begin();
       entity != levelEntities.end();)
   {
@@ -371,559 +638,345 @@ void Dune::FoamGrid<dimworld>::eraseVanishedEntities(std::list<FoamGridEntityImp
 }
 
 
+// Whether an element marked for coarsening can be coarsened
+template <int dimworld, class ct>
+bool Dune::FoamGrid<dimworld,ct>::mayCoarsen(const FoamGridEntityImp<1,dimworld,ctype>& element) const
+{
+  if (element.father_==nullptr)
+    return false;
+
+  const FoamGridEntityImp<1,dimworld,ctype>* sibling = element.father_->sons_[1-element.refinementIndex_];
+  if (!sibling->isLeaf() || sibling->markState_!=FoamGridEntityImp<1,dimworld,ctype>::COARSEN)
+    return false;
+
+  // The midpoint must not vanish while elements inserted by grow() are attached to it
+  const FoamGridEntityImp<0,dimworld,ctype>* midVertex = element.father_->sons_[0]->vertex_[1];
+  return midVertex->nElements_==2 && midVertex->isLeaf();
+}
+
+
 // Coarsen an Element
-template <int dimworld>
-void Dune::FoamGrid<dimworld>::coarsenSimplexElement(FoamGridEntityImp<2,dimworld>& element)
+template <int dimworld, class ct>
+void Dune::FoamGrid<dimworld,ct>::coarsenLineElement(FoamGridEntityImp<1,dimworld,ctype>& element)
 {
+  typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+
   // If we coarsen an element, this means that we erase all chidren of its father
   // to prevent inconsistencies.
-  const FoamGridEntityImp<2,dimworld>& father = *(element.father_);
-
-  // The edges that might be erased
-  std::set<FoamGridEntityImp<1,dimworld>*> childEdges;
+  FoamGridEntityImp<1,dimworld,ctype>& father = *(element.father_);
+  FoamGridLevelAdjacency<dimworld,ctype>& adjacency = Dune::get<2>(entityImps_[element.level()]);
 
-  // The vertices that might be erased
-  std::set<FoamGridEntityImp<0,dimworld>*> childVertices;
-  typedef typename array<FoamGridEntityImp<2,dimworld>*,4>::const_iterator ChildrenIter;
-  for (ChildrenIter child=father.sons_.begin(); child != father.sons_.end(); ++child)
+  for (int k=0; k<2; k++)
   {
     // Remember element for the actual deletion taking place later
-    (*child)->markState_=FoamGridEntityImp<2,dimworld>::IS_COARSENED;
-    (*child)->willVanish_=true;
+    FoamGridEntityImp<1,dimworld,ctype>* son = father.sons_[k];
+    son->markState_=FoamGridEntityImp<1,dimworld,ctype>::IS_COARSENED;
+    son->willVanish_=true;
 
-    typedef typename array<FoamGridEntityImp<1,dimworld>*,3>::iterator EdgeIter;
-
-    for (EdgeIter edge=(*child)->edges_.begin(); edge != (*child)->edges_.end(); ++edge)
-    {
-      // Remove references to elements that will be erased
-      typedef typename std::vector<const FoamGridEntityImp<2,dimworld>*>::iterator
-                    ElementIter;
-      for (ElementIter element = (*edge)->elements_.begin();
-           element != (*edge)->elements_.end();
-           ++element)
-      {
-        for (ChildrenIter child1=father.sons_.begin(); child1 !=
-             father.sons_.end(); ++child1)
-          if(*element==*child1)
-          {
-            // To prevent removing an element from a vector
-            // we just overwrite the element with its father.
-            // later we will check the edges and erase all
-            // of them that do not have any elements on the same
-            // level.
-            *element=&father;
-          }
-      }
-    }
-
-    typedef FoamGridEntityImp<0,dimworld>** VertexIter;
-    for (VertexIter vertex=(*child)->vertex_; vertex != (*child)->vertex_+(*child)->corners();
-        ++vertex)
-      childVertices.insert(*vertex);
-    typedef typename array<FoamGridEntityImp<1,dimworld>*, 3>::iterator EdgeIter;
-    for (EdgeIter edge=(*child)->edges_.begin(); edge!= (*child)->edges_.end();
-        ++edge)
-      childEdges.insert(*edge);
+    for (int i=0; i<2; i++)
+      adjacency.remove(*const_cast<Vertex*>(son->vertex_[i]), son);
   }
 
-  // Check whether those guys are really erased.
-  // That is, we remove all vertices and edges that are part of a child element of one
-  // of the neighbours of the father element
-  typedef typename array<FoamGridEntityImp<1,dimworld>*,3>::const_iterator EdgeIter;
+  // The midpoint only belongs to the sons
+  Vertex* midVertex = const_cast<Vertex*>(father.sons_[0]->vertex_[1]);
+  assert(midVertex->nElements_==0 && midVertex->isLeaf());
+  midVertex->willVanish_=true;
 
-  for(EdgeIter edge=father.edges_.begin(); edge != father.edges_.end(); ++edge)
+  // The copies of the vertices of the father vanish unless they are
+  // part of a neighbor on the same level
+  for (int k=0; k<2; k++)
   {
-    typedef typename std::vector<const FoamGridEntityImp<2,dimworld>*>::iterator NeighborIter;
-    for (NeighborIter neighbor = (*edge)->elements_.begin();
-         neighbor != (*edge)->elements_.end();
-         ++neighbor)
+    Vertex* vertex = const_cast<Vertex*>(father.vertex_[k]);
+    if (vertex->son_->nElements_==0)
     {
-      assert((*neighbor)->level()<=father.level());
-      if(*neighbor != &father && (*neighbor)->level()==father.level() &&
-         !(*neighbor)->isLeaf())
-      {
-        // This is a real neighbor element on the same level
-        // Check whether one of its children is marked for coarsening
-        bool coarsened=false;
-        for (ChildrenIter child=(*neighbor)->sons_.begin();
-             child != (*neighbor)->sons_.end(); ++child)
-          if((*child)->mightVanish())
-          {
-            coarsened=true;
-            break;
-          }
-
-        if(!coarsened)
-        {
-          // Remove all entities that exist in the children of the neighbor
-          // from the list
-          for (ChildrenIter child=(*neighbor)->sons_.begin();
-               child != (*neighbor)->sons_.end(); ++child)
-          {
-            typedef typename array<FoamGridEntityImp<1,dimworld>*,3>::iterator EdgeIter;
-            for (EdgeIter edge=(*child)->edges_.begin(); edge != (*child)->edges_.end(); ++edge)
-              childEdges.erase(*edge);
-            typedef FoamGridEntityImp<0,dimworld>** VertexIter;
-            for (VertexIter vertex=(*child)->vertex_;
-                 vertex != (*child)->vertex_+(*child)->corners();
-                 ++vertex)
-              childVertices.erase(*vertex);
-          }
-        }
-      }
+      vertex->son_->willVanish_=true;
+      vertex->son_=nullptr;
     }
   }
 
-  typedef typename std::set<FoamGridEntityImp<1,dimworld>*>::iterator SEdgeIter;
-  for (SEdgeIter e=childEdges.begin(); e!=childEdges.end(); ++e)
-    (*e)->willVanish_=true;
-  typedef typename std::set<FoamGridEntityImp<0,dimworld>*>::iterator VertexIter;
-  for (VertexIter v=childVertices.begin(); v!=childVertices.end(); ++v)
-   (*v)->willVanish_=true;
+  father.sons_[0]=nullptr;
+  father.sons_[1]=nullptr;
+  father.nSons_=0;
 }
 
 
-
 // Refine one element
-template <int dimworld>
-void Dune::FoamGrid<dimworld>::refineSimplexElement(FoamGridEntityImp<2,dimworld>& element,
-                                                    int refCount)
+template <int dimworld, class ct>
+void Dune::FoamGrid<dimworld,ct>::refineLineElement(FoamGridEntityImp<1,dimworld,ctype>& element,
+                                                 int refCount)
 {
-  if(refCount<0)
-  {
-    // We always remove all the children from the father.
-    // Removing means:
-    // 1. remove pointers in father element, edges and vertices
-    // 2. Mark removed entities for deletion.
-    DUNE_THROW(NotImplemented, "Coarsening not implemented yet");
-    return;
-  }
+  typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+  typedef FoamGridEntityImp<1,dimworld,ctype> Element;
 
+  assert(refCount>0 && element.isLeaf());
 
-  // TODO: Currently we are assuming that only globalRefine is available
-  // and therefore the next level is not yet present.
-  // For real adaptivity some of the edges and vertices might already be present.
-  // Therefore we need some kind of detection for this later on.
+  const std::size_t nextLevel=element.level()+1;
+  addLevel(nextLevel);
 
-  unsigned int nextLevel=element.level()+1;
+  FoamGridEntityStorage<Vertex>& vertices = Dune::get<0>(entityImps_[nextLevel]);
+  FoamGridEntityStorage<Element>& elements = Dune::get<1>(entityImps_[nextLevel]);
+  FoamGridLevelAdjacency<dimworld,ctype>& adjacency = Dune::get<2>(entityImps_[nextLevel]);
 
+  // Copy the vertices of the element to the next level, unless a neighbor did so already
+  for (int c=0; c<2; c++)
+  {
+    Vertex& vertex = *const_cast<Vertex*>(element.vertex_[c]);
+    if (vertex.son_==nullptr)
+    {
+      vertices.push_back(Vertex(nextLevel, vertex.pos_, vertex.id_));
+      vertices.back().boundaryId_=vertex.boundaryId_;
+      vertex.son_=&vertices.back();
+      levelIndexSets_[nextLevel]->insert(vertices.back());
+    }
+  }
 
-  std::cout << "Vertices " << nextLevel << ": " << Dune::get<0>(entityImps_[nextLevel]).size()
-            << std::endl;
-  std::cout << "Edges " << nextLevel << ": " <<Dune::get<1>(entityImps_[nextLevel]).size()
-            << std::endl;
-  std::cout << "Elements " << nextLevel << ": " << Dune::get<2>(entityImps_[nextLevel]).size()
-            << std::endl;
+  // Create the midpoint
+  FieldVector<ctype, dimworld> midPoint = element.vertex_[0]->pos_;
+  midPoint += element.vertex_[1]->pos_;
+  midPoint *= 0.5;
 
-  array<FoamGridEntityImp<0,dimworld>*, 6> nextLevelVertices;
-  std::size_t vertexIndex=0;
+  vertices.push_back(Vertex(nextLevel, midPoint, freeIdCounter_[0]++));
+  Vertex* midVertex = &vertices.back();
+  levelIndexSets_[nextLevel]->insert(*midVertex);
 
-  // create copies of the vertices of the element
-  for(unsigned int c=0; c<element.corners(); ++c)
+  // Create the sons, son k keeps vertex k of the father
+  for (int k=0; k<2; k++)
   {
-    dverb<<"Processing vertex "<<element.vertex_[c]<<std::endl;
-    if(element.vertex_[c]->son_==nullptr){
-      // Not refined yet
-      Dune::get<0>(entityImps_[nextLevel])
-      .push_back(FoamGridEntityImp<0,dimworld>(nextLevel,
-                                               element.vertex_[c]->pos_,
-                                               element.vertex_[c]->id_));
-      FoamGridEntityImp<0,dimworld>& newVertex =
-      Dune::get<0>(entityImps_[nextLevel]).back();
-      element.vertex_[c]->son_=&newVertex;
-    }
-    check_for_duplicates(nextLevelVertices, element.vertex_[c]->son_, vertexIndex);
-    nextLevelVertices[vertexIndex++]=element.vertex_[c]->son_;
+    Vertex* v0 = (k==0) ? element.vertex_[0]->son_ : midVertex;
+    Vertex* v1 = (k==0) ? midVertex : element.vertex_[1]->son_;
+
+    elements.push_back(Element(v0, v1, nextLevel, freeIdCounter_[1]++, &element));
+    Element& son = elements.back();
+    son.refinementIndex_=k;
+    son.isNew_=true;
+    element.sons_[k]=&son;
+    levelIndexSets_[nextLevel]->insert(son);
+
+    adjacency.insert(*v0, &son);
+    adjacency.insert(*v1, &son);
   }
+  element.nSons_=2;
+
+  if (refCount>1)
+    for (int k=0; k<2; k++)
+      refineLineElement(*element.sons_[k], refCount-1);
+}
+
+
+// Make sure that a level exists
+template <int dimworld, class ct>
+void Dune::FoamGrid<dimworld,ct>::addLevel(std::size_t level)
+{
+  while (entityImps_.size()<=level)
+    entityImps_.push_back(LevelEntities());
 
-  // create new vertices from edge-midpoints together with the new edges that
-  // have a father
-  typedef typename array<FoamGridEntityImp<1,dimworld>*, 3>::iterator EdgeIterator;
+  while (levelIndexSets_.size()<entityImps_.size())
+    levelIndexSets_.push_back(new FoamGridLevelIndexSet<const FoamGrid >(levelIndexSets_.size()));
+}
+
+
+// Move the entities of a level into dense storage
+template <int dimworld, class ct>
+std::size_t Dune::FoamGrid<dimworld,ct>::compactLevel(int level)
+{
+  typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+  typedef FoamGridEntityImp<1,dimworld,ctype> Element;
 
-  array<FoamGridEntityImp<1,dimworld>*, 9> nextLevelEdges;
-  std::size_t edgeIndex=0;
-  const Dune::ReferenceElement<double,dimension>& refElement
-    = Dune::ReferenceElements<double, dimension>::general(element.type());
+  FoamGridEntityStorage<Vertex>& vertices = Dune::get<0>(entityImps_[level]);
+  FoamGridEntityStorage<Element>& elements = Dune::get<1>(entityImps_[level]);
+  const std::size_t oldBytes = vertices.capacity()*sizeof(Vertex) + elements.capacity()*sizeof(Element);
 
-  // I am just to dumb for a general edge to vertice mapping.
-  // Therefore we just store it here
-  array<std::pair<unsigned int,unsigned int>,3 > edgeVertexMapping;
-  edgeVertexMapping[0]=std::make_pair(0,1);
-  edgeVertexMapping[1]=std::make_pair(2,0);
-  edgeVertexMapping[2]=std::make_pair(1,2);
+  std::vector<const Vertex*>& leafVertices = Dune::get<0>(leafGridView_.indexSet_.leafEntities_);
+  std::vector<const Element*>& leafElements = Dune::get<1>(leafGridView_.indexSet_.leafEntities_);
 
-  for(EdgeIterator edge=element.edges_.begin(); edge != element.edges_.end(); ++edge)
+  // Copy the live entities.  The level index of an entity is its position among
+  // the live entities, hence it is its position in the dense storage as well.
+  FoamGridEntityStorage<Vertex> newVertices;
+  newVertices.reserve(vertices.size());
+  std::vector<Vertex*> vertexMap(vertices.size());
+
+  typedef typename FoamGridEntityStorage<Vertex>::iterator VertexIterator;
+  for (VertexIterator vIt=vertices.begin(); vIt!=vertices.end(); ++vIt)
   {
-    typedef FoamGridEntityImp<0,dimworld> FoamGridVertex;
-    const FoamGridVertex* v0 = element.vertex_[refElement.subEntity(edgeIndex/2, 1, 0, 2)];
-    const FoamGridVertex* v1 = element.vertex_[refElement.subEntity(edgeIndex/2, 1, 1, 2)];
+    assert(vIt->levelIndex_==newVertices.size());
+    newVertices.push_back(*vIt);
+    vertexMap[vIt->levelIndex_]=&newVertices.back();
 
-    if(!(*edge)->nSons_)
-    {
-      // Not refined yet
-      // Compute edge midpoint
-      FieldVector<double, dimworld> midPoint;
-      for(int dim=0; dim<dimworld;++dim)
-        midPoint[dim]=((*edge)->vertex_[0]->pos_[dim]
-        + (*edge)->vertex_[1]->pos_[dim]) /2.0;
-
-      //create midpoint
-      Dune::get<0>(entityImps_[nextLevel])
-        .push_back(FoamGridEntityImp<0,dimworld>(nextLevel, midPoint,
-                                               freeIdCounter_[0]++));
-      FoamGridEntityImp<0,dimworld>& midVertex =
-        Dune::get<0>(entityImps_[nextLevel]).back();
-      check_for_duplicates(nextLevelVertices, &midVertex, vertexIndex);
-      nextLevelVertices[vertexIndex++]=&midVertex;
-
-      // sanity check for DUNE numbering
-      dvverb<<"edge "<<edgeIndex/2<<": "<<"("<<(*edge)->vertex_[0]->son_<<","<<(*edge)->vertex_[1]->son_<<") with father ("<<(*edge)->vertex_[0]<<","<<(*edge)->vertex_[1]<<")"<<std::endl;
-      assert(v0->son_!=nullptr);
-      assert(v1->son_!=nullptr);
-      assert(v0->son_ == nextLevelVertices[edgeVertexMapping[edgeIndex/2].first] ||
-        v0->son_ == nextLevelVertices[edgeVertexMapping[edgeIndex/2].second]);
-
-      assert(v1->son_ == nextLevelVertices[edgeVertexMapping[edgeIndex/2].first] ||
-        v1->son_ == nextLevelVertices[edgeVertexMapping[edgeIndex/2].second]);
-
-      // create the edges and publish them in the father
-      Dune::get<1>(entityImps_[nextLevel])
-        .push_back(FoamGridEntityImp<1,dimworld>(nextLevelVertices[edgeVertexMapping[edgeIndex/2].first], &midVertex,
-                                                 nextLevel, freeIdCounter_[1]++, *edge));
-      (*edge)->sons_[0] = &Dune::get<1>(entityImps_[nextLevel]).back();
-      ++((*edge)->nSons_);
-      // Inherit the boundaryId
-      (*edge)->sons_[0]->boundaryId_=(*edge)->boundaryId_;
-      nextLevelEdges[edgeIndex++]= (*edge)->sons_[0];
-
-      // Initialize the elements_ vector of the new edge
-      // with that of the father. Later we will overwrite it
-      // with the correct values.
-      (*edge)->sons_[0]->elements_=(*edge)->elements_;
-
-      assert((*edge)->vertex_[1]->son_!=nullptr);
-      Dune::get<1>(entityImps_[nextLevel])
-        .push_back(FoamGridEntityImp<1,dimworld>(&midVertex, nextLevelVertices[edgeVertexMapping[edgeIndex/2].second],
-                                                 nextLevel, freeIdCounter_[1]++, *edge));
-      (*edge)->sons_[1] = &Dune::get<1>(entityImps_[nextLevel]).back();
-      ++((*edge)->nSons_);
-      // Inherit the boundaryId
-      (*edge)->sons_[1]->boundaryId_=(*edge)->boundaryId_;
-      nextLevelEdges[edgeIndex++]= (*edge)->sons_[1];
-
-      // Initialize the elements_ vector of the new edge
-      // with that of the father. Later we will overwrite it
-      // with the correct values.
-      (*edge)->sons_[1]->elements_=(*edge)->elements_;
-
-      (*edge)->nSons_=2;
-    } else {
-      // Edges do already exist. Just add its sons to nextLevelEdges
-      // but make sure that the one containing vertex edgeIndex comes first
-      if((*edge)->sons_[0]->vertex_[0]->id_ ==
-        nextLevelVertices[edgeVertexMapping[edgeIndex/2].first]->id_ ||
-        (*edge)->sons_[0]->vertex_[1]->id_ ==
-        nextLevelVertices[edgeVertexMapping[edgeIndex/2].first]->id_)
-      {
-        nextLevelEdges[edgeIndex++]=(*edge)->sons_[0];
-      nextLevelEdges[edgeIndex++]=(*edge)->sons_[1];
-      }else{
-        nextLevelEdges[edgeIndex++]=(*edge)->sons_[1];
-        nextLevelEdges[edgeIndex++]=(*edge)->sons_[0];
-      }
-      if((*edge)->sons_[0]->vertex_[0]->id_!=(*edge)->vertex_[0]->id_ &&
-         (*edge)->sons_[0]->vertex_[0]->id_!=(*edge)->vertex_[1]->id_)
-      {
-        //vertex 0 is the midpoint
-        check_for_duplicates(nextLevelVertices, (*edge)->sons_[0]->vertex_[0], vertexIndex);
-        nextLevelVertices[vertexIndex++]=const_cast<FoamGridEntityImp<0,dimworld>*>((*edge)->sons_[0]->vertex_[0]);
-      } else {
-        check_for_duplicates(nextLevelVertices, (*edge)->sons_[0]->vertex_[1], vertexIndex);
-        nextLevelVertices[vertexIndex++]=const_cast<FoamGridEntityImp<0,dimworld>*>((*edge)->sons_[0]->vertex_[1]);
-      }
-    }
-  }
-  assert(edgeIndex==6);
-  // Create the edges that lie within the father element
-  // first the one that lies opposite to the vertex 0 in the father
-  Dune::get<1>(entityImps_[nextLevel])
-    .push_back(FoamGridEntityImp<1,dimworld>(nextLevelVertices[3],
-                                             nextLevelVertices[4], nextLevel,
-                                             freeIdCounter_[1]++));
-  nextLevelEdges[edgeIndex++]=&Dune::get<1>(entityImps_[nextLevel]).back();
-
-  // the one opposite to father vertex 1
-  Dune::get<1>(entityImps_[nextLevel])
-    .push_back(FoamGridEntityImp<1,dimworld>(nextLevelVertices[3],
-                                             nextLevelVertices[5], nextLevel,
-                                             freeIdCounter_[1]++));
-  nextLevelEdges[edgeIndex++]=&Dune::get<1>(entityImps_[nextLevel]).back();
-
-  // and the one opposite to father vertex 2
-  Dune::get<1>(entityImps_[nextLevel])
-    .push_back(FoamGridEntityImp<1,dimworld>(nextLevelVertices[4],
-                                             nextLevelVertices[5], nextLevel,
-                                             freeIdCounter_[1]++));
-  nextLevelEdges[edgeIndex++]=&Dune::get<1>(entityImps_[nextLevel]).back();
-
-  assert(edgeIndex==nextLevelEdges.size());
-  assert(vertexIndex==nextLevelVertices.size());
-
-  array<FoamGridEntityImp<2,dimworld>*, 4> nextLevelElements;
-  // create the new triangles that lie in the corners
-  // First the one that contains vertex 0 of the father.
-  Dune::get<2>(entityImps_[nextLevel])
-    .push_back(FoamGridEntityImp<2,dimworld>(nextLevel, freeIdCounter_[2]++));
-
-  FoamGridEntityImp<2,dimworld>* newElement = &(Dune::get<2>(entityImps_[nextLevel]).back());
-  newElement->isNew_=true;
-  newElement->father_=&element;
-  newElement->edges_[0]=nextLevelEdges[0];
-  newElement->edges_[1]=nextLevelEdges[3];
-  newElement->edges_[2]=nextLevelEdges[6];
-  newElement->vertex_[0]=nextLevelVertices[0];
-  newElement->vertex_[1]=nextLevelVertices[3];
-  newElement->vertex_[2]=nextLevelVertices[4];
-  newElement->refinementIndex_=0;
-  nextLevelElements[0]=newElement;
-  element.sons_[0]=newElement;
-  dvverb<<"Pushed element "<<newElement<<" refindex="<<newElement->refinementIndex_<<std::endl;
-
-  // Next the one that contains vertex 1 of the father.
-  Dune::get<2>(entityImps_[nextLevel])
-    .push_back(FoamGridEntityImp<2,dimworld>(nextLevel, freeIdCounter_[2]++));
-  newElement = &(Dune::get<2>(entityImps_[nextLevel]).back());
-  newElement->isNew_=true;
-  newElement->father_=&element;
-  newElement->edges_[0]=nextLevelEdges[4];
-  newElement->edges_[1]=nextLevelEdges[1];
-  newElement->edges_[2]=nextLevelEdges[7];
-  newElement->vertex_[0]=nextLevelVertices[1];
-  newElement->vertex_[1]=nextLevelVertices[5];
-  newElement->vertex_[2]=nextLevelVertices[3];
-  newElement->refinementIndex_=1;
-  nextLevelElements[1]=newElement;
-  element.sons_[1]=newElement;
-  dvverb<<"Pushed element "<<newElement<<" refindex="<<newElement->refinementIndex_<<std::endl;
-
-
-  // Last the one that contains vertex 2 of the father.
-  Dune::get<2>(entityImps_[nextLevel])
-    .push_back(FoamGridEntityImp<2,dimworld>(nextLevel, freeIdCounter_[2]++));
-  newElement = &(Dune::get<2>(entityImps_[nextLevel]).back());
-  newElement->isNew_=true;
-  newElement->father_=&element;
-  newElement->edges_[0]=nextLevelEdges[2];
-  newElement->edges_[1]=nextLevelEdges[5];
-  newElement->edges_[2]=nextLevelEdges[8];
-  newElement->vertex_[0]=nextLevelVertices[2];
-  newElement->vertex_[1]=nextLevelVertices[4];
-  newElement->vertex_[2]=nextLevelVertices[5];
-  newElement->refinementIndex_=2;
-  nextLevelElements[2]=newElement;
-  element.sons_[2]=newElement;
-  dvverb<<"Pushed element "<<newElement<<" refindex="<<newElement->refinementIndex_<<std::endl;
-
-
-  // create the triangle in the center
-  Dune::get<2>(entityImps_[nextLevel])
-    .push_back(FoamGridEntityImp<2,dimworld>(nextLevel, freeIdCounter_[2]++));
-  newElement = &(Dune::get<2>(entityImps_[nextLevel]).back());
-  newElement->isNew_=true;
-  newElement->father_=&element;
-  newElement->edges_[0]=nextLevelEdges[7];
-  newElement->edges_[1]=nextLevelEdges[6];
-  newElement->edges_[2]=nextLevelEdges[8];
-  newElement->vertex_[0]=nextLevelVertices[3];
-  newElement->vertex_[1]=nextLevelVertices[5];
-  newElement->vertex_[2]=nextLevelVertices[4];
-  newElement->refinementIndex_=3;
-  nextLevelElements[3]=newElement;
-  element.sons_[3]=newElement;
-  dvverb<<"Pushed element "<<newElement<<" refindex="<<newElement->refinementIndex_<<std::endl;
-
-
-  // Now that all the triangle are created, we can update the elements attached
-  // to the edges.
-  // The new neighbors of the edges lying on edges of the father element.
-  std::size_t neighbors[6] = {0, 1, 2, 0, 1, 2};
-  dvverb<<" element "<<&element<<std::endl;
-  for(std::size_t i=0; i<6; ++i){
-    // Overwrite the father element by the newly created elements.
-    dvverb<<" neighbour "<<i<<": ";
-    overwriteFineLevelNeighbours(*nextLevelEdges[i], nextLevelElements[neighbors[i]],
-                                 &element);
-  }
-
-  // Update the neighbours of the inner edges
-  nextLevelEdges[6]->elements_.push_back(nextLevelElements[0]);
-  nextLevelEdges[6]->elements_.push_back(nextLevelElements[3]);
-  nextLevelEdges[7]->elements_.push_back(nextLevelElements[3]);
-  nextLevelEdges[7]->elements_.push_back(nextLevelElements[1]);
-  nextLevelEdges[8]->elements_.push_back(nextLevelElements[3]);
-  nextLevelEdges[8]->elements_.push_back(nextLevelElements[2]);
-
-#ifndef NDEBUG
-  for(std::size_t vidx=0; vidx<4; ++vidx)
-  {
-    dvverb<<std::endl<<" Element "<<nextLevelElements[vidx]<<": ";
-    for(EdgeIterator edge=nextLevelElements[vidx]->edges_.begin();
-        edge != nextLevelElements[vidx]->edges_.end(); ++edge)
+    if (vIt->isLeaf())
     {
-      dvverb<<std::endl<<"   edge "<<*edge<<": ";
-      typedef typename std::vector<const FoamGridEntityImp<2,dimworld>*>::iterator
-      ElementIterator;
-      bool selfFound=false;
-      for(ElementIterator elem=(*edge)->elements_.begin();
-          elem != (*edge)->elements_.end();
-          ++elem)
-      {
-        dvverb << *elem<<" ";
-        if(*elem == nextLevelElements[vidx])
-          selfFound=true;
-      }
-      assert(selfFound);
+      assert(leafVertices[vIt->leafIndex_]==vIt.address());
+      leafVertices[vIt->leafIndex_]=&newVertices.back();
     }
   }
 
-#endif
-  element.nSons_=4;
+  FoamGridEntityStorage<Element> newElements;
+  newElements.reserve(elements.size());
 
-  if((refCount--)>1)
+  typedef typename FoamGridEntityStorage<Element>::iterator ElementIterator;
+  for (ElementIterator eIt=elements.begin(); eIt!=elements.end(); ++eIt)
   {
-    int i=0;
-    typedef typename array<FoamGridEntityImp<2,dimworld>*, 4>::iterator ElementIterator;
-    for(ElementIterator elem=nextLevelElements.begin();
-        elem != nextLevelElements.end(); ++elem)
-    {
-      dvverb<<std::endl<<"Refinining "<<(*elem)<<" (son of"<<&element<<") refCount="<<refCount<<" child="<<i++<<std::endl;
-      refineSimplexElement(**elem, refCount);
-    }
-  }
+    assert(eIt->levelIndex_==newElements.size());
+    newElements.push_back(*eIt);
+    Element& element = newElements.back();
 
-  std::cout << "end refineSimplex" << std::endl;
-  std::cout << "Vertices " << nextLevel << ": " << Dune::get<0>(entityImps_[nextLevel]).size()
-            << std::endl;
-  std::cout << "Edges " << nextLevel << ": " << Dune::get<1>(entityImps_[nextLevel]).size()
-            << std::endl;
-  std::cout << "Elements " << nextLevel << ": " << Dune::get<2>(entityImps_[nextLevel]).size()
-            << std::endl;
-}
+    for (int i=0; i<2; i++)
+      element.vertex_[i]=vertexMap[element.vertex_[i]->levelIndex_];
 
+    // The father and the sons live on the neighboring levels, which stay in place
+    if (element.father_)
+      element.father_->sons_[element.refinementIndex_]=&element;
+    for (unsigned int k=0; k<element.nSons_; k++)
+      element.sons_[k]->father_=&element;
 
-// Overwrites the neighbours of this and descendant edges
-template <int dimworld>
-void Dune::FoamGrid<dimworld>::overwriteFineLevelNeighbours(FoamGridEntityImp<1,dimworld>& edge,
-                                                            FoamGridEntityImp<2,dimworld>* son,
-                                                            FoamGridEntityImp<2,dimworld>* father)
-{
-  typedef typename std::vector<const FoamGridEntityImp<2,dimworld>*>::iterator ElementIterator;
-#ifndef NDEBUG
-  bool fatherFound=false;
-#endif
-  for(ElementIterator elem=edge.elements_.begin();
-      elem != edge.elements_.end();
-      ++elem)
-  {
-    dvverb << *elem<<" ";
-    if (*elem == father)
+    if (element.isLeaf())
     {
-#ifndef NDEBUG
-      fatherFound=true;
-#endif
-      *elem = son;
+      assert(leafElements[element.leafIndex_]==eIt.address());
+      leafElements[element.leafIndex_]=&element;
     }
   }
 
-#ifndef NDEBUG
-  dvverb<<std::endl;
-  assert(fatherFound);
-#endif
+  // The copies on the next coarser level know their sons
+  if (level>0)
+  {
+    FoamGridEntityStorage<Vertex>& coarseVertices = Dune::get<0>(entityImps_[level-1]);
+    for (VertexIterator vIt=coarseVertices.begin(); vIt!=coarseVertices.end(); ++vIt)
+      if (vIt->son_)
+        vIt->son_=vertexMap[vIt->son_->levelIndex_];
+  }
 
-  for(std::size_t i=0; i<edge.nSons_; ++i)
-    overwriteFineLevelNeighbours(*edge.sons_[i], son, father);
-}
+  vertices=std::move(newVertices);
+  elements=std::move(newElements);
+  updateAdjacency(level);
 
+  return oldBytes - (vertices.capacity()*sizeof(Vertex) + elements.capacity()*sizeof(Element));
+}
 
 // Recompute the grid indices after the grid has changed
-template <int dimworld>
-void Dune::FoamGrid<dimworld>::setIndices()
+template <int dimworld, class ct>
+void Dune::FoamGrid<dimworld,ct>::setIndices()
 {
   // //////////////////////////////////////////
   //   Create the index sets
   // //////////////////////////////////////////
   for (int i=levelIndexSets_.size(); i<=maxLevel(); i++) {
     FoamGridLevelIndexSet<const FoamGrid >* p
-      = new FoamGridLevelIndexSet<const FoamGrid >();
+      = new FoamGridLevelIndexSet<const FoamGrid >(i);
     levelIndexSets_.push_back(p);
   }
 
   for (int i=0; i<=maxLevel(); i++)
     if (levelIndexSets_[i])
+    {
       levelIndexSets_[i]->update(*this, i);
+      updateAdjacency(i);
+    }
 
   // Update the leaf indices
   leafGridView_.indexSet_.update(*this);
+  ++indexGeneration_;
+}
+
+// Change the numbering policy of the leaf index set and renumber
+template <int dimworld, class ct>
+void Dune::FoamGrid<dimworld,ct>::setLeafOrdering(FoamGridLeafOrdering ordering)
+{
+  leafGridView_.indexSet_.setOrdering(ordering);
+  if (entityImps_.empty())
+    return;
+
+  leafGridView_.indexSet_.update(*this);
+  ++indexGeneration_;
+}
+
+// Rebuild the vertex-to-element adjacency of a level
+template <int dimworld, class ct>
+void Dune::FoamGrid<dimworld,ct>::updateAdjacency(int level)
+{
+  Dune::get<2>(entityImps_[level]).build(Dune::get<0>(entityImps_[level]),
+                                         Dune::get<1>(entityImps_[level]));
+}
+
+// Refill the leaf coordinate store if the indices have changed since
+template <int dimworld, class ct>
+const Dune::FoamGridCoordinateStore<dimworld,ct>&
+Dune::FoamGrid<dimworld,ct>::leafCoordinates() const
+{
+  if (leafCoordinates_.generation_ != indexGeneration_)
+  {
+    leafCoordinates_.update(Dune::get<0>(leafIndexSet().leafEntities_),
+                            Dune::get<1>(leafIndexSet().leafEntities_),
+                            &FoamGridEntityImp<0,dimworld,ctype>::leafIndex_);
+    leafCoordinates_.generation_ = indexGeneration_;
+  }
+  return leafCoordinates_;
 }
 
-//template <int dimworld>
-//void Dune::FoamGrid<dimworld>::refineLineElement(FoamGridEntityImp<1,dimworld>& element,
-//						 int refCount)
-//{
-//  std::cout<<"refineLineElement "<<std::endl;
-//     if(refCount<0)
-//   {
-//     // We always remove all the children from the father.
-//     // Removing means:
-//     // 1. remove pointers in father element, edges and vertices
-//     // 2. Mark removed entities for deletion.
-//     DUNE_THROW(NotImplemented, "Coarsening not implemented yet");
-//     return;
-//   }
-//
-//   unsigned int nextLevel=element.level()+1;
-//
-//     std::cout << "Vertices " << nextLevel << ": " << Dune::get<0>(entityImps_[nextLevel]).size()
-//               << std::endl;
-//     std::cout << "Elements " << nextLevel << ": " <<Dune::get<1>(entityImps_[nextLevel]).size()
-//               << std::endl;
-//
-//   array<FoamGridEntityImp<0,dimworld>*, 3> nextLevelVertices;
-//   std::size_t vertexIndex=0;
-//
-//     for(unsigned int c=0; c<element.vertex_.size(); ++c)
-//   {
-//     //ES: kopieren der Punkte warum brauche ich das ?
-//     if(element.vertex_[c]->son_==nullptr){
-//             // Not refined yet
-//       Dune::get<0>(entityImps_[nextLevel])
-//       .push_back(FoamGridEntityImp<0,dimworld>(nextLevel,
-//                                                element.vertex_[c]->pos_,
-//                                                element.vertex_[c]->id_));
-//       FoamGridEntityImp<0,dimworld>& newVertex =
-//       Dune::get<0>(entityImps_[nextLevel]).back();
-//       element.vertex_[c]->son_=&newVertex;
-//
-//     }
-//   }
-//
-//       if(!(element->nSons_)
-//     {
-//       // Not refined yet
-//       // Compute edge midpoint
-//       FieldVector<double, dimworld> midPoint;
-//       for(int dim=0; dim<dimworld;++dim)
-//         midPoint[dim]=(element->vertex_[0]->pos_[dim]
-//         + element->vertex_[1]->pos_[dim]) /2.0;
-//
-//       //create midpoint
-//       Dune::get<0>(entityImps_[nextLevel])
-//         .push_back(FoamGridEntityImp<0,dimworld>(nextLevel, midPoint,
-//                                                freeIdCounter_[0]++));
-//       FoamGridEntityImp<0,dimworld>& midVertex =
-//         Dune::get<0>(entityImps_[nextLevel]).back();
-//       check_for_duplicates(nextLevelVertices, &midVertex, vertexIndex);
-//       nextLevelVertices[vertexIndex++]=&midVertex;
-//     }
-//
-//}
\ No newline at end of file
+// Refill the coordinate store of a level if the indices have changed since
+template <int dimworld, class ct>
+const Dune::FoamGridCoordinateStore<dimworld,ct>&
+Dune::FoamGrid<dimworld,ct>::levelCoordinates(int level) const
+{
+  if (level<0 || level>maxLevel())
+    DUNE_THROW(GridError, "levelCoordinates of nonexisting level " << level << " requested!");
+
+  if (levelCoordinates_.size() != entityImps_.size())
+    levelCoordinates_.resize(entityImps_.size());
+
+  FoamGridCoordinateStore<dimworld,ctype>& store = levelCoordinates_[level];
+  if (store.generation_ != indexGeneration_)
+  {
+    // The level indices are the positions in the entity storage
+    std::vector<const FoamGridEntityImp<0,dimworld,ctype>*> vertices;
+    vertices.reserve(Dune::get<0>(entityImps_[level]).size());
+    typename FoamGridEntityStorage<FoamGridEntityImp<0,dimworld,ctype> >::const_iterator vIt;
+    for (vIt = Dune::get<0>(entityImps_[level]).begin(); vIt != Dune::get<0>(entityImps_[level]).end(); ++vIt)
+      vertices.push_back(vIt.address());
+
+    std::vector<const FoamGridEntityImp<1,dimworld,ctype>*> elements;
+    elements.reserve(Dune::get<1>(entityImps_[level]).size());
+    typename FoamGridEntityStorage<FoamGridEntityImp<1,dimworld,ctype> >::const_iterator eIt;
+    for (eIt = Dune::get<1>(entityImps_[level]).begin(); eIt != Dune::get<1>(entityImps_[level]).end(); ++eIt)
+      elements.push_back(eIt.address());
+
+    store.update(vertices, elements, &FoamGridEntityImp<0,dimworld,ctype>::levelIndex_);
+    store.generation_ = indexGeneration_;
+  }
+  return store;
+}
+
+// Collect the memory used by the levels and the other data structures
+template <int dimworld, class ct>
+Dune::FoamGridMemoryUsage Dune::FoamGrid<dimworld,ct>::memoryUsage() const
+{
+  FoamGridMemoryUsage usage;
+  usage.entities.resize(entityImps_.size());
+  usage.adjacency.resize(entityImps_.size());
+  usage.levelIndexSets.resize(entityImps_.size(), 0);
+
+  for (std::size_t level=0; level<entityImps_.size(); level++)
+  {
+    usage.entities[level][0] = Dune::get<1>(entityImps_[level]).memoryUsage();
+    usage.entities[level][1] = Dune::get<0>(entityImps_[level]).memoryUsage();
+    usage.adjacency[level] = Dune::get<2>(entityImps_[level]).memoryUsage();
+    if (level<levelIndexSets_.size() && levelIndexSets_[level])
+      usage.levelIndexSets[level] = levelIndexSets_[level]->memoryUsage();
+  }
+
+  usage.leafIndexSet = leafIndexSet().memoryUsage();
+
+  usage.coordinates = leafCoordinates_.memoryUsage()
+                      + levelCoordinates_.capacity()*sizeof(FoamGridCoordinateStore<dimworld,ctype>);
+  for (std::size_t level=0; level<levelCoordinates_.size(); level++)
+    usage.coordinates += levelCoordinates_[level].memoryUsage();
+
+  usage.grid = sizeof(*this)
+               + entityImps_.capacity()*sizeof(LevelEntities)
+               + levelIndexSets_.capacity()*sizeof(FoamGridLevelIndexSet<const FoamGrid>*)
+               + growthVertices_.capacity()*sizeof(FieldVector<ctype,dimworld>)
+               + growthComponents_.capacity()*sizeof(unsigned int)
+               + growthLevels_.capacity()*sizeof(int)
+               + growthElements_.capacity()*sizeof(array<GrowthVertex,2>)
+               + growthRemovals_.capacity()*sizeof(FoamGridEntityImp<1,dimworld,ctype>*);
+
+  return usage;
+}
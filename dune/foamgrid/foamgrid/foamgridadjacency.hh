@@ -0,0 +1,271 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#ifndef DUNE_FOAMGRID_ADJACENCY_HH
+#define DUNE_FOAMGRID_ADJACENCY_HH
+
+/** \file
+* \brief The vertex-to-element adjacency of a FoamGrid level
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Dune {
+
+    template <int dim, int dimworld, class ctype>
+    class FoamGridEntityImp;
+
+    /** \brief Read-only view of a contiguous range of element pointers
+     *
+     * \tparam Element The element implementation class
+     */
+    template <class Element>
+    class FoamGridElementSpan
+    {
+    public:
+
+        typedef const Element* const* const_iterator;
+
+        FoamGridElementSpan()
+            : begin_(nullptr), size_(0)
+        {}
+
+        FoamGridElementSpan(const_iterator begin, unsigned int size)
+            : begin_(begin), size_(size)
+        {}
+
+        const_iterator begin() const {
+            return begin_;
+        }
+
+        const_iterator end() const {
+            return begin_ + size_;
+        }
+
+        unsigned int size() const {
+            return size_;
+        }
+
+        bool empty() const {
+            return size_ == 0;
+        }
+
+        const Element* operator[](unsigned int i) const {
+            assert(i < size_);
+            return begin_[i];
+        }
+
+    private:
+        const_iterator begin_;
+        unsigned int size_;
+    };
+
+    /** \brief Short list of element pointers with inline storage
+     *
+     * The first N elements are stored inside the object itself.  Only when more
+     * are added the list moves to the heap, which for a network grid happens
+     * at junctions of more than N+1 segments only.
+     *
+     * \tparam Element The element implementation class
+     * \tparam N The number of elements stored inline
+     */
+    template <class Element, unsigned int N>
+    class FoamGridElementBuffer
+    {
+    public:
+
+        FoamGridElementBuffer()
+            : size_(0)
+        {}
+
+        void clear() {
+            size_ = 0;
+            overflow_.clear();
+        }
+
+        void push_back(const Element* element)
+        {
+            if (size_ < N)
+                inline_[size_] = element;
+            else
+                overflow_.push_back(element);
+            ++size_;
+        }
+
+        unsigned int size() const {
+            return size_;
+        }
+
+        bool empty() const {
+            return size_ == 0;
+        }
+
+        const Element* operator[](unsigned int i) const {
+            assert(i < size_);
+            return (i < N) ? inline_[i] : overflow_[i-N];
+        }
+
+    private:
+        const Element* inline_[N];
+        std::vector<const Element*> overflow_;
+        unsigned int size_;
+    };
+
+    /** \brief The elements containing each vertex of one grid level
+     *
+     * The adjacency is stored in compressed sparse row format: one flat array
+     * holds the adjacent elements of all vertices, grouped by the level index
+     * of the vertex, and an offset array marks where the group of each vertex
+     * begins.  Every vertex additionally knows its own range, so that the
+     * intersections can read it without going through the grid.
+     *
+     * Adaptation changes the adjacency incrementally.  An element is removed
+     * by moving the last element of the range into its place.  A range that
+     * is too small for a new element is moved into a pool of blocks that are
+     * never reallocated, with room to grow.  The space left behind is only
+     * reclaimed by the next call to build().
+     *
+     * \tparam dimworld The world dimension
+     * \tparam ctype The type used for the coordinates
+     */
+    template <int dimworld, class ctype>
+    class FoamGridLevelAdjacency
+    {
+        typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+        typedef FoamGridEntityImp<1,dimworld,ctype> Element;
+
+    public:
+
+        /** \brief Number of element pointers per block of the pool */
+        enum {poolBlockSize = 256};
+
+        FoamGridLevelAdjacency()
+            : poolUsed_(0)
+        {}
+
+        /** \brief Move constructor, keeps the arrays the vertices point into */
+        FoamGridLevelAdjacency(FoamGridLevelAdjacency&& other) noexcept
+            : elements_(std::move(other.elements_)),
+              pool_(std::move(other.pool_)),
+              poolUsed_(other.poolUsed_)
+        {}
+
+        /** \brief Move assignment, keeps the arrays the vertices point into */
+        FoamGridLevelAdjacency& operator=(FoamGridLevelAdjacency&& other) noexcept
+        {
+            elements_ = std::move(other.elements_);
+            pool_ = std::move(other.pool_);
+            poolUsed_ = other.poolUsed_;
+            return *this;
+        }
+
+        /** \brief Recompute the adjacency of a level
+         *
+         * \param vertices The vertices of the level, their level indices have to be up to date
+         * \param elements The elements of the level
+         */
+        template <class VertexStorage, class ElementStorage>
+        void build(VertexStorage& vertices, const ElementStorage& elements)
+        {
+            const std::size_t numVertices = vertices.size();
+
+            // Count the elements of each vertex
+            std::vector<unsigned int> offsets(numVertices+1, 0);
+            for (typename ElementStorage::const_iterator eIt = elements.begin(); eIt != elements.end(); ++eIt)
+                for (int i=0; i<2; i++)
+                    ++offsets[eIt->vertex_[i]->levelIndex_+1];
+
+            for (std::size_t i=0; i<numVertices; i++)
+                offsets[i+1] += offsets[i];
+
+            // Sort the elements into the groups of their vertices
+            elements_.resize(offsets[numVertices]);
+            std::vector<unsigned int> position(offsets.begin(), offsets.end()-1);
+
+            for (typename ElementStorage::const_iterator eIt = elements.begin(); eIt != elements.end(); ++eIt)
+                for (int i=0; i<2; i++)
+                    elements_[position[eIt->vertex_[i]->levelIndex_]++] = &*eIt;
+
+            // Tell the vertices where their range is
+            for (typename VertexStorage::iterator vIt = vertices.begin(); vIt != vertices.end(); ++vIt) {
+                const unsigned int index = vIt->levelIndex_;
+                vIt->elementsBegin_ = elements_.empty() ? nullptr : &elements_[0] + offsets[index];
+                vIt->nElements_ = vIt->elementsCapacity_ = offsets[index+1] - offsets[index];
+            }
+
+            pool_.clear();
+            poolUsed_ = 0;
+        }
+
+        /** \brief Bytes allocated for the element pointers, including the pool */
+        std::size_t memoryUsage() const
+        {
+            std::size_t result = elements_.capacity()*sizeof(const Element*)
+                + pool_.capacity()*sizeof(std::vector<const Element*>);
+            for (std::size_t i=0; i<pool_.size(); i++)
+                result += pool_[i].capacity()*sizeof(const Element*);
+            return result;
+        }
+
+        /** \brief Add an element to the elements containing a vertex */
+        void insert(Vertex& vertex, const Element* element)
+        {
+            if (vertex.nElements_ == vertex.elementsCapacity_)
+                relocate(vertex, std::max(2u, 2*vertex.elementsCapacity_));
+
+            const_cast<const Element**>(vertex.elementsBegin_)[vertex.nElements_++] = element;
+        }
+
+        /** \brief Remove an element from the elements containing a vertex
+         *
+         * The order of the remaining elements may change.
+         */
+        void remove(Vertex& vertex, const Element* element)
+        {
+            const Element** begin = const_cast<const Element**>(vertex.elementsBegin_);
+            const Element** end = begin + vertex.nElements_;
+            const Element** it = std::find(begin, end, element);
+            assert(it != end);
+
+            *it = *(end-1);
+            --vertex.nElements_;
+        }
+
+    private:
+
+        // Copying would leave the vertices pointing into the arrays of the original
+        FoamGridLevelAdjacency(const FoamGridLevelAdjacency&);
+        FoamGridLevelAdjacency& operator=(const FoamGridLevelAdjacency&);
+
+        /** \brief Move the range of a vertex into the pool */
+        void relocate(Vertex& vertex, unsigned int capacity)
+        {
+            if (pool_.empty() || poolUsed_ + capacity > pool_.back().size()) {
+                pool_.push_back(std::vector<const Element*>(std::max<std::size_t>(capacity, poolBlockSize)));
+                poolUsed_ = 0;
+            }
+
+            const Element** range = &pool_.back()[0] + poolUsed_;
+            poolUsed_ += capacity;
+
+            std::copy(vertex.elementsBegin_, vertex.elementsBegin_ + vertex.nElements_, range);
+            vertex.elementsBegin_ = range;
+            vertex.elementsCapacity_ = capacity;
+        }
+
+        /** \brief The adjacent elements of all vertices, grouped by vertex */
+        std::vector<const Element*> elements_;
+
+        /** \brief Blocks for the ranges that outgrew their place in elements_ */
+        std::vector<std::vector<const Element*> > pool_;
+
+        /** \brief Number of entries of the last block of the pool in use */
+        std::size_t poolUsed_;
+    };
+
+}  // namespace Dune
+
+#endif
@@ -0,0 +1,383 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#ifndef DUNE_FOAMGRID_BACKUPRESTORE_HH
+#define DUNE_FOAMGRID_BACKUPRESTORE_HH
+
+/** \file
+    \brief Binary backup and restore of a FoamGrid with its whole refinement hierarchy
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <dune/common/exceptions.hh>
+#include <dune/grid/common/backuprestore.hh>
+
+#include "../foamgrid.hh"
+
+namespace Dune {
+
+    /** \brief Backup and restore of FoamGrid
+     *
+     * The backup holds every level of the grid: vertex positions, ids, level and
+     * leaf indices, and the links between the entities (vertices of elements, fathers,
+     * sons and vertex copies), which are stored as level indices.  The id counters
+     * and the leaf ordering are stored as well, hence a restored grid continues to
+     * hand out the same ids and leaf indices as the original grid would.  Refinement marks are not stored.
+     *
+     * The format is binary, in the byte order of the machine that wrote it.  A file
+     * consists of a header followed by the records of each level:
+     * \code
+     * Header
+     * for each level: LevelHeader, VertexRecord[numVertices], ElementRecord[numElements]
+     * \endcode
+     * All records have sizes that are multiples of eight bytes, so they are read in
+     * place.  Restoring from a file maps it into memory, creates all entities in one
+     * pass over the records and sets up the links between them in a second one.
+     * Positions are always stored in double precision, hence a backup can be restored
+     * into a grid with another coordinate type.
+     */
+    template <int dimworld, class ct>
+    struct BackupRestoreFacility<FoamGrid<dimworld, ct> >
+    {
+        typedef FoamGrid<dimworld, ct> Grid;
+
+        typedef typename Grid::ctype ctype;
+
+        /** \brief Version of the format, increased whenever the records change */
+        enum {version = 2};
+
+        /** \brief Marks a missing link */
+        static const unsigned int none = ~0u;
+
+        struct Header
+        {
+            char magic[8];
+            unsigned int byteOrder;
+            unsigned int version;
+            unsigned int dimworld;
+            unsigned int numLevels;
+            unsigned int freeIdCounter[2];
+            int globalRefined;
+            /** \brief The FoamGridLeafOrdering of the leaf index set, zero in version 1 */
+            unsigned int leafOrdering;
+            unsigned long long numBoundarySegments;
+        };
+
+        struct LevelHeader
+        {
+            unsigned long long numVertices;
+            unsigned long long numElements;
+        };
+
+        struct VertexRecord
+        {
+            double pos[dimworld];
+            unsigned int id;
+            unsigned int boundaryId;
+            unsigned int leafIndex;
+            /** \brief Level index of the copy on the next level, or none */
+            unsigned int son;
+        };
+
+        struct ElementRecord
+        {
+            /** \brief Level indices of the vertices */
+            unsigned int vertex[2];
+            unsigned int id;
+            unsigned int leafIndex;
+            /** \brief Level index of the father on the previous level, or none */
+            unsigned int father;
+            /** \brief Level indices of the sons on the next level, or none */
+            unsigned int sons[2];
+            unsigned int refinementIndex;
+        };
+
+        /** \brief Write a grid to a file */
+        static void backup(const Grid& grid, const std::string& filename)
+        {
+            std::ofstream stream(filename.c_str(), std::ios::binary);
+            if (!stream)
+                DUNE_THROW(IOError, "Could not open " << filename << " for writing");
+            backup(grid, stream);
+        }
+
+        /** \brief Write a grid to a binary stream */
+        static void backup(const Grid& grid, std::ostream& stream)
+        {
+            typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+            typedef FoamGridEntityImp<1,dimworld,ctype> Element;
+
+            Header header;
+            std::memset(&header, 0, sizeof(Header));
+            std::memcpy(header.magic, "FOAMGRID", 8);
+            header.byteOrder = 0x01020304;
+            header.version = version;
+            header.dimworld = dimworld;
+            header.numLevels = grid.entityImps_.size();
+            header.freeIdCounter[0] = grid.freeIdCounter_[0];
+            header.freeIdCounter[1] = grid.freeIdCounter_[1];
+            header.globalRefined = grid.globalRefined;
+            header.leafOrdering = grid.leafOrdering();
+            header.numBoundarySegments = grid.numBoundarySegments_;
+            write(stream, &header, 1);
+
+            std::vector<VertexRecord> vertexRecords;
+            std::vector<ElementRecord> elementRecords;
+
+            for (std::size_t level=0; level<grid.entityImps_.size(); level++) {
+                const FoamGridEntityStorage<Vertex>& vertices = Dune::get<0>(grid.entityImps_[level]);
+                const FoamGridEntityStorage<Element>& elements = Dune::get<1>(grid.entityImps_[level]);
+
+                LevelHeader levelHeader;
+                levelHeader.numVertices = vertices.size();
+                levelHeader.numElements = elements.size();
+                write(stream, &levelHeader, 1);
+
+                // The links are level indices, which are the positions in the storage
+                vertexRecords.resize(vertices.size());
+                typename FoamGridEntityStorage<Vertex>::const_iterator vIt = vertices.begin();
+                for (std::size_t i=0; i<vertexRecords.size(); i++, ++vIt) {
+                    assert(vIt->levelIndex_ == i);
+                    VertexRecord& record = vertexRecords[i];
+                    for (int j=0; j<dimworld; j++)
+                        record.pos[j] = vIt->pos_[j];
+                    record.id = vIt->id_;
+                    record.boundaryId = vIt->boundaryId_;
+                    record.leafIndex = vIt->leafIndex_;
+                    record.son = vIt->son_ ? vIt->son_->levelIndex_ : none;
+                }
+                write(stream, vertexRecords.empty() ? nullptr : &vertexRecords[0], vertexRecords.size());
+
+                elementRecords.resize(elements.size());
+                typename FoamGridEntityStorage<Element>::const_iterator eIt = elements.begin();
+                for (std::size_t i=0; i<elementRecords.size(); i++, ++eIt) {
+                    assert(eIt->levelIndex_ == i);
+                    ElementRecord& record = elementRecords[i];
+                    for (int k=0; k<2; k++) {
+                        record.vertex[k] = eIt->vertex_[k]->levelIndex_;
+                        record.sons[k] = eIt->sons_[k] ? eIt->sons_[k]->levelIndex_ : none;
+                    }
+                    record.id = eIt->id_;
+                    record.leafIndex = eIt->leafIndex_;
+                    record.father = eIt->father_ ? eIt->father_->levelIndex_ : none;
+                    record.refinementIndex = eIt->refinementIndex_;
+                }
+                write(stream, elementRecords.empty() ? nullptr : &elementRecords[0], elementRecords.size());
+            }
+
+            if (!stream)
+                DUNE_THROW(IOError, "Writing the grid backup failed");
+        }
+
+        /** \brief Read a grid from a file, which is mapped into memory
+         *
+         * \return A new grid, the caller takes responsibility of it
+         */
+        static Grid* restore(const std::string& filename)
+        {
+            const int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd < 0)
+                DUNE_THROW(IOError, "Could not open " << filename << " for reading");
+
+            struct stat status;
+            if (::fstat(fd, &status) != 0 || status.st_size == 0) {
+                ::close(fd);
+                DUNE_THROW(IOError, "Could not read " << filename);
+            }
+
+            const std::size_t size = status.st_size;
+            void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (data == MAP_FAILED)
+                DUNE_THROW(IOError, "Could not map " << filename << " into memory");
+
+            Grid* grid = nullptr;
+            try {
+                grid = restore(static_cast<const char*>(data), size);
+            } catch (...) {
+                ::munmap(data, size);
+                throw;
+            }
+
+            ::munmap(data, size);
+            return grid;
+        }
+
+        /** \brief Read a grid from a binary stream
+         *
+         * \return A new grid, the caller takes responsibility of it
+         */
+        static Grid* restore(std::istream& stream)
+        {
+            // operator new aligns the buffer for any of the records
+            std::vector<char> buffer((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+            if (buffer.empty())
+                DUNE_THROW(IOError, "The grid backup is empty");
+            return restore(&buffer[0], buffer.size());
+        }
+
+    private:
+
+        template <class T>
+        static void write(std::ostream& stream, const T* data, std::size_t n)
+        {
+            stream.write(reinterpret_cast<const char*>(data), n*sizeof(T));
+        }
+
+        /** \brief Return n records at the position and advance it, check the size of the data */
+        template <class T>
+        static const T* read(const char*& position, const char* end, std::size_t n)
+        {
+            if (n > static_cast<std::size_t>(end - position) / sizeof(T))
+                DUNE_THROW(IOError, "The grid backup is truncated");
+            const T* records = reinterpret_cast<const T*>(position);
+            position += n*sizeof(T);
+            return records;
+        }
+
+        static unsigned int checkLink(unsigned int index, std::size_t size)
+        {
+            if (index >= size)
+                DUNE_THROW(IOError, "The grid backup contains a link to a nonexisting entity");
+            return index;
+        }
+
+        /** \brief Create a grid from a backup in memory */
+        static Grid* restore(const char* data, std::size_t size)
+        {
+            typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+            typedef FoamGridEntityImp<1,dimworld,ctype> Element;
+
+            const char* position = data;
+            const char* end = data + size;
+
+            const Header& header = *read<Header>(position, end, 1);
+            if (std::memcmp(header.magic, "FOAMGRID", 8) != 0 || header.byteOrder != 0x01020304)
+                DUNE_THROW(IOError, "Not a FoamGrid backup, or written on a machine with another byte order");
+            // Version 1 only lacks the leaf ordering, the word was zero
+            if (header.version != version && header.version != 1)
+                DUNE_THROW(IOError, "FoamGrid backup has version " << header.version << ", expected " << int(version));
+            if (header.dimworld != dimworld)
+                DUNE_THROW(IOError, "FoamGrid backup has dimworld " << header.dimworld << ", expected " << dimworld);
+            if (header.numLevels == 0)
+                DUNE_THROW(IOError, "FoamGrid backup without levels");
+
+            Grid* grid = new Grid;
+            try {
+                grid->addLevel(header.numLevels-1);
+                grid->freeIdCounter_[0] = header.freeIdCounter[0];
+                grid->freeIdCounter_[1] = header.freeIdCounter[1];
+                grid->globalRefined = header.globalRefined;
+                if (header.leafOrdering > networkOrder)
+                    DUNE_THROW(IOError, "FoamGrid backup has the unknown leaf ordering " << header.leafOrdering);
+                grid->leafGridView_.indexSet_.setOrdering(static_cast<FoamGridLeafOrdering>(header.leafOrdering));
+                grid->numBoundarySegments_ = header.numBoundarySegments;
+
+                std::vector<const VertexRecord*> vertexRecords(header.numLevels);
+                std::vector<const ElementRecord*> elementRecords(header.numLevels);
+                std::vector<std::vector<Vertex*> > vertices(header.numLevels);
+                std::vector<std::vector<Element*> > elements(header.numLevels);
+
+                // Create the entities.  They do not move in their storage, hence the
+                // pointers collected here can be linked once all levels exist.
+                FieldVector<ctype,dimworld> pos;
+                for (std::size_t level=0; level<header.numLevels; level++) {
+                    const LevelHeader& levelHeader = *read<LevelHeader>(position, end, 1);
+                    vertexRecords[level] = read<VertexRecord>(position, end, levelHeader.numVertices);
+                    elementRecords[level] = read<ElementRecord>(position, end, levelHeader.numElements);
+
+                    FoamGridEntityStorage<Vertex>& vertexStorage = Dune::get<0>(grid->entityImps_[level]);
+                    vertexStorage.reserve(levelHeader.numVertices);
+                    vertices[level].resize(levelHeader.numVertices);
+                    for (std::size_t i=0; i<levelHeader.numVertices; i++) {
+                        const VertexRecord& record = vertexRecords[level][i];
+                        for (int j=0; j<dimworld; j++)
+                            pos[j] = record.pos[j];
+                        vertexStorage.push_back(Vertex(level, pos, record.id));
+                        vertices[level][i] = &vertexStorage.back();
+                        vertices[level][i]->boundaryId_ = record.boundaryId;
+                        vertices[level][i]->leafIndex_ = record.leafIndex;
+                    }
+
+                    FoamGridEntityStorage<Element>& elementStorage = Dune::get<1>(grid->entityImps_[level]);
+                    elementStorage.reserve(levelHeader.numElements);
+                    elements[level].resize(levelHeader.numElements);
+                    for (std::size_t i=0; i<levelHeader.numElements; i++) {
+                        const ElementRecord& record = elementRecords[level][i];
+                        elementStorage.push_back(Element(nullptr, nullptr, level, record.id));
+                        elements[level][i] = &elementStorage.back();
+                        elements[level][i]->leafIndex_ = record.leafIndex;
+                    }
+                }
+
+                if (position != end)
+                    DUNE_THROW(IOError, "The grid backup has trailing data");
+
+                // Set up the links
+                for (std::size_t level=0; level<header.numLevels; level++) {
+                    const std::size_t numFiner = (level+1 < header.numLevels) ? vertices[level+1].size() : 0;
+                    const std::size_t numFinerElements = (level+1 < header.numLevels) ? elements[level+1].size() : 0;
+
+                    for (std::size_t i=0; i<vertices[level].size(); i++) {
+                        const unsigned int son = vertexRecords[level][i].son;
+                        if (son != none)
+                            vertices[level][i]->son_ = vertices[level+1][checkLink(son, numFiner)];
+                    }
+
+                    for (std::size_t i=0; i<elements[level].size(); i++) {
+                        const ElementRecord& record = elementRecords[level][i];
+                        Element& element = *elements[level][i];
+
+                        for (int k=0; k<2; k++)
+                            element.vertex_[k] = vertices[level][checkLink(record.vertex[k], vertices[level].size())];
+
+                        if (record.father != none) {
+                            if (level == 0)
+                                DUNE_THROW(IOError, "The grid backup contains a father of a level 0 element");
+                            element.father_ = elements[level-1][checkLink(record.father, elements[level-1].size())];
+                        }
+
+                        if (record.sons[0] != none) {
+                            for (int k=0; k<2; k++)
+                                element.sons_[k] = elements[level+1][checkLink(record.sons[k], numFinerElements)];
+                            element.nSons_ = 2;
+                        }
+
+                        element.refinementIndex_ = record.refinementIndex;
+                    }
+                }
+
+                // The level indices are the positions in the storage, as in the backup
+                for (int level=0; level<=grid->maxLevel(); level++) {
+                    grid->levelIndexSets_[level]->update(*grid, level);
+                    grid->updateAdjacency(level);
+                }
+
+                grid->leafGridView_.indexSet_.restore(*grid);
+                ++grid->indexGeneration_;
+            } catch (...) {
+                delete grid;
+                throw;
+            }
+
+            return grid;
+        }
+    };
+
+    template <int dimworld, class ct>
+    const unsigned int BackupRestoreFacility<FoamGrid<dimworld, ct> >::none;
+
+}  // namespace Dune
+
+#endif
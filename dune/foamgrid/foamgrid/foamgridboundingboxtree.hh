@@ -0,0 +1,391 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#ifndef DUNE_FOAMGRID_BOUNDINGBOXTREE_HH
+#define DUNE_FOAMGRID_BOUNDINGBOXTREE_HH
+
+/** \file
+* \brief Bounding box tree over the segments of a coordinate store
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <dune/common/array.hh>
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+
+#include "foamgridcoordinates.hh"
+
+namespace Dune {
+
+    /** \brief Axis-aligned bounding box tree over the segments of a coordinate store
+     *
+     * The tree answers nearest segment, points within a radius and box queries in
+     * logarithmic time.  It is built from a FoamGridCoordinateStore, usually the one
+     * of the leaf grid returned by FoamGrid::leafCoordinates(), and the queries return
+     * the indices of the segments in that store, i.e. their leaf indices.
+     *
+     * The nodes are kept in one flat array, the children of a node are stored next to
+     * each other behind it.  Each leaf node covers a range of an array of segment
+     * indices, which is sorted such that the segments of every node are contiguous.
+     * The tree is built top-down, splitting the segments at the median of their
+     * midpoints along the longest extent of the node.
+     *
+     * After adapt() the tree has to be built anew.  If only the vertices have moved,
+     * refit() recomputes the boxes in linear time and keeps the topology.
+     *
+     * \tparam dimworld The world dimension
+     * \tparam ctype The type used for the coordinates
+     */
+    template <int dimworld, class ctype = double>
+    class FoamGridBoundingBoxTree
+    {
+    public:
+
+        typedef FieldVector<ctype, dimworld> GlobalCoordinate;
+
+        /** \brief Maximal number of segments in a leaf node */
+        enum {leafSize = 4};
+
+        /** \brief Construct an empty tree */
+        FoamGridBoundingBoxTree()
+            : store_(nullptr)
+        {}
+
+        /** \brief Construct the tree over all segments of a store */
+        explicit FoamGridBoundingBoxTree(const FoamGridCoordinateStore<dimworld,ctype>& store)
+            : store_(nullptr)
+        {
+            build(store);
+        }
+
+        /** \brief Number of segments in the tree */
+        std::size_t size() const {
+            return segments_.size();
+        }
+
+        /** \brief Build the tree anew over all segments of a store */
+        void build(const FoamGridCoordinateStore<dimworld,ctype>& store)
+        {
+            store_ = &store;
+
+            const std::size_t n = store.numElements();
+            segments_.resize(n);
+            for (std::size_t i=0; i<n; i++)
+                segments_[i] = i;
+
+            std::vector<double> midpoints(n*dimworld);
+            for (std::size_t i=0; i<n; i++)
+                for (int j=0; j<dimworld; j++)
+                    midpoints[i*dimworld+j] = 0.5*(store.coordinates(j)[store.elementVertices(0)[i]]
+                                                   + store.coordinates(j)[store.elementVertices(1)[i]]);
+
+            nodes_.clear();
+            if (n == 0)
+                return;
+            nodes_.reserve(2*(n/leafSize)+1);
+            nodes_.push_back(Node());
+            nodes_[0].begin = 0;
+            nodes_[0].end = n;
+
+            // The nodes are split in the order they were created, the children are appended
+            for (std::size_t current=0; current<nodes_.size(); current++) {
+                computeBox(nodes_[current]);
+
+                const unsigned int begin = nodes_[current].begin;
+                const unsigned int end = nodes_[current].end;
+                if (end-begin <= leafSize)
+                    continue;
+
+                int axis = 0;
+                for (int j=1; j<dimworld; j++)
+                    if (extent(nodes_[current], j) > extent(nodes_[current], axis))
+                        axis = j;
+
+                const unsigned int middle = begin + (end-begin)/2;
+                std::nth_element(segments_.begin()+begin, segments_.begin()+middle, segments_.begin()+end,
+                                 MidpointLess(midpoints, axis));
+
+                nodes_[current].child = nodes_.size();
+                nodes_.push_back(Node());
+                nodes_.back().begin = begin;
+                nodes_.back().end = middle;
+                nodes_.push_back(Node());
+                nodes_.back().begin = middle;
+                nodes_.back().end = end;
+            }
+        }
+
+        /** \brief Recompute the boxes after the vertices have moved
+         *
+         * \pre The store has the same segments as when the tree was built
+         */
+        void refit(const FoamGridCoordinateStore<dimworld,ctype>& store)
+        {
+            if (store.numElements() != segments_.size())
+                DUNE_THROW(InvalidStateException, "Cannot refit a bounding box tree to a different number of segments");
+
+            store_ = &store;
+
+            // Children come after their parents, so going backwards visits them first
+            for (std::size_t i=nodes_.size(); i-- > 0;) {
+                Node& node = nodes_[i];
+                if (node.child == 0)
+                    computeBox(node);
+                else
+                    for (int j=0; j<dimworld; j++) {
+                        node.lower[j] = std::min(nodes_[node.child].lower[j], nodes_[node.child+1].lower[j]);
+                        node.upper[j] = std::max(nodes_[node.child].upper[j], nodes_[node.child+1].upper[j]);
+                    }
+            }
+        }
+
+        /** \brief The segment nearest to a point
+         *
+         * \param point The point
+         * \param distance If not a null pointer, receives the distance of the point to the segment
+         * \return The index of the segment, or size() if the tree is empty
+         */
+        std::size_t nearest(const GlobalCoordinate& point, double* distance = nullptr) const
+        {
+            std::size_t result = segments_.size();
+            double best = std::numeric_limits<double>::max();
+
+            Stack stack;
+            if (!nodes_.empty())
+                stack.push(0);
+
+            while (!stack.empty()) {
+                const Node& node = nodes_[stack.pop()];
+                if (boxDistance2(node, point) >= best)
+                    continue;
+
+                if (node.child == 0) {
+                    for (unsigned int i=node.begin; i<node.end; i++) {
+                        const double d = segmentDistance2(segments_[i], point);
+                        if (d < best) {
+                            best = d;
+                            result = segments_[i];
+                        }
+                    }
+                } else {
+                    // Visit the nearer child first, i.e. push it last
+                    const double d0 = boxDistance2(nodes_[node.child], point);
+                    const double d1 = boxDistance2(nodes_[node.child+1], point);
+                    stack.push(d0 < d1 ? node.child+1 : node.child);
+                    stack.push(d0 < d1 ? node.child : node.child+1);
+                }
+            }
+
+            if (distance)
+                *distance = std::sqrt(best);
+            return result;
+        }
+
+        /** \brief The segments that are closer to a point than a radius
+         *
+         * \param point The point
+         * \param radius The radius
+         * \param result Cleared and filled with the indices of the segments, in no particular order
+         */
+        void within(const GlobalCoordinate& point, double radius, std::vector<std::size_t>& result) const
+        {
+            result.clear();
+            const double radius2 = radius*radius;
+
+            Stack stack;
+            if (!nodes_.empty())
+                stack.push(0);
+
+            while (!stack.empty()) {
+                const Node& node = nodes_[stack.pop()];
+                if (boxDistance2(node, point) > radius2)
+                    continue;
+
+                if (node.child == 0) {
+                    for (unsigned int i=node.begin; i<node.end; i++)
+                        if (segmentDistance2(segments_[i], point) <= radius2)
+                            result.push_back(segments_[i]);
+                } else {
+                    stack.push(node.child);
+                    stack.push(node.child+1);
+                }
+            }
+        }
+
+        /** \brief The segments whose bounding box intersects a box
+         *
+         * \param lower The lower corner of the box
+         * \param upper The upper corner of the box
+         * \param result Cleared and filled with the indices of the segments, in no particular order
+         */
+        void intersecting(const GlobalCoordinate& lower, const GlobalCoordinate& upper,
+                          std::vector<std::size_t>& result) const
+        {
+            result.clear();
+
+            Stack stack;
+            if (!nodes_.empty())
+                stack.push(0);
+
+            while (!stack.empty()) {
+                const Node& node = nodes_[stack.pop()];
+                if (!overlaps(node.lower, node.upper, lower, upper))
+                    continue;
+
+                if (node.child == 0) {
+                    for (unsigned int i=node.begin; i<node.end; i++) {
+                        GlobalCoordinate segmentLower, segmentUpper;
+                        segmentBox(segments_[i], segmentLower, segmentUpper);
+                        if (overlaps(segmentLower, segmentUpper, lower, upper))
+                            result.push_back(segments_[i]);
+                    }
+                } else {
+                    stack.push(node.child);
+                    stack.push(node.child+1);
+                }
+            }
+        }
+
+    private:
+
+        struct Node
+        {
+            Node() : begin(0), end(0), child(0) {}
+
+            GlobalCoordinate lower;
+            GlobalCoordinate upper;
+
+            /** \brief The range of segments_ covered by this node */
+            unsigned int begin, end;
+
+            /** \brief Index of the first child, the second one follows it.  Zero for leaf nodes */
+            unsigned int child;
+        };
+
+        /** \brief Stack of node indices for the traversal
+         *
+         * The median split keeps the tree balanced, and the traversal keeps at most
+         * one pending node per level, so the stack never holds more than 33 nodes.
+         */
+        class Stack
+        {
+        public:
+            Stack() : size_(0) {}
+
+            bool empty() const {
+                return size_ == 0;
+            }
+
+            void push(unsigned int node) {
+                assert(size_ < 64);
+                nodes_[size_++] = node;
+            }
+
+            unsigned int pop() {
+                return nodes_[--size_];
+            }
+
+        private:
+            unsigned int nodes_[64];
+            unsigned int size_;
+        };
+
+        /** \brief Compare segments by their midpoint along one axis */
+        struct MidpointLess
+        {
+            MidpointLess(const std::vector<double>& midpoints, int axis)
+                : midpoints_(midpoints), axis_(axis)
+            {}
+
+            bool operator()(unsigned int a, unsigned int b) const {
+                return midpoints_[a*dimworld+axis_] < midpoints_[b*dimworld+axis_];
+            }
+
+            const std::vector<double>& midpoints_;
+            int axis_;
+        };
+
+        static double extent(const Node& node, int axis) {
+            return node.upper[axis] - node.lower[axis];
+        }
+
+        static bool overlaps(const GlobalCoordinate& lowerA, const GlobalCoordinate& upperA,
+                             const GlobalCoordinate& lowerB, const GlobalCoordinate& upperB)
+        {
+            for (int j=0; j<dimworld; j++)
+                if (upperA[j] < lowerB[j] || upperB[j] < lowerA[j])
+                    return false;
+            return true;
+        }
+
+        void segmentBox(std::size_t segment, GlobalCoordinate& lower, GlobalCoordinate& upper) const
+        {
+            for (int j=0; j<dimworld; j++) {
+                const double a = store_->coordinates(j)[store_->elementVertices(0)[segment]];
+                const double b = store_->coordinates(j)[store_->elementVertices(1)[segment]];
+                lower[j] = std::min(a, b);
+                upper[j] = std::max(a, b);
+            }
+        }
+
+        /** \brief Set the box of a node to the union of the boxes of its segments */
+        void computeBox(Node& node) const
+        {
+            node.lower = std::numeric_limits<ctype>::max();
+            node.upper = -std::numeric_limits<ctype>::max();
+
+            GlobalCoordinate lower, upper;
+            for (unsigned int i=node.begin; i<node.end; i++) {
+                segmentBox(segments_[i], lower, upper);
+                for (int j=0; j<dimworld; j++) {
+                    node.lower[j] = std::min(node.lower[j], lower[j]);
+                    node.upper[j] = std::max(node.upper[j], upper[j]);
+                }
+            }
+        }
+
+        /** \brief Squared distance of a point to the box of a node */
+        static double boxDistance2(const Node& node, const GlobalCoordinate& point)
+        {
+            double d2 = 0;
+            for (int j=0; j<dimworld; j++) {
+                const double d = std::max<double>(0.0, std::max(node.lower[j] - point[j], point[j] - node.upper[j]));
+                d2 += d*d;
+            }
+            return d2;
+        }
+
+        /** \brief Squared distance of a point to a segment */
+        double segmentDistance2(std::size_t segment, const GlobalCoordinate& point) const
+        {
+            GlobalCoordinate a, d, p;
+            for (int j=0; j<dimworld; j++) {
+                a[j] = store_->coordinates(j)[store_->elementVertices(0)[segment]];
+                d[j] = store_->coordinates(j)[store_->elementVertices(1)[segment]] - a[j];
+                p[j] = point[j] - a[j];
+            }
+
+            const double length2 = d.two_norm2();
+            const double t = (length2 > 0) ? std::min(1.0, std::max(0.0, (p*d)/length2)) : 0.0;
+            p.axpy(-t, d);
+            return p.two_norm2();
+        }
+
+        /** \brief The store the tree was built from */
+        const FoamGridCoordinateStore<dimworld,ctype>* store_;
+
+        /** \brief The nodes, the root first */
+        std::vector<Node> nodes_;
+
+        /** \brief The segment indices, ordered such that each node covers a contiguous range */
+        std::vector<unsigned int> segments_;
+    };
+
+}  // namespace Dune
+
+#endif
@@ -0,0 +1,344 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#ifndef DUNE_FOAMGRID_BRANCHGRAPH_HH
+#define DUNE_FOAMGRID_BRANCHGRAPH_HH
+
+/** \file
+* \brief The FoamGridBranchGraph class
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/grid/common/exceptions.hh>
+
+namespace Dune {
+
+    /** \brief The leaf grid of a FoamGrid seen as a graph of branches between junctions
+     *
+     * A junction is a leaf vertex with a number of leaf elements other than two, i.e.
+     * a branching point or an end point of the network.  A branch is the chain of leaf
+     * elements between two junctions.  A closed loop without any junction becomes a
+     * branch from one of its vertices back to the same vertex, which is then counted
+     * as a junction as well.
+     *
+     * The branches and the junction graph are stored in flat arrays.  For each leaf
+     * element the branch, the position in the branch and the orientation are stored,
+     * so looking them up takes constant time.
+     *
+     * adapt() neither creates nor removes junctions, it only bisects the elements of
+     * the branches or merges them again.  Therefore update(const FoamGridLeafIndexMap&)
+     * carries the structure over to the adapted grid in one pass over the branches,
+     * without walking the grid.  After FoamGrid::grow() it computes the branches anew.
+     *
+     * \tparam GridView A leaf grid view of a FoamGrid
+     */
+    template <class GridView>
+    class FoamGridBranchGraph
+    {
+        typedef typename GridView::Grid Grid;
+
+        enum {dim = Grid::dimension};
+        enum {dimworld = Grid::dimensionworld};
+        typedef typename Grid::ctype ctype;
+
+        typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+        typedef FoamGridEntityImp<1,dimworld,ctype> Element;
+
+    public:
+
+        /** \brief Marks the absence of a junction in vertexJunction() */
+        static const unsigned int none = ~0u;
+
+        /** \brief Compute the branches of the leaf grid of a view */
+        explicit FoamGridBranchGraph(const GridView& gridView)
+            : grid_(&gridView.grid()), leafGeneration_(0)
+        {
+            update();
+        }
+
+        /** \brief Compute the branches anew from the leaf grid */
+        void update()
+        {
+            const std::vector<const Element*>& elements = leafElements();
+            const std::size_t numVertices = grid_->leafIndexSet().size(dim);
+            const std::size_t numElements = elements.size();
+            leafGeneration_ = grid_->leafIndexMap().generation();
+
+            // The leaf elements of each leaf vertex
+            std::vector<unsigned int> offsets(numVertices+1, 0), adjacent(2*numElements);
+            for (std::size_t e=0; e<numElements; e++)
+                for (int i=0; i<2; i++)
+                    ++offsets[vertexIndex(e, i)+1];
+            for (std::size_t v=0; v<numVertices; v++)
+                offsets[v+1] += offsets[v];
+
+            std::vector<unsigned int> position(offsets.begin(), offsets.end()-1);
+            for (std::size_t e=0; e<numElements; e++)
+                for (int i=0; i<2; i++)
+                    adjacent[position[vertexIndex(e, i)]++] = e;
+
+            junctionVertices_.clear();
+            vertexJunction_.assign(numVertices, none);
+            for (std::size_t v=0; v<numVertices; v++)
+                if (offsets[v+1]-offsets[v] != 2)
+                    addJunction(v);
+
+            branchOffsets_.assign(1, 0);
+            branchElements_.clear();
+            branchJunctions_.clear();
+            elementBranch_.assign(numElements, none);
+            elementPosition_.resize(numElements);
+            elementForward_.resize(numElements);
+
+            // Walk from every junction along each of its elements that is not yet taken
+            for (std::size_t j=0; j<junctionVertices_.size(); j++) {
+                const unsigned int v = junctionVertices_[j];
+                for (unsigned int a=offsets[v]; a<offsets[v+1]; a++)
+                    if (elementBranch_[adjacent[a]] == none)
+                        walk(v, adjacent[a], offsets, adjacent);
+            }
+
+            // The elements left over form closed loops without a junction
+            for (std::size_t e=0; e<numElements; e++)
+                if (elementBranch_[e] == none) {
+                    addJunction(vertexIndex(e, 0));
+                    walk(vertexIndex(e, 0), e, offsets, adjacent);
+                }
+
+            buildJunctionGraph();
+        }
+
+        /** \brief Carry the branches over to the leaf grid after adapt()
+         *
+         * \param indexMap The leaf index map of the grid, describing the last call to adapt()
+         * \throw InvalidStateException if the map does not start from the leaf grid of this graph
+         */
+        void update(const FoamGridLeafIndexMap<dim>& indexMap)
+        {
+            typedef FoamGridLeafIndexMap<dim> IndexMap;
+
+            if (!indexMap.valid() || indexMap.oldGeneration() != leafGeneration_)
+                DUNE_THROW(InvalidStateException, "The leaf index map does not describe the adaptation of this branch graph");
+
+            if (indexMap.topologyChanged()) {
+                update();
+                return;
+            }
+
+            // Invert the map: the new elements covering each old element, son 0 first
+            const std::size_t numOld = elementBranch_.size();
+            std::vector<unsigned int> children(2*numOld, none);
+            for (std::size_t e=0; e<indexMap.size(0); e++) {
+                const typename IndexMap::Entry& entry = indexMap.element(e);
+                if (entry.origin == IndexMap::refined)
+                    children[2*entry.oldIndex[0] + entry.childNumber] = e;
+                else
+                    children[2*entry.oldIndex[0]] = children[2*entry.oldIndex[1]] = e;
+            }
+
+            // Rewrite the branches in place of the old ones, keeping the old arrays for reading
+            std::vector<unsigned int> oldOffsets, oldElements;
+            std::vector<bool> oldForward;
+            oldOffsets.swap(branchOffsets_);
+            oldElements.swap(branchElements_);
+            oldForward.swap(elementForward_);
+
+            const std::size_t numNew = indexMap.size(0);
+            branchOffsets_.assign(1, 0);
+            branchElements_.reserve(numNew);
+            elementBranch_.assign(numNew, none);
+            elementPosition_.resize(numNew);
+            elementForward_.resize(numNew);
+
+            for (std::size_t b=0; b+1<oldOffsets.size(); b++) {
+                for (unsigned int k=oldOffsets[b]; k<oldOffsets[b+1]; k++) {
+                    const unsigned int old = oldElements[k];
+                    const bool forward = oldForward[old];
+
+                    // Sons keep the orientation of their father, son 0 holds its vertex 0
+                    for (int i=0; i<2; i++) {
+                        const unsigned int e = children[2*old + (forward ? i : 1-i)];
+                        if (e == none || elementBranch_[e] != none)
+                            continue;
+                        elementBranch_[e] = b;
+                        elementPosition_[e] = branchElements_.size() - branchOffsets_.back();
+                        elementForward_[e] = forward;
+                        branchElements_.push_back(e);
+                    }
+                }
+                branchOffsets_.push_back(branchElements_.size());
+            }
+            assert(branchElements_.size() == numNew);
+
+            // The junctions are kept vertices
+            std::vector<unsigned int> oldVertexJunction;
+            oldVertexJunction.swap(vertexJunction_);
+            vertexJunction_.assign(indexMap.size(dim), none);
+            for (std::size_t v=0; v<indexMap.size(dim); v++) {
+                const typename IndexMap::Entry& entry = indexMap.vertex(v);
+                if (entry.origin == IndexMap::kept && oldVertexJunction[entry.oldIndex[0]] != none) {
+                    vertexJunction_[v] = oldVertexJunction[entry.oldIndex[0]];
+                    junctionVertices_[vertexJunction_[v]] = v;
+                }
+            }
+
+            leafGeneration_ = indexMap.generation();
+        }
+
+        /** \brief The number of branches */
+        std::size_t size() const {
+            return branchOffsets_.size()-1;
+        }
+
+        /** \brief The number of elements of a branch */
+        std::size_t branchSize(std::size_t branch) const {
+            return branchOffsets_[branch+1] - branchOffsets_[branch];
+        }
+
+        /** \brief The leaf indices of the elements of a branch, from its front to its back */
+        const unsigned int* branchElements(std::size_t branch) const {
+            return &branchElements_[0] + branchOffsets_[branch];
+        }
+
+        /** \brief The junction at the front (i=0) or at the back (i=1) of a branch */
+        unsigned int branchJunction(std::size_t branch, int i) const {
+            return branchJunctions_[2*branch+i];
+        }
+
+        /** \brief The branch of the leaf element with the given leaf index */
+        unsigned int branch(std::size_t element) const {
+            return elementBranch_[element];
+        }
+
+        /** \brief The position of a leaf element in its branch, counted from the front */
+        unsigned int position(std::size_t element) const {
+            return elementPosition_[element];
+        }
+
+        /** \brief Whether vertex 0 of a leaf element is the one closer to the front of its branch */
+        bool forward(std::size_t element) const {
+            return elementForward_[element];
+        }
+
+        /** \brief The number of junctions */
+        std::size_t numJunctions() const {
+            return junctionVertices_.size();
+        }
+
+        /** \brief The leaf index of the vertex of a junction */
+        unsigned int junctionVertex(std::size_t junction) const {
+            return junctionVertices_[junction];
+        }
+
+        /** \brief The junction at the leaf vertex with the given leaf index, or none */
+        unsigned int vertexJunction(std::size_t vertex) const {
+            return vertexJunction_[vertex];
+        }
+
+        /** \brief The number of branch ends at a junction, a loop is counted twice */
+        std::size_t junctionSize(std::size_t junction) const {
+            return junctionOffsets_[junction+1] - junctionOffsets_[junction];
+        }
+
+        /** \brief The branches ending at a junction */
+        const unsigned int* junctionBranches(std::size_t junction) const {
+            return &junctionBranches_[0] + junctionOffsets_[junction];
+        }
+
+    private:
+
+        const std::vector<const Element*>& leafElements() const {
+            return Dune::get<1>(grid_->leafIndexSet().leafEntities_);
+        }
+
+        /** \brief The leaf index of vertex i of the leaf element e */
+        unsigned int vertexIndex(std::size_t e, int i) const {
+            return leafElements()[e]->vertex_[i]->leafIndex_;
+        }
+
+        void addJunction(unsigned int vertex)
+        {
+            vertexJunction_[vertex] = junctionVertices_.size();
+            junctionVertices_.push_back(vertex);
+        }
+
+        /** \brief Follow a chain of elements from a junction to the next one, and store it as a branch */
+        void walk(unsigned int vertex, unsigned int element,
+                  const std::vector<unsigned int>& offsets, const std::vector<unsigned int>& adjacent)
+        {
+            const unsigned int branch = size();
+            branchJunctions_.push_back(vertexJunction_[vertex]);
+
+            while (true) {
+                const bool forward = (vertexIndex(element, 0) == vertex);
+                elementBranch_[element] = branch;
+                elementPosition_[element] = branchElements_.size() - branchOffsets_.back();
+                elementForward_[element] = forward;
+                branchElements_.push_back(element);
+
+                vertex = vertexIndex(element, forward ? 1 : 0);
+                if (vertexJunction_[vertex] != none)
+                    break;
+
+                // An inner vertex has exactly two elements
+                const unsigned int a = offsets[vertex];
+                element = (adjacent[a] == element) ? adjacent[a+1] : adjacent[a];
+            }
+
+            branchJunctions_.push_back(vertexJunction_[vertex]);
+            branchOffsets_.push_back(branchElements_.size());
+        }
+
+        /** \brief Set up the branches at each junction from the junctions of the branches */
+        void buildJunctionGraph()
+        {
+            junctionOffsets_.assign(junctionVertices_.size()+1, 0);
+            for (std::size_t k=0; k<branchJunctions_.size(); k++)
+                ++junctionOffsets_[branchJunctions_[k]+1];
+            for (std::size_t j=0; j<junctionVertices_.size(); j++)
+                junctionOffsets_[j+1] += junctionOffsets_[j];
+
+            junctionBranches_.resize(branchJunctions_.size());
+            std::vector<unsigned int> position(junctionOffsets_.begin(), junctionOffsets_.end()-1);
+            for (std::size_t k=0; k<branchJunctions_.size(); k++)
+                junctionBranches_[position[branchJunctions_[k]]++] = k/2;
+        }
+
+        /** \brief The grid.  A copy of the view would keep the sizes of its own, outdated index set */
+        const Grid* grid_;
+
+        /** \brief The generation of the leaf grid the branches were computed for, see FoamGridLeafIndexMap */
+        unsigned long leafGeneration_;
+
+        /** \brief Where the elements of each branch begin in branchElements_, and the end */
+        std::vector<unsigned int> branchOffsets_;
+
+        /** \brief The leaf indices of the elements of all branches, branch after branch */
+        std::vector<unsigned int> branchElements_;
+
+        /** \brief The front and the back junction of each branch */
+        std::vector<unsigned int> branchJunctions_;
+
+        /** \brief Branch, position in the branch and orientation of each leaf element */
+        std::vector<unsigned int> elementBranch_;
+        std::vector<unsigned int> elementPosition_;
+        std::vector<bool> elementForward_;
+
+        /** \brief The leaf vertex of each junction, and the junction of each leaf vertex */
+        std::vector<unsigned int> junctionVertices_;
+        std::vector<unsigned int> vertexJunction_;
+
+        /** \brief Where the branches of each junction begin in junctionBranches_, and the end */
+        std::vector<unsigned int> junctionOffsets_;
+        std::vector<unsigned int> junctionBranches_;
+    };
+
+    template <class GridView>
+    const unsigned int FoamGridBranchGraph<GridView>::none;
+
+}  // namespace Dune
+
+#endif
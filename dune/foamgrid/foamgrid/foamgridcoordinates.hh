@@ -0,0 +1,214 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#ifndef DUNE_FOAMGRID_COORDINATES_HH
+#define DUNE_FOAMGRID_COORDINATES_HH
+
+/** \file
+* \brief Structure-of-arrays vertex coordinates and batch segment geometry kernels
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/array.hh>
+
+namespace Dune {
+
+    template <int dim, int dimworld, class ctype>
+    class FoamGridEntityImp;
+
+    /** \brief Vertex coordinates and element connectivity of a level or of the leaf grid
+     *
+     * The coordinates are kept in structure-of-arrays layout, one array per
+     * direction, indexed by the level or leaf index of the vertex.  For each
+     * element the indices of its two vertices are stored in the same way.
+     * This is the data the batch kernels below operate on.
+     *
+     * \tparam dimworld The world dimension
+     * \tparam ctype The type used for the coordinates
+     */
+    template <int dimworld, class ctype = double>
+    class FoamGridCoordinateStore
+    {
+        typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+
+    public:
+
+        /** \brief One output array per direction, for the batch kernels */
+        typedef array<ctype*, dimworld> OutputArrays;
+
+        FoamGridCoordinateStore()
+            : generation_(0)
+        {}
+
+        /** \brief Number of vertices */
+        std::size_t numVertices() const {
+            return coordinates_[0].size();
+        }
+
+        /** \brief Number of elements */
+        std::size_t numElements() const {
+            return elementVertices_[0].size();
+        }
+
+        /** \brief The coordinates of all vertices in direction i */
+        const ctype* coordinates(int i) const {
+            return coordinates_[i].empty() ? nullptr : &coordinates_[i][0];
+        }
+
+        /** \brief For every element the index of its i-th vertex */
+        const unsigned int* elementVertices(int i) const {
+            return elementVertices_[i].empty() ? nullptr : &elementVertices_[i][0];
+        }
+
+        /** \brief Bytes allocated for the coordinates and the connectivity */
+        std::size_t memoryUsage() const
+        {
+            std::size_t result = 0;
+            for (int i=0; i<dimworld; i++)
+                result += coordinates_[i].capacity()*sizeof(ctype);
+            for (int i=0; i<2; i++)
+                result += elementVertices_[i].capacity()*sizeof(unsigned int);
+            return result;
+        }
+
+        /** \brief Refill the store
+         *
+         * \param vertices Random access range of vertex implementation pointers, ordered by index
+         * \param elements Random access range of element implementation pointers, ordered by index
+         * \param index The index of the vertices to use, i.e. &Vertex::levelIndex_ or &Vertex::leafIndex_
+         */
+        template <class VertexRange, class ElementRange>
+        void update(const VertexRange& vertices, const ElementRange& elements, unsigned int Vertex::* index)
+        {
+            for (int i=0; i<dimworld; i++)
+                coordinates_[i].resize(vertices.size());
+            for (std::size_t k=0; k<vertices.size(); k++)
+                for (int i=0; i<dimworld; i++)
+                    coordinates_[i][k] = vertices[k]->pos_[i];
+
+            for (int i=0; i<2; i++)
+                elementVertices_[i].resize(elements.size());
+            for (std::size_t k=0; k<elements.size(); k++)
+                for (int i=0; i<2; i++)
+                    elementVertices_[i][k] = elements[k]->vertex_[i]->*index;
+        }
+
+        /** \brief Counter value of the grid for which the store was filled last */
+        unsigned long generation_;
+
+    private:
+        array<std::vector<ctype>, dimworld> coordinates_;
+        array<std::vector<unsigned int>, 2> elementVertices_;
+    };
+
+    /** \brief Compute length, midpoint and unit tangent of all segments of a coordinate store
+     *
+     * The segments are processed in blocks: the end points of a block are first
+     * gathered into small contiguous buffers, and the geometry is then computed by
+     * loops without branches or indirection that the compiler vectorizes.  Note that
+     * most compilers only vectorize the square root with -fno-math-errno.
+     *
+     * Each output may be a null pointer, in which case that quantity is skipped.
+     *
+     * \param store The coordinates and the connectivity of the segments
+     * \param length Array of size store.numElements() receiving the segment lengths
+     * \param midpoint dimworld arrays of size store.numElements() receiving the midpoints
+     * \param tangent dimworld arrays of size store.numElements() receiving the unit tangents
+     *        pointing from vertex 0 to vertex 1
+     */
+    template <int dimworld, class ctype>
+    void computeSegmentGeometry(const FoamGridCoordinateStore<dimworld,ctype>& store,
+                                ctype* length,
+                                const typename FoamGridCoordinateStore<dimworld,ctype>::OutputArrays& midpoint,
+                                const typename FoamGridCoordinateStore<dimworld,ctype>::OutputArrays& tangent)
+    {
+        enum {blockSize = 64};
+
+        const std::size_t n = store.numElements();
+        const unsigned int* v0 = store.elementVertices(0);
+        const unsigned int* v1 = store.elementVertices(1);
+
+        ctype a[dimworld][blockSize];
+        ctype d[dimworld][blockSize];
+        ctype l[blockSize];
+
+        for (std::size_t begin=0; begin<n; begin+=blockSize)
+        {
+            const std::size_t size = std::min<std::size_t>(blockSize, n-begin);
+
+            // gather the end points of the block
+            for (int i=0; i<dimworld; i++)
+            {
+                const ctype* x = store.coordinates(i);
+                for (std::size_t k=0; k<size; k++)
+                {
+                    a[i][k] = x[v0[begin+k]];
+                    d[i][k] = x[v1[begin+k]] - a[i][k];
+                }
+            }
+
+            for (std::size_t k=0; k<size; k++)
+                l[k] = 0;
+            for (int i=0; i<dimworld; i++)
+                for (std::size_t k=0; k<size; k++)
+                    l[k] += d[i][k]*d[i][k];
+            for (std::size_t k=0; k<size; k++)
+                l[k] = std::sqrt(l[k]);
+
+            if (length)
+                for (std::size_t k=0; k<size; k++)
+                    length[begin+k] = l[k];
+
+            for (int i=0; i<dimworld; i++)
+            {
+                if (midpoint[i])
+                {
+                    ctype* out = midpoint[i] + begin;
+                    for (std::size_t k=0; k<size; k++)
+                        out[k] = a[i][k] + ctype(0.5)*d[i][k];
+                }
+                if (tangent[i])
+                {
+                    ctype* out = tangent[i] + begin;
+                    for (std::size_t k=0; k<size; k++)
+                        out[k] = d[i][k] / l[k];
+                }
+            }
+        }
+    }
+
+    /** \brief Compute the lengths of all segments of a coordinate store */
+    template <int dimworld, class ctype>
+    void computeSegmentLengths(const FoamGridCoordinateStore<dimworld,ctype>& store, ctype* length)
+    {
+        typename FoamGridCoordinateStore<dimworld,ctype>::OutputArrays none;
+        none.fill(nullptr);
+        computeSegmentGeometry(store, length, none, none);
+    }
+
+    /** \brief Compute the midpoints of all segments of a coordinate store */
+    template <int dimworld, class ctype>
+    void computeSegmentMidpoints(const FoamGridCoordinateStore<dimworld,ctype>& store,
+                                 const typename FoamGridCoordinateStore<dimworld,ctype>::OutputArrays& midpoint)
+    {
+        typename FoamGridCoordinateStore<dimworld,ctype>::OutputArrays none;
+        none.fill(nullptr);
+        computeSegmentGeometry<dimworld,ctype>(store, nullptr, midpoint, none);
+    }
+
+    /** \brief Compute the unit tangents of all segments of a coordinate store */
+    template <int dimworld, class ctype>
+    void computeSegmentTangents(const FoamGridCoordinateStore<dimworld,ctype>& store,
+                                const typename FoamGridCoordinateStore<dimworld,ctype>::OutputArrays& tangent)
+    {
+        typename FoamGridCoordinateStore<dimworld,ctype>::OutputArrays none;
+        none.fill(nullptr);
+        computeSegmentGeometry<dimworld,ctype>(store, nullptr, none, tangent);
+    }
+
+}  // namespace Dune
+
+#endif
@@ -0,0 +1,458 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#ifndef DUNE_FOAMGRID_COUPLINGMAP_HH
+#define DUNE_FOAMGRID_COUPLINGMAP_HH
+
+/** \file
+* \brief The intersections of the segments of a FoamGrid with the cells of a host grid
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <dune/common/array.hh>
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/geometry/type.hh>
+
+#include "foamgridcoordinates.hh"
+#include "foamgridleafindexmap.hh"
+
+namespace Dune {
+
+    /** \brief Which cells of a host grid each leaf segment of a FoamGrid crosses
+     *
+     * For every leaf segment the map holds the host cells it intersects, together
+     * with the part of the segment inside the cell, as a parameter range of the
+     * segment geometry.  Quadrature points for the coupling terms are obtained by
+     * mapping a one-dimensional rule to that range.  The table is stored in
+     * compressed sparse row format: the entries of a segment are contiguous and
+     * ordered by the position along the segment.
+     *
+     * The host cells are indexed spatially: they are sorted into a uniform grid of
+     * buckets by their bounding boxes, and each segment is only tested against the
+     * cells in the buckets its own bounding box touches.  The part of a
+     * segment inside a cell is found by clipping it against the reference element
+     * in local coordinates, which is exact for cells with affine geometries, i.e.
+     * simplices and parallelepipeds.  Cubes and simplices of any dimension are supported.
+     *
+     * A segment lying exactly on the boundary between cells is reported for every
+     * cell that contains it.
+     *
+     * \tparam FoamGridView A leaf grid view of a FoamGrid
+     * \tparam HostGridView A grid view of any grid with dimension == dimworld of the FoamGrid
+     */
+    template <class FoamGridView, class HostGridView>
+    class FoamGridCouplingMap
+    {
+        typedef typename FoamGridView::Grid FoamGridType;
+        typedef typename HostGridView::Grid HostGridType;
+
+        enum {dimworld = FoamGridType::dimensionworld};
+
+        typedef FoamGridCoordinateStore<dimworld, typename FoamGridType::ctype> CoordinateStore;
+
+        typedef FieldVector<double, dimworld> GlobalCoordinate;
+        typedef typename HostGridView::template Codim<0>::Entity HostElement;
+        typedef typename HostGridView::template Codim<0>::Iterator HostIterator;
+        typedef typename HostGridType::template Codim<0>::EntitySeed HostSeed;
+
+    public:
+
+        /** \brief The part of one segment that lies in one host cell */
+        struct Entry
+        {
+            /** \brief The index of the host cell in the index set of the host grid view */
+            unsigned int cell;
+
+            /** \brief Begin and end of the part, in local coordinates of the segment */
+            double begin, end;
+
+            /** \brief The length of the part */
+            double length;
+        };
+
+        typedef typename std::vector<Entry>::const_iterator const_iterator;
+
+        /** \brief Compute the intersections of all leaf segments with all host cells */
+        FoamGridCouplingMap(const FoamGridView& foamGridView, const HostGridView& hostGridView)
+            : foamGrid_(&foamGridView.grid()), hostGridView_(hostGridView), leafGeneration_(0)
+        {
+            updateHost();
+        }
+
+        /** \brief Number of segments */
+        std::size_t size() const {
+            return offsets_.size()-1;
+        }
+
+        /** \brief The first entry of the segment with the given leaf index */
+        const_iterator begin(std::size_t segment) const {
+            return entries_.begin() + offsets_[segment];
+        }
+
+        /** \brief One past the last entry of the segment with the given leaf index */
+        const_iterator end(std::size_t segment) const {
+            return entries_.begin() + offsets_[segment+1];
+        }
+
+        /** \brief The offsets of the entries of each segment, of size size()+1 */
+        const std::vector<unsigned int>& offsets() const {
+            return offsets_;
+        }
+
+        /** \brief The entries of all segments */
+        const std::vector<Entry>& entries() const {
+            return entries_;
+        }
+
+        /** \brief Recompute the table after the FoamGrid has been adapted
+         *
+         * The rows of the segments that were kept are copied, only the segments
+         * created by adapt() are intersected anew.  This needs the leaf index map
+         * of the last adapt(), starting from the leaf grid the table was computed
+         * for; otherwise the whole table is recomputed.
+         */
+        void updateFoamGrid()
+        {
+            const FoamGridType& grid = *foamGrid_;
+            const FoamGridLeafIndexMap<1>& indexMap = grid.leafIndexMap();
+            if (!indexMap.valid() || indexMap.oldGeneration() != leafGeneration_) {
+                computeAll();
+                return;
+            }
+
+            const CoordinateStore& store = grid.leafCoordinates();
+            const std::size_t n = store.numElements();
+
+            std::vector<unsigned int> offsets(1, 0);
+            offsets.reserve(n+1);
+            std::vector<Entry> entries;
+            entries.reserve(entries_.size());
+
+            for (std::size_t i=0; i<n; i++) {
+                const typename FoamGridLeafIndexMap<1>::Entry& origin = indexMap.element(i);
+                if (origin.origin == FoamGridLeafIndexMap<1>::kept)
+                    entries.insert(entries.end(), begin(origin.oldIndex[0]), end(origin.oldIndex[0]));
+                else
+                    intersect(store, i, entries);
+                offsets.push_back(entries.size());
+            }
+
+            offsets_.swap(offsets);
+            entries_.swap(entries);
+            leafGeneration_ = indexMap.generation();
+        }
+
+        /** \brief Recompute the table after the host grid has changed
+         *
+         * Arbitrary grids do not tell which cells changed, hence the spatial
+         * index of the host cells and all intersections are computed anew.
+         */
+        void updateHost()
+        {
+            buildHostIndex();
+            computeAll();
+        }
+
+    private:
+
+        /** \brief Intersect all segments anew */
+        void computeAll()
+        {
+            const CoordinateStore& store = foamGrid_->leafCoordinates();
+            const std::size_t n = store.numElements();
+            leafGeneration_ = foamGrid_->leafIndexMap().generation();
+
+            offsets_.assign(1, 0);
+            offsets_.reserve(n+1);
+            entries_.clear();
+            for (std::size_t i=0; i<n; i++) {
+                intersect(store, i, entries_);
+                offsets_.push_back(entries_.size());
+            }
+        }
+
+        /** \brief Sort the host cells into buckets by their bounding boxes */
+        void buildHostIndex()
+        {
+            const std::size_t numCells = hostGridView_.size(0);
+            seeds_.clear();
+            seeds_.reserve(numCells);
+            cellIndices_.resize(numCells);
+            std::vector<GlobalCoordinate> lower(numCells), upper(numCells);
+
+            lower_ = std::numeric_limits<double>::max();
+            upper_ = -std::numeric_limits<double>::max();
+
+            // The cells are numbered in the order of traversal here, and their index
+            // in the host grid view is only looked up for the entries
+            for (HostIterator it = hostGridView_.template begin<0>(); it != hostGridView_.template end<0>(); ++it) {
+                const std::size_t index = seeds_.size();
+                seeds_.push_back(it->seed());
+                cellIndices_[index] = hostGridView_.indexSet().index(*it);
+                lower[index] = upper[index] = it->geometry().corner(0);
+                for (int c=1; c<it->geometry().corners(); c++) {
+                    const GlobalCoordinate corner = it->geometry().corner(c);
+                    for (int j=0; j<dimworld; j++) {
+                        lower[index][j] = std::min(lower[index][j], corner[j]);
+                        upper[index][j] = std::max(upper[index][j], corner[j]);
+                    }
+                }
+                for (int j=0; j<dimworld; j++) {
+                    lower_[j] = std::min(lower_[j], lower[index][j]);
+                    upper_[j] = std::max(upper_[j], upper[index][j]);
+                }
+            }
+
+            // About one cell per bucket
+            const int perAxis = std::max(1, static_cast<int>(std::pow(double(numCells), 1.0/dimworld)));
+            for (int j=0; j<dimworld; j++) {
+                buckets_[j] = perAxis;
+                bucketSize_[j] = std::max((upper_[j] - lower_[j]) / perAxis, std::numeric_limits<double>::min());
+            }
+
+            std::size_t numBuckets = 1;
+            for (int j=0; j<dimworld; j++)
+                numBuckets *= buckets_[j];
+
+            // Counting sort of the cells into the buckets, in compressed sparse row format
+            bucketOffsets_.assign(numBuckets+1, 0);
+            for (int pass=0; pass<2; pass++) {
+                std::vector<unsigned int> position(bucketOffsets_.begin(), bucketOffsets_.end()-1);
+                if (pass == 1)
+                    bucketCells_.resize(bucketOffsets_.back());
+
+                for (std::size_t cell=0; cell<numCells; cell++) {
+                    array<int,dimworld> first, last;
+                    bucketRange(lower[cell], upper[cell], first, last);
+                    BucketInserter inserter = {&bucketOffsets_, pass == 1 ? &position : nullptr,
+                                               &bucketCells_, static_cast<unsigned int>(cell)};
+                    forEachBucket(first, last, inserter);
+                }
+
+                if (pass == 0)
+                    for (std::size_t b=0; b<numBuckets; b++)
+                        bucketOffsets_[b+1] += bucketOffsets_[b];
+            }
+
+            visited_.assign(numCells, 0);
+            stamp_ = 0;
+        }
+
+        /** \brief The buckets overlapped by a box */
+        void bucketRange(const GlobalCoordinate& lower, const GlobalCoordinate& upper,
+                         array<int,dimworld>& first, array<int,dimworld>& last) const
+        {
+            for (int j=0; j<dimworld; j++) {
+                first[j] = std::max(0, std::min(buckets_[j]-1, static_cast<int>(std::floor((lower[j] - lower_[j]) / bucketSize_[j]))));
+                last[j] = std::max(0, std::min(buckets_[j]-1, static_cast<int>(std::floor((upper[j] - lower_[j]) / bucketSize_[j]))));
+            }
+        }
+
+        /** \brief Call f with every bucket of a box of buckets */
+        template <class F>
+        void forEachBucket(const array<int,dimworld>& first, const array<int,dimworld>& last, F f) const
+        {
+            array<int,dimworld> i = first;
+            while (true) {
+                std::size_t bucket = 0;
+                for (int j=dimworld-1; j>=0; j--)
+                    bucket = bucket*buckets_[j] + i[j];
+                f(bucket);
+
+                int j = 0;
+                while (j<dimworld && i[j] == last[j]) {
+                    i[j] = first[j];
+                    ++j;
+                }
+                if (j == dimworld)
+                    return;
+                ++i[j];
+            }
+        }
+
+        /** \brief Append the intersections of one segment with the host cells */
+        void intersect(const CoordinateStore& store, std::size_t segment, std::vector<Entry>& entries)
+        {
+            GlobalCoordinate a, b, lower, upper;
+            for (int j=0; j<dimworld; j++) {
+                a[j] = store.coordinates(j)[store.elementVertices(0)[segment]];
+                b[j] = store.coordinates(j)[store.elementVertices(1)[segment]];
+                lower[j] = std::min(a[j], b[j]);
+                upper[j] = std::max(a[j], b[j]);
+            }
+
+            for (int j=0; j<dimworld; j++)
+                if (upper[j] < lower_[j] || lower[j] > upper_[j])
+                    return;
+
+            const double length = (b - a).two_norm();
+            const std::size_t first = entries.size();
+
+            // A cell may be in several buckets, the stamp makes sure it is tested once
+            if (++stamp_ == 0) {
+                std::fill(visited_.begin(), visited_.end(), 0);
+                stamp_ = 1;
+            }
+
+            array<int,dimworld> firstBucket, lastBucket;
+            bucketRange(lower, upper, firstBucket, lastBucket);
+            BucketClipper clipper = {this, &a, &b, length, &entries};
+            forEachBucket(firstBucket, lastBucket, clipper);
+
+            std::sort(entries.begin()+first, entries.end(), BeginLess());
+        }
+
+        /** \brief Clip the segment from a to b against a host cell
+         *
+         * \return Whether a part of positive length lies in the cell
+         */
+        bool clip(unsigned int cell, const GlobalCoordinate& a, const GlobalCoordinate& b,
+                  double& begin, double& end) const
+        {
+            typedef typename HostGridType::template Codim<0>::EntityPointer HostPointer;
+            const HostPointer element = hostGridView_.grid().entityPointer(seeds_[cell]);
+            const typename HostElement::Geometry geometry = element->geometry();
+            const GeometryType type = element->type();
+
+            const FieldVector<double, dimworld> localA = geometry.local(a);
+            const FieldVector<double, dimworld> direction = geometry.local(b) - localA;
+
+            // Each face of the reference element is a constraint normal*x <= bound
+            begin = 0;
+            end = 1;
+            const double eps = 1e-12;
+
+            if (type.isCube()) {
+                for (int j=0; j<dimworld; j++) {
+                    FieldVector<double, dimworld> normal(0);
+                    normal[j] = 1;
+                    if (!clipPlane(normal, 1, localA, direction, begin, end))
+                        return false;
+                    normal[j] = -1;
+                    if (!clipPlane(normal, 0, localA, direction, begin, end))
+                        return false;
+                }
+            } else if (type.isSimplex()) {
+                FieldVector<double, dimworld> normal(1);
+                if (!clipPlane(normal, 1, localA, direction, begin, end))
+                    return false;
+                for (int j=0; j<dimworld; j++) {
+                    normal = 0;
+                    normal[j] = -1;
+                    if (!clipPlane(normal, 0, localA, direction, begin, end))
+                        return false;
+                }
+            } else
+                DUNE_THROW(NotImplemented, "Coupling with host cells of type " << type);
+
+            return end - begin > eps;
+        }
+
+        /** \brief Restrict the parameter range to the part where normal*(a+t*d) <= bound */
+        static bool clipPlane(const FieldVector<double, dimworld>& normal, double bound,
+                              const FieldVector<double, dimworld>& a, const FieldVector<double, dimworld>& d,
+                              double& begin, double& end)
+        {
+            const double value = normal*a - bound;
+            const double slope = normal*d;
+
+            if (std::abs(slope) < 1e-14)
+                return value <= 1e-12;
+
+            const double t = -value / slope;
+            if (slope > 0)
+                end = std::min(end, t);
+            else
+                begin = std::max(begin, t);
+            return begin < end;
+        }
+
+        struct BeginLess
+        {
+            bool operator()(const Entry& a, const Entry& b) const {
+                return a.begin < b.begin;
+            }
+        };
+
+        /** \brief Count a host cell in a bucket, or insert it once the bucket offsets are known */
+        struct BucketInserter
+        {
+            void operator()(std::size_t bucket) const {
+                if (position)
+                    (*cells)[(*position)[bucket]++] = cell;
+                else
+                    ++(*offsets)[bucket+1];
+            }
+
+            std::vector<unsigned int>* offsets;
+            std::vector<unsigned int>* position;
+            std::vector<unsigned int>* cells;
+            unsigned int cell;
+        };
+
+        /** \brief Clip a segment against the host cells of a bucket it has not been tested against */
+        struct BucketClipper
+        {
+            void operator()(std::size_t bucket) const {
+                for (unsigned int k=map->bucketOffsets_[bucket]; k<map->bucketOffsets_[bucket+1]; k++) {
+                    const unsigned int cell = map->bucketCells_[k];
+                    if (map->visited_[cell] == map->stamp_)
+                        continue;
+                    map->visited_[cell] = map->stamp_;
+
+                    Entry entry;
+                    if (map->clip(cell, *a, *b, entry.begin, entry.end)) {
+                        entry.cell = map->cellIndices_[cell];
+                        entry.length = (entry.end - entry.begin) * length;
+                        entries->push_back(entry);
+                    }
+                }
+            }
+
+            FoamGridCouplingMap* map;
+            const GlobalCoordinate* a;
+            const GlobalCoordinate* b;
+            double length;
+            std::vector<Entry>* entries;
+        };
+
+        const FoamGridType* foamGrid_;
+        HostGridView hostGridView_;
+
+        /** \brief The table, in compressed sparse row format */
+        std::vector<unsigned int> offsets_;
+        std::vector<Entry> entries_;
+
+        /** \brief The generation of the leaf grid the table was computed for */
+        unsigned long leafGeneration_;
+
+        /** \brief Seeds of the host cells, in the order of traversal */
+        std::vector<HostSeed> seeds_;
+
+        /** \brief Index of the host cells in the index set of the host grid view */
+        std::vector<unsigned int> cellIndices_;
+
+        /** \brief The bounding box of the host grid */
+        GlobalCoordinate lower_, upper_;
+
+        /** \brief Number and size of the buckets per direction */
+        array<int,dimworld> buckets_;
+        GlobalCoordinate bucketSize_;
+
+        /** \brief The host cells of each bucket, in compressed sparse row format */
+        std::vector<unsigned int> bucketOffsets_;
+        std::vector<unsigned int> bucketCells_;
+
+        /** \brief The stamp of the last segment that tested each host cell */
+        std::vector<unsigned int> visited_;
+        unsigned int stamp_;
+    };
+
+}  // namespace Dune
+
+#endif
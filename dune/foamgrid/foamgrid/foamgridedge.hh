@@ -12,8 +12,8 @@
 
 namespace Dune {
 
-    template <int dimworld>
-    class FoamGridEntityImp<1,dimworld>
+    template <int dimworld, class ctype>
+    class FoamGridEntityImp<1,dimworld,ctype>
         : public FoamGridEntityBase
     {
     public:
@@ -22,10 +22,12 @@ namespace Dune {
 
         enum MarkState { DO_NOTHING , COARSEN , REFINE, IS_COARSENED };
 
-        FoamGridEntityImp(const FoamGridEntityImp<0,dimworld>* v0,
-                          const FoamGridEntityImp<0,dimworld>* v1,
+        FoamGridEntityImp(const FoamGridEntityImp<0,dimworld,ctype>* v0,
+                          const FoamGridEntityImp<0,dimworld,ctype>* v1,
                           int level, unsigned int id)
-            : FoamGridEntityBase(level,id), nSons_(0), father_(nullptr)
+            : FoamGridEntityBase(level,id),
+              refinementIndex_(0), isNew_(false), markState_(DO_NOTHING),
+              nSons_(0), father_(nullptr)
         {
             vertex_[0] = v0;
             vertex_[1] = v1;
@@ -33,23 +35,39 @@ namespace Dune {
         }
 
 
-        FoamGridEntityImp(const FoamGridEntityImp<0,dimworld>* v0,
-                          const FoamGridEntityImp<0,dimworld>* v1,
+        FoamGridEntityImp(const FoamGridEntityImp<0,dimworld,ctype>* v0,
+                          const FoamGridEntityImp<0,dimworld,ctype>* v1,
                           int level, unsigned int id,
                           FoamGridEntityImp* father)
 
-            : FoamGridEntityBase(level,id), nSons_(0), father_(father)
+            : FoamGridEntityBase(level,id),
+              refinementIndex_(0), isNew_(false), markState_(DO_NOTHING),
+              nSons_(0), father_(father)
         {
             vertex_[0] = v0;
             vertex_[1] = v1;
             sons_[0] =sons_[1] = nullptr;
         }
 
-        /** \todo Implement this method! */
         bool isLeaf() const {
             return sons_[0]==nullptr;
         }
 
+        /** \brief The number of sons (0 or 2) */
+        unsigned int nSons() const {
+            return nSons_;
+        }
+
+        /** \brief Whether the element was created by the last adaptation step */
+        bool isNew() const {
+            return isNew_;
+        }
+
+        /** \brief Whether the element is marked for coarsening */
+        bool mightVanish() const {
+            return markState_==COARSEN;
+        }
+
 
         GeometryType type() const {
             return GeometryType(1);
@@ -60,7 +78,7 @@ namespace Dune {
             return 2;
         }
 
-        FieldVector<double, dimworld> corner(int i) const {
+        FieldVector<ctype, dimworld> corner(int i) const {
             return vertex_[i]->pos_;
         }
 
@@ -94,23 +112,28 @@ namespace Dune {
             DUNE_THROW(GridError, "Non-existing codimension requested!");
         }
 
+        /** \brief The number of this element among the sons of its father
+         *
+         * Son k shares vertex k with its father, i.e. its vertex k is the copy
+         * of vertex k of the father, and its vertex 1-k is the midpoint.
+         */
         int refinementIndex_;
 
-	bool isNew_;
+        bool isNew_;
 
-	MarkState markState_;
+        MarkState markState_;
 
 
-        const FoamGridEntityImp<0,dimworld>* vertex_[2];
+        const FoamGridEntityImp<0,dimworld,ctype>* vertex_[2];
 
         /** \brief links to refinements of this edge */
-        array<FoamGridEntityImp<1,dimworld>*,2> sons_;
+        array<FoamGridEntityImp<1,dimworld,ctype>*,2> sons_;
 
-        /** \brief The number of refined edges (0 or 2). */
+        /** \brief The number of sons (0 or 2). */
         unsigned int nSons_;
 
         /** \brief Pointer to father element */
-        FoamGridEntityImp<1,dimworld>* father_;
+        FoamGridEntityImp<1,dimworld,ctype>* father_;
 
     };
 
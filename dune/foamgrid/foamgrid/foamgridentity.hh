@@ -81,7 +81,7 @@ class FoamGridEntity :
 
 
         //! Constructor for an entity in a given grid level
-    FoamGridEntity(const FoamGridEntityImp<dim-codim,GridImp::dimensionworld>* target) :
+    FoamGridEntity(const FoamGridEntityImp<dim-codim,dimworld,ctype>* target) :
             target_(target)
         {}
 
@@ -125,11 +125,7 @@ class FoamGridEntity :
         //! geometry of this entity
         Geometry geometry () const
         {
-            std::vector<FieldVector<double,dimworld> > coordinates(target_->corners());
-            for (size_t i=0; i<target_->corners(); i++)
-                coordinates[i] = target_->corner(i);
-
-            return Geometry(FoamGridGeometry<dim-codim,dimworld,GridImp>(target_->type(), coordinates));
+            return Geometry(FoamGridGeometry<dim-codim,dimworld,GridImp>(target_->pos_));
         }
 
         //! Create EntitySeed
@@ -138,11 +134,11 @@ class FoamGridEntity :
             return EntitySeed(target_);
         }
 
-    const FoamGridEntityImp<dim-codim,GridImp::dimensionworld>* target_;
+    const FoamGridEntityImp<dim-codim,dimworld,ctype>* target_;
 
 
         //! \todo Please doc me !
-        void setToTarget(const FoamGridEntityImp<dim-codim,GridImp::dimensionworld>* target)
+        void setToTarget(const FoamGridEntityImp<dim-codim,dimworld,ctype>* target)
         {
             target_ = target;
         }
@@ -165,6 +161,8 @@ class FoamGridEntity<0,dim,GridImp> :
 
     enum {dimworld = GridImp::dimensionworld};
 
+    typedef typename GridImp::ctype ctype;
+
     public:
 
         typedef typename GridImp::template Codim<0>::Geometry Geometry;
@@ -185,7 +183,7 @@ class FoamGridEntity<0,dim,GridImp> :
 
 
         //! Constructor for an entity in a given grid level
-        FoamGridEntity(const FoamGridEntityImp<1,dimworld>* hostEntity) :
+        FoamGridEntity(const FoamGridEntityImp<1,dimworld,ctype>* hostEntity) :
             target_(hostEntity)
         {}
 
@@ -223,11 +221,8 @@ class FoamGridEntity<0,dim,GridImp> :
         //! Geometry of this entity
         Geometry geometry () const
         {
-            std::vector<FieldVector<double, dimworld> > coordinates(target_->corners());
-            for (size_t i=0; i<target_->corners(); i++)
-                coordinates[i] = target_->vertex_[i]->pos_;
-
-            return Geometry(FoamGridGeometry<dim,dimworld,GridImp>(target_->type(), coordinates));
+            return Geometry(FoamGridGeometry<dim,dimworld,GridImp>(target_->vertex_[0]->pos_,
+                                                                   target_->vertex_[1]->pos_));
         }
 
         //! Create EntitySeed
@@ -280,10 +275,10 @@ class FoamGridEntity<0,dim,GridImp> :
         typename GridImp::template Codim<codim>::EntityPointer subEntity (int i) const{
             if (codim==0) {
                 // The cast is correct when this if clause is executed
-                return FoamGridEntityPointer<codim,GridImp>( (FoamGridEntityImp<dim-codim,dimworld>*)this->target_);
+                return FoamGridEntityPointer<codim,GridImp>( (FoamGridEntityImp<dim-codim,dimworld,ctype>*)this->target_);
             } else if (codim==1) {
                 // The cast is correct when this if clause is executed
-                return FoamGridEntityPointer<codim,GridImp>( (FoamGridEntityImp<dim-codim,dimworld>*)this->target_->vertex_[i]);
+                return FoamGridEntityPointer<codim,GridImp>( (FoamGridEntityImp<dim-codim,dimworld,ctype>*)this->target_->vertex_[i]);
             }
         }
 
@@ -322,7 +317,7 @@ class FoamGridEntity<0,dim,GridImp> :
 
     /** \brief Return true if this element has a father element */
     bool hasFather() const {
-        return level()>0;
+        return target_->father_ != nullptr;
     }
 
     bool isNew() const
@@ -351,45 +346,15 @@ class FoamGridEntity<0,dim,GridImp> :
         * Assumes that meshes are nested.
         */
         LocalGeometry geometryInFather () const {
-            FoamGridEntityImp<1,dimworld>* father = target_->father_;
-            // Check whether there really is a father
-            if(father==nullptr)
+            if(target_->father_==nullptr)
                 DUNE_THROW(GridError, "There is no father Element.");
 
-            // Sanity check
-            if(target_->type().isTriangle()){
-                // Lookup the coordinates within the father
-                // As in the refinement routine the children
-                // are number as follows:
-                // First come the ones located in the corner
-                // ascending with the corner index.
-                // Their first corner (origin in the reference simplex)
-                // is always the corner that is also a corner of the father.
-                // For the element with all corners on the edge midpoints of
-                // the father, the corner are numbered according to the edge indices
-                // of the father.
-                double mapping[4][3][2] ={
-                    { {0.0,0.0}, {0.5,0.0}, {0.0,0.5} },
-                    { {1.0,0.0}, {0.5,0.5}, {0.5,0.0} },
-                    { {0.0,1.0}, {0.0,0.5}, {0.5,0.5} },
-                    { {0.5,0.0}, {0.5,0.5}, {0.0,0.5} }
-                };
-
-                std::vector<FieldVector<typename GridImp::ctype,GridImp::dimension> >
-                    coordinates(3);
-
-                for(int corner=0; corner <3; ++corner)
-                    for(int entry=0; entry <2; ++entry)
-                        coordinates[corner][entry]=
-                            mapping[target_->refinementIndex_][corner][entry];
-
-                // return LocalGeomety by value
-                return LocalGeometry(FoamGridGeometry<2,2,GridImp>(target_->type(),
-                                                                        coordinates));
-            }else{
-                DUNE_THROW(NotImplemented, "geometryInFather only supported for triangles!");
-            }
+            // Son k covers the half of the father that contains vertex k
+            FieldVector<ctype, dim> corner0(0.5*target_->refinementIndex_);
+            FieldVector<ctype, dim> corner1(0.5*target_->refinementIndex_+0.5);
 
+            // return LocalGeomety by value
+            return LocalGeometry(FoamGridGeometry<dim,dim,GridImp>(corner0, corner1));
         }
 
 
@@ -426,16 +391,12 @@ class FoamGridEntity<0,dim,GridImp> :
 
 
         /** \brief Make this class point to a new FoamGridEntityImp object */
-        void setToTarget(const FoamGridEntityImp<1,dimworld>* target)
+        void setToTarget(const FoamGridEntityImp<1,dimworld,ctype>* target)
         {
             target_ = target;
         }
 
-        const FoamGridEntityImp<1,dimworld>* target_;
-
-    private:
-
-        typedef typename GridImp::ctype ctype;
+        const FoamGridEntityImp<1,dimworld,ctype>* target_;
 
 }; // end of FoamGridEntity codim = 0
 
@@ -5,9 +5,8 @@
 * \brief The FoamGridEntityPointer class
 */
 
-#include <list>
-
 #include "foamgridentity.hh"
+#include "foamgridentitystorage.hh"
 
 namespace Dune {
 
@@ -22,6 +21,8 @@ class FoamGridEntityPointer
     enum { dim      = GridImp::dimension };
     enum { dimworld = GridImp::dimensionworld };
 
+    typedef typename GridImp::ctype ctype;
+
     public:
 
     //! export the type of the EntityPointer Implementation.
@@ -38,11 +39,11 @@ class FoamGridEntityPointer
         : virtualEntity_(entity.target_)
     {}
 
-    FoamGridEntityPointer (const typename std::list<FoamGridEntityImp<dim-codim,dimworld> >::const_iterator& it)
-        : virtualEntity_(&(*it))
+    FoamGridEntityPointer (const typename FoamGridEntityStorage<FoamGridEntityImp<dim-codim,dimworld,ctype> >::const_iterator& it)
+        : virtualEntity_(it.address())
     {}
 
-    FoamGridEntityPointer (const FoamGridEntityImp<dim-codim,dimworld>* target)
+    FoamGridEntityPointer (const FoamGridEntityImp<dim-codim,dimworld,ctype>* target)
         : virtualEntity_(target)
     {}
 
@@ -21,17 +21,18 @@ namespace Dune {
 template<int codim, class GridImp>
 class FoamGridEntitySeed
 {
-        template<int dimworld>
+        template<int dimworld_, class ct_>
         friend class FoamGrid;
 
     protected:
 
         enum {dim = GridImp::dimension};
         enum {dimworld = GridImp::dimensionworld};
+        typedef typename GridImp::ctype ctype;
         enum {mydim = dim-codim};
 
         // Entity type of the hostgrid
-        typedef FoamGridEntityImp<mydim, dimworld> EntityImplType;
+        typedef FoamGridEntityImp<mydim,dimworld,ctype> EntityImplType;
 
     public:
 
@@ -78,7 +79,7 @@ class FoamGridEntitySeed
 
     private:
 
-        const FoamGridEntityImp<mydim, dimworld>* entityImplPointer_;
+        const FoamGridEntityImp<mydim,dimworld,ctype>* entityImplPointer_;
 };
 
 } // namespace Dune
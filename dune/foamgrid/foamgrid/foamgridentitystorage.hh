@@ -0,0 +1,288 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#ifndef DUNE_FOAMGRID_ENTITYSTORAGE_HH
+#define DUNE_FOAMGRID_ENTITYSTORAGE_HH
+
+/** \file
+* \brief The FoamGridEntityStorage class
+*/
+
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Dune {
+
+    /** \brief Chunked arena holding the entities of one dimension on one grid level
+     *
+     * Entities are appended to fixed-size blocks.  A block is never relocated,
+     * hence a pointer to a stored entity remains valid until that entity is erased
+     * or the storage is destroyed.  Within a block the entities are contiguous,
+     * so a traversal walks linearly through memory instead of chasing one heap node
+     * per entity as std::list does.
+     *
+     * Erasing an entity destroys it and marks its slot as dead.  Dead slots are
+     * skipped by the iterators, but they are not reused: the order of the live
+     * entities is always the order of insertion.
+     *
+     * \tparam T The entity implementation class
+     */
+    template <class T>
+    class FoamGridEntityStorage
+    {
+    public:
+
+        /** \brief Base-2 logarithm of the number of entities per block */
+        enum {blockShift = 9};
+
+        /** \brief Number of entities per block */
+        enum {blockSize = 1 << blockShift};
+
+        typedef T value_type;
+        typedef std::size_t size_type;
+
+        /** \brief Forward iterator over the live entities */
+        template <class Storage, class Value>
+        class Iterator
+            : public std::iterator<std::forward_iterator_tag, Value>
+        {
+            friend class FoamGridEntityStorage;
+
+        public:
+
+            Iterator()
+                : storage_(nullptr), slot_(0)
+            {}
+
+            Iterator(Storage* storage, size_type slot)
+                : storage_(storage), slot_(slot)
+            {}
+
+            /** \brief Conversion from iterator to const_iterator */
+            template <class OtherStorage, class OtherValue>
+            Iterator(const Iterator<OtherStorage,OtherValue>& other)
+                : storage_(other.storage_), slot_(other.slot_)
+            {}
+
+            Value& operator*() const {
+                return storage_->slot(slot_);
+            }
+
+            Value* operator->() const {
+                return &storage_->slot(slot_);
+            }
+
+            /** \brief Address of the entity, nullptr for an end iterator */
+            Value* address() const {
+                return (storage_ && slot_ < storage_->slots_) ? &storage_->slot(slot_) : nullptr;
+            }
+
+            Iterator& operator++() {
+                slot_ = storage_->nextAlive(slot_+1);
+                return *this;
+            }
+
+            Iterator operator++(int) {
+                Iterator tmp(*this);
+                ++(*this);
+                return tmp;
+            }
+
+            template <class OtherStorage, class OtherValue>
+            bool operator==(const Iterator<OtherStorage,OtherValue>& other) const {
+                return slot_ == other.slot_ && storage_ == other.storage_;
+            }
+
+            template <class OtherStorage, class OtherValue>
+            bool operator!=(const Iterator<OtherStorage,OtherValue>& other) const {
+                return !(*this == other);
+            }
+
+            // public for the conversion constructor
+            Storage* storage_;
+            size_type slot_;
+        };
+
+        typedef Iterator<FoamGridEntityStorage, T> iterator;
+        typedef Iterator<const FoamGridEntityStorage, const T> const_iterator;
+
+        /** \brief Construct an empty storage */
+        FoamGridEntityStorage()
+            : slots_(0), size_(0)
+        {}
+
+        /** \brief Move constructor, hands over the blocks without touching the entities */
+        FoamGridEntityStorage(FoamGridEntityStorage&& other) noexcept
+            : blocks_(std::move(other.blocks_)),
+              alive_(std::move(other.alive_)),
+              slots_(other.slots_),
+              size_(other.size_)
+        {
+            other.slots_ = other.size_ = 0;
+        }
+
+        /** \brief Move assignment, hands over the blocks without touching the entities */
+        FoamGridEntityStorage& operator=(FoamGridEntityStorage&& other) noexcept
+        {
+            if (this != &other) {
+                clear();
+                blocks_ = std::move(other.blocks_);
+                alive_ = std::move(other.alive_);
+                slots_ = other.slots_;
+                size_ = other.size_;
+                other.slots_ = other.size_ = 0;
+            }
+            return *this;
+        }
+
+        ~FoamGridEntityStorage()
+        {
+            clear();
+        }
+
+        /** \brief Number of live entities */
+        size_type size() const {
+            return size_;
+        }
+
+        bool empty() const {
+            return size_ == 0;
+        }
+
+        /** \brief Number of slots in use, including the dead ones */
+        size_type slots() const {
+            return slots_;
+        }
+
+        /** \brief Number of entities that fit into the allocated blocks */
+        size_type capacity() const {
+            return blocks_.size() * blockSize;
+        }
+
+        /** \brief Bytes allocated by the storage, including dead and unused slots */
+        std::size_t memoryUsage() const {
+            return blocks_.size()*blockSize*sizeof(T) + blocks_.capacity()*sizeof(T*)
+                + alive_.capacity()/CHAR_BIT;
+        }
+
+        /** \brief Allocate blocks for at least n entities */
+        void reserve(size_type n)
+        {
+            while (capacity() < n)
+                allocateBlock();
+            alive_.reserve(n);
+        }
+
+        /** \brief Append a copy of an entity, existing entities are not moved */
+        void push_back(const T& entity)
+        {
+            if (slots_ == capacity())
+                allocateBlock();
+            new (&slot(slots_)) T(entity);
+            alive_.push_back(true);
+            ++slots_;
+            ++size_;
+        }
+
+        /** \brief The entity inserted last */
+        T& back() {
+            assert(slots_ > 0 && alive_[slots_-1]);
+            return slot(slots_-1);
+        }
+
+        const T& back() const {
+            assert(slots_ > 0 && alive_[slots_-1]);
+            return slot(slots_-1);
+        }
+
+        /** \brief Destroy an entity and return an iterator to its successor
+         *
+         * Pointers to all other entities stay valid.
+         */
+        iterator erase(iterator it)
+        {
+            assert(it.storage_ == this && alive_[it.slot_]);
+            slot(it.slot_).~T();
+            alive_[it.slot_] = false;
+            --size_;
+            return iterator(this, nextAlive(it.slot_+1));
+        }
+
+        /** \brief Destroy all entities and release the memory */
+        void clear()
+        {
+            for (size_type i=0; i<slots_; i++)
+                if (alive_[i])
+                    slot(i).~T();
+
+            for (size_type i=0; i<blocks_.size(); i++)
+                ::operator delete(blocks_[i]);
+
+            blocks_.clear();
+            alive_.clear();
+            slots_ = size_ = 0;
+        }
+
+        iterator begin() {
+            return iterator(this, nextAlive(0));
+        }
+
+        iterator end() {
+            return iterator(this, slots_);
+        }
+
+        const_iterator begin() const {
+            return const_iterator(this, nextAlive(0));
+        }
+
+        const_iterator end() const {
+            return const_iterator(this, slots_);
+        }
+
+    private:
+
+        // The entities are not copyable without invalidating the pointers between them
+        FoamGridEntityStorage(const FoamGridEntityStorage&);
+        FoamGridEntityStorage& operator=(const FoamGridEntityStorage&);
+
+        T& slot(size_type i) {
+            return blocks_[i >> blockShift][i & (blockSize-1)];
+        }
+
+        const T& slot(size_type i) const {
+            return blocks_[i >> blockShift][i & (blockSize-1)];
+        }
+
+        /** \brief The first live slot at or after i, or slots_ if there is none */
+        size_type nextAlive(size_type i) const
+        {
+            while (i < slots_ && !alive_[i])
+                ++i;
+            return i;
+        }
+
+        void allocateBlock()
+        {
+            blocks_.push_back(static_cast<T*>(::operator new(blockSize*sizeof(T))));
+        }
+
+        /** \brief The blocks, each holding blockSize entities */
+        std::vector<T*> blocks_;
+
+        /** \brief Whether the entity in a slot has not been erased yet */
+        std::vector<bool> alive_;
+
+        /** \brief Number of slots in use */
+        size_type slots_;
+
+        /** \brief Number of live entities */
+        size_type size_;
+    };
+
+}  // namespace Dune
+
+#endif
@@ -8,9 +8,15 @@
     \author Oliver Sander
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
+#include <dune/common/array.hh>
 #include <dune/common/fvector.hh>
 
 #include <dune/grid/common/gridfactory.hh>
@@ -22,25 +28,26 @@ namespace Dune {
     /** \brief Specialization of the generic GridFactory for FoamGrid
 
     */
-    template <int dimworld>
-    class GridFactory<FoamGrid<dimworld> >
-        : public GridFactoryInterface<FoamGrid<dimworld> > {
+    template <int dimworld, class ct>
+    class GridFactory<FoamGrid<dimworld, ct> >
+        : public GridFactoryInterface<FoamGrid<dimworld, ct> > {
 
         /** \brief Type used by the grid for coordinates */
-        typedef typename FoamGrid<dimworld>::ctype ctype;
+        typedef typename FoamGrid<dimworld, ct>::ctype ctype;
 
         typedef typename std::map<FieldVector<ctype,1>, unsigned int>::iterator VertexIterator;
 
-        enum {dim = FoamGrid<dimworld>::dimension};
+        enum {dim = FoamGrid<dimworld, ct>::dimension};
 
     public:
 
         /** \brief Default constructor */
         GridFactory()
             : factoryOwnsGrid_(true),
-              vertexIndex_(0)
+              vertexIndex_(0),
+              mergeTolerance_(0)
         {
-            grid_ = new FoamGrid<dimworld>;
+            grid_ = new FoamGrid<dimworld, ct>;
 
             grid_->entityImps_.resize(1);
         }
@@ -54,9 +61,10 @@ namespace Dune {
         the pointer handed over to you by the method createGrid() is
         the one you supplied here.
          */
-        GridFactory(FoamGrid<dimworld>* grid)
+        GridFactory(FoamGrid<dimworld, ct>* grid)
             : factoryOwnsGrid_(false),
-              vertexIndex_(0)
+              vertexIndex_(0),
+              mergeTolerance_(0)
         {
             grid_ = grid;
 
@@ -71,10 +79,10 @@ namespace Dune {
 
         /** \brief Insert a vertex into the coarse grid */
         virtual void insertVertex(const FieldVector<ctype,dimworld>& pos) {
-            Dune::get<0>(grid_->entityImps_[0]).push_back(FoamGridEntityImp<0,dimworld> (0,   // level
+            Dune::get<0>(grid_->entityImps_[0]).push_back(FoamGridEntityImp<0,dimworld,ctype> (0,   // level
                                                                          pos,  // position
                                                                          grid_->freeIdCounter_[0]++));
-            vertexArray_.push_back(&*Dune::get<0>(grid_->entityImps_[0]).rbegin());
+            vertexArray_.push_back(&Dune::get<0>(grid_->entityImps_[0]).back());
         }
 
         /** \brief Insert an element into the coarse grid
@@ -84,11 +92,82 @@ namespace Dune {
         virtual void insertElement(const GeometryType& type,
                                    const std::vector<unsigned int>& vertices) {
 	    assert(type.isLine());
- 	    FoamGridEntityImp<1,dimworld> newElement(vertexArray_[vertices[0]],vertexArray_[vertices[1]],0,grid_->freeIdCounter_[1]++);
+ 	    FoamGridEntityImp<1,dimworld,ctype> newElement(vertexArray_[vertices[0]],vertexArray_[vertices[1]],0,grid_->freeIdCounter_[1]++);
 	    Dune::get<1>(grid_->entityImps_[0]).push_back(newElement);
 
         }
 
+        /** \brief Allocate storage for the given number of coarse grid vertices and elements
+         *
+         * Only a hint: more entities may be inserted, and storage that is not used is kept.
+         */
+        void reserve(std::size_t numVertices, std::size_t numElements)
+        {
+            Dune::get<0>(grid_->entityImps_[0]).reserve(Dune::get<0>(grid_->entityImps_[0]).size() + numVertices);
+            Dune::get<1>(grid_->entityImps_[0]).reserve(Dune::get<1>(grid_->entityImps_[0]).size() + numElements);
+            vertexArray_.reserve(vertexArray_.size() + numVertices);
+        }
+
+        /** \brief Insert many vertices into the coarse grid at once
+         *
+         * The vertices are numbered consecutively, following the ones inserted before.
+         *
+         * \param coordinates The coordinates of the vertices, dimworld consecutive entries per vertex
+         * \param numVertices The number of vertices
+         */
+        void insertVertices(const ctype* coordinates, std::size_t numVertices)
+        {
+            FoamGridEntityStorage<FoamGridEntityImp<0,dimworld,ctype> >& vertices = Dune::get<0>(grid_->entityImps_[0]);
+            reserve(numVertices, 0);
+
+            FieldVector<ctype,dimworld> pos;
+            for (std::size_t i=0; i<numVertices; i++, coordinates+=dimworld) {
+                std::copy(coordinates, coordinates+dimworld, pos.begin());
+                vertices.push_back(FoamGridEntityImp<0,dimworld,ctype>(0, pos, grid_->freeIdCounter_[0]++));
+                vertexArray_.push_back(&vertices.back());
+            }
+        }
+
+        /** \brief Insert many line elements into the coarse grid at once
+         *
+         * \param connectivity The vertex numbers of the elements, two consecutive entries per element
+         * \param numElements The number of elements
+         */
+        void insertElements(const unsigned int* connectivity, std::size_t numElements)
+        {
+            FoamGridEntityStorage<FoamGridEntityImp<1,dimworld,ctype> >& elements = Dune::get<1>(grid_->entityImps_[0]);
+            reserve(0, numElements);
+
+            for (std::size_t i=0; i<numElements; i++, connectivity+=2) {
+                assert(connectivity[0] < vertexArray_.size() && connectivity[1] < vertexArray_.size());
+                elements.push_back(FoamGridEntityImp<1,dimworld,ctype>(vertexArray_[connectivity[0]],
+                                                                vertexArray_[connectivity[1]],
+                                                                0, grid_->freeIdCounter_[1]++));
+            }
+        }
+
+        /** \brief Merge coincident vertices when the grid is created
+         *
+         * If the tolerance is positive, createGrid() collapses all vertices that are
+         * closer than the tolerance to a vertex inserted earlier into that vertex,
+         * and removes the elements that degenerate to a point.  This joins polylines
+         * that were inserted separately at their common points.  The default
+         * tolerance is zero, which keeps all vertices as they were inserted.
+         */
+        void setVertexMergeTolerance(ctype tolerance)
+        {
+            mergeTolerance_ = tolerance;
+        }
+
+        /** \brief Bytes allocated by the factory besides the grid under construction
+         *
+         * createGrid() releases them.
+         */
+        std::size_t memoryUsage() const
+        {
+            return sizeof(*this) + vertexArray_.capacity()*sizeof(FoamGridEntityImp<0,dimworld,ctype>*);
+        }
+
         /** \brief Insert a boundary segment.
 
         This is only needed if you want to control the numbering of the boundary segments
@@ -112,30 +191,16 @@ namespace Dune {
 
         The receiver takes responsibility of the memory allocated for the grid
         */
-        virtual FoamGrid<dimworld>* createGrid() {
+        virtual FoamGrid<dimworld, ct>* createGrid() {
             // Prevent a crash when this method is called twice in a row
             // You never know who may do this...
             if (grid_==nullptr)
                 return nullptr;
 
-	        typename std::list<FoamGridEntityImp<1,dimworld> >::iterator eIt    = Dune::get<1>(grid_->entityImps_[0]).begin();
-		typename std::list<FoamGridEntityImp<1,dimworld> >::iterator eEndIt = Dune::get<1>(grid_->entityImps_[0]).end();
-
-		for(;eIt!=eEndIt;eIt++) {
-
-                    // Get two vertices of the edge
-                    const FoamGridEntityImp<0,dimworld>* v0 = eIt->vertex_[0];
-                    const FoamGridEntityImp<0,dimworld>* v1 = eIt->vertex_[1];
+            if (mergeTolerance_ > 0)
+                mergeVertices();
 
-		    // make vertices know about edge
-		    // using const_cast because of the implementation of FoamGridEntityImp<1,dimworld>
-		    // the member variable vertex_ is an array with pointers to const vertices
-		    const_cast <FoamGridEntityImp<0,dimworld>*> (v0)->elements_.push_back(&*eIt);
-		    const_cast <FoamGridEntityImp<0,dimworld>*> (v1)->elements_.push_back(&*eIt);
-
-                }
-
-            // Create the index sets
+            // Create the index sets and the vertex-to-element adjacency
             grid_->setIndices();
 
 
@@ -146,19 +211,20 @@ namespace Dune {
 
             unsigned int boundaryIdCounter = 0;
 
-            for (typename std::list<FoamGridEntityImp<0,dimworld> >::iterator it = Dune::get<0>(grid_->entityImps_[0]).begin();
+            for (typename FoamGridEntityStorage<FoamGridEntityImp<0,dimworld,ctype> >::iterator it = Dune::get<0>(grid_->entityImps_[0]).begin();
                  it != Dune::get<0>(grid_->entityImps_[0]).end();
                  ++it)
-                if(it->elements_.size()==1)
+                if(it->nElements_==1)
                     it->boundaryId_ = boundaryIdCounter++;
 
             // ////////////////////////////////////////////////
             //   Hand over the new grid
             // ////////////////////////////////////////////////
 
-            Dune::FoamGrid<dimworld>* tmp = grid_;
+            Dune::FoamGrid<dimworld, ct>* tmp = grid_;
             tmp->numBoundarySegments_ = boundaryIdCounter;
             grid_ = nullptr;
+            std::vector<FoamGridEntityImp<0,dimworld,ctype>*>().swap(vertexArray_);
             return tmp;
         }
 
@@ -167,8 +233,90 @@ namespace Dune {
         // Initialize the grid structure in UG
         void createBegin();
 
+        /** \brief The cell of the uniform grid used to find coincident vertices */
+        typedef array<long, dimworld> MergeCell;
+
+        /** \brief Hash function for the cells */
+        struct MergeCellHash
+        {
+            std::size_t operator()(const MergeCell& cell) const
+            {
+                std::size_t hash = 0;
+                for (int i=0; i<dimworld; i++)
+                    hash = hash*2654435761u + std::hash<long>()(cell[i]);
+                return hash;
+            }
+        };
+
+        /** \brief Collapse the vertices closer than mergeTolerance_ to an earlier vertex
+         *
+         * The vertices are hashed into a uniform grid with cells of the size of the
+         * tolerance, hence coincident vertices are found in the cell of a vertex and
+         * its direct neighbors.  Only vertices that are kept are entered into the
+         * grid, so each vertex merges into the first vertex that was inserted near it.
+         * The expected cost is linear in the number of vertices.
+         */
+        void mergeVertices()
+        {
+            typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+            typedef FoamGridEntityImp<1,dimworld,ctype> Element;
+
+            std::unordered_map<MergeCell, std::vector<Vertex*>, MergeCellHash> cells(vertexArray_.size());
+
+            int numNeighbors = 1;
+            for (int i=0; i<dimworld; i++)
+                numNeighbors *= 3;
+
+            for (std::size_t k=0; k<vertexArray_.size(); k++) {
+                Vertex* vertex = vertexArray_[k];
+
+                MergeCell cell;
+                for (int i=0; i<dimworld; i++)
+                    cell[i] = static_cast<long>(std::floor(vertex->pos_[i] / mergeTolerance_));
+
+                Vertex* representative = nullptr;
+                for (int n=0; n<numNeighbors && !representative; n++) {
+                    MergeCell neighbor = cell;
+                    for (int i=0, m=n; i<dimworld; i++, m/=3)
+                        neighbor[i] += m%3 - 1;
+
+                    typename std::unordered_map<MergeCell, std::vector<Vertex*>, MergeCellHash>::const_iterator it
+                        = cells.find(neighbor);
+                    if (it == cells.end())
+                        continue;
+
+                    for (std::size_t j=0; j<it->second.size(); j++)
+                        if ((it->second[j]->pos_ - vertex->pos_).two_norm() <= mergeTolerance_) {
+                            representative = it->second[j];
+                            break;
+                        }
+                }
+
+                if (representative) {
+                    vertex->willVanish_ = true;
+                    vertexArray_[k] = representative;
+                } else
+                    cells[cell].push_back(vertex);
+
+                // Remember the insertion index to find the representative from the elements
+                vertex->levelIndex_ = k;
+            }
+
+            // Rewrite the connectivity, before the merged vertices are erased
+            FoamGridEntityStorage<Element>& elements = Dune::get<1>(grid_->entityImps_[0]);
+            for (typename FoamGridEntityStorage<Element>::iterator it = elements.begin(); it != elements.end(); ++it) {
+                for (int i=0; i<2; i++)
+                    it->vertex_[i] = vertexArray_[it->vertex_[i]->levelIndex_];
+                if (it->vertex_[0] == it->vertex_[1])
+                    it->willVanish_ = true;
+            }
+
+            grid_->eraseVanishedEntities(elements);
+            grid_->eraseVanishedEntities(Dune::get<0>(grid_->entityImps_[0]));
+        }
+
         // Pointer to the grid being built
-        FoamGrid<dimworld>* grid_;
+        FoamGrid<dimworld, ct>* grid_;
 
         // True if the factory allocated the grid itself, false if the
         // grid was handed over from the outside
@@ -177,10 +325,24 @@ namespace Dune {
         /** \brief Counter that creates the vertex indices */
         unsigned int vertexIndex_;
 
-        std::vector<FoamGridEntityImp<0,dimworld>*> vertexArray_;
+        std::vector<FoamGridEntityImp<0,dimworld,ctype>*> vertexArray_;
+
+        /** \brief Vertices closer than this are merged by createGrid(), see setVertexMergeTolerance() */
+        ctype mergeTolerance_;
 
     };
 
+#ifndef DUNE_FOAMGRID_HEADER_ONLY
+    // Compiled into libdunefoamgrid together with the grid, see foamgrid.hh
+    extern template class GridFactory<FoamGrid<1> >;
+    extern template class GridFactory<FoamGrid<2> >;
+    extern template class GridFactory<FoamGrid<3> >;
+
+    extern template class GridFactory<FoamGrid<1, float> >;
+    extern template class GridFactory<FoamGrid<2, float> >;
+    extern template class GridFactory<FoamGrid<3, float> >;
+#endif
+
 }
 
 #endif
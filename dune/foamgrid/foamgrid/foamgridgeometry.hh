@@ -5,9 +5,14 @@
 * \brief The FoamGridGeometry class
 */
 
+#include <cassert>
+#include <cmath>
 #include <vector>
 
+#include <dune/common/fvector.hh>
+#include <dune/common/fmatrix.hh>
 #include <dune/common/version.hh>
+#include <dune/geometry/type.hh>
 #include <dune/geometry/multilineargeometry.hh>
 
 
@@ -47,6 +52,222 @@ class FoamGridGeometry :
 };
 
 
+/** \brief Geometry of a straight segment
+ *
+ * The map from the reference segment is affine, hence everything is computed in
+ * closed form from the two end points.  The geometry stores a few FieldVectors and
+ * FieldMatrices, and constructing it never allocates.
+ */
+template<int coorddim, class GridImp>
+class FoamGridGeometry<1, coorddim, GridImp>
+{
+    public:
+
+    typedef typename GridImp::ctype ctype;
+
+    static const int mydimension = 1;
+    static const int coorddimension = coorddim;
+
+    typedef FieldVector<ctype, mydimension> LocalCoordinate;
+    typedef FieldVector<ctype, coorddimension> GlobalCoordinate;
+    typedef FieldMatrix<ctype, mydimension, coorddimension> JacobianTransposed;
+    typedef FieldMatrix<ctype, coorddimension, mydimension> JacobianInverseTransposed;
+
+    /**
+     * \brief This is DefaultConstructor
+     */
+    FoamGridGeometry()
+        : integrationElement_(0)
+    {}
+
+    /**
+     * \brief Construct geometry from the two end points
+     */
+    FoamGridGeometry(const GlobalCoordinate& p0, const GlobalCoordinate& p1)
+    {
+        setup(p0, p1);
+    }
+
+    /**
+     * \brief Construct geometry from coordinate vector
+     */
+    FoamGridGeometry(const GeometryType& type, const std::vector<GlobalCoordinate>& coordinates)
+    {
+        assert(type.isLine() && coordinates.size() == 2);
+        setup(coordinates[0], coordinates[1]);
+    }
+
+    GeometryType type () const {
+        return GeometryType(GeometryType::simplex, mydimension);
+    }
+
+    bool affine () const {
+        return true;
+    }
+
+    int corners () const {
+        return 2;
+    }
+
+    GlobalCoordinate corner (int i) const {
+        assert(i==0 || i==1);
+        GlobalCoordinate result = origin_;
+        if (i==1)
+            result += jacobianTransposed_[0];
+        return result;
+    }
+
+    GlobalCoordinate center () const {
+        GlobalCoordinate result = origin_;
+        result.axpy(0.5, jacobianTransposed_[0]);
+        return result;
+    }
+
+    GlobalCoordinate global (const LocalCoordinate& local) const {
+        GlobalCoordinate result = origin_;
+        result.axpy(local[0], jacobianTransposed_[0]);
+        return result;
+    }
+
+    /** \brief The local coordinate of the orthogonal projection of a point onto the segment line */
+    LocalCoordinate local (const GlobalCoordinate& global) const {
+        GlobalCoordinate diff = global;
+        diff -= origin_;
+        LocalCoordinate result;
+        result[0] = 0;
+        for (int i=0; i<coorddim; i++)
+            result[0] += diff[i]*jacobianInverseTransposed_[i][0];
+        return result;
+    }
+
+    ctype integrationElement (const LocalCoordinate& local) const {
+        return integrationElement_;
+    }
+
+    ctype volume () const {
+        return integrationElement_;
+    }
+
+    const JacobianTransposed& jacobianTransposed (const LocalCoordinate& local) const {
+        return jacobianTransposed_;
+    }
+
+    const JacobianInverseTransposed& jacobianInverseTransposed (const LocalCoordinate& local) const {
+        return jacobianInverseTransposed_;
+    }
+
+    private:
+
+    void setup(const GlobalCoordinate& p0, const GlobalCoordinate& p1)
+    {
+        origin_ = p0;
+        jacobianTransposed_[0] = p1;
+        jacobianTransposed_[0] -= p0;
+
+        const ctype length2 = jacobianTransposed_[0].two_norm2();
+        integrationElement_ = std::sqrt(length2);
+        for (int i=0; i<coorddim; i++)
+            jacobianInverseTransposed_[i][0] = jacobianTransposed_[0][i] / length2;
+    }
+
+    GlobalCoordinate origin_;
+    JacobianTransposed jacobianTransposed_;
+    JacobianInverseTransposed jacobianInverseTransposed_;
+    ctype integrationElement_;
+};
+
+
+/** \brief Geometry of a vertex
+ */
+template<int coorddim, class GridImp>
+class FoamGridGeometry<0, coorddim, GridImp>
+{
+    public:
+
+    typedef typename GridImp::ctype ctype;
+
+    static const int mydimension = 0;
+    static const int coorddimension = coorddim;
+
+    typedef FieldVector<ctype, mydimension> LocalCoordinate;
+    typedef FieldVector<ctype, coorddimension> GlobalCoordinate;
+    typedef FieldMatrix<ctype, mydimension, coorddimension> JacobianTransposed;
+    typedef FieldMatrix<ctype, coorddimension, mydimension> JacobianInverseTransposed;
+
+    /**
+     * \brief This is DefaultConstructor
+     */
+    FoamGridGeometry() {}
+
+    /**
+     * \brief Construct geometry from the position of the vertex
+     */
+    explicit FoamGridGeometry(const GlobalCoordinate& position)
+        : position_(position)
+    {}
+
+    /**
+     * \brief Construct geometry from coordinate vector
+     */
+    FoamGridGeometry(const GeometryType& type, const std::vector<GlobalCoordinate>& coordinates)
+        : position_(coordinates[0])
+    {
+        assert(type.isVertex() && coordinates.size() == 1);
+    }
+
+    GeometryType type () const {
+        return GeometryType(GeometryType::simplex, mydimension);
+    }
+
+    bool affine () const {
+        return true;
+    }
+
+    int corners () const {
+        return 1;
+    }
+
+    GlobalCoordinate corner (int i) const {
+        assert(i==0);
+        return position_;
+    }
+
+    GlobalCoordinate center () const {
+        return position_;
+    }
+
+    GlobalCoordinate global (const LocalCoordinate& local) const {
+        return position_;
+    }
+
+    LocalCoordinate local (const GlobalCoordinate& global) const {
+        return LocalCoordinate();
+    }
+
+    ctype integrationElement (const LocalCoordinate& local) const {
+        return 1;
+    }
+
+    ctype volume () const {
+        return 1;
+    }
+
+    const JacobianTransposed& jacobianTransposed (const LocalCoordinate& local) const {
+        return jacobianTransposed_;
+    }
+
+    const JacobianInverseTransposed& jacobianInverseTransposed (const LocalCoordinate& local) const {
+        return jacobianInverseTransposed_;
+    }
+
+    private:
+
+    GlobalCoordinate position_;
+    JacobianTransposed jacobianTransposed_;
+    JacobianInverseTransposed jacobianInverseTransposed_;
+};
+
+
 }  // namespace Dune
 
 #endif
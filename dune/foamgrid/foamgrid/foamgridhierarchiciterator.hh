@@ -26,6 +26,8 @@ class FoamGridHierarchicIterator :
 {
     enum {dimworld = GridImp::dimensionworld};
 
+    typedef typename GridImp::ctype ctype;
+
     friend class FoamGridEntity<0,GridImp::dimension,GridImp>;
 
     public:
@@ -44,7 +46,7 @@ class FoamGridHierarchicIterator :
             if (elemStack.empty())
                 return;
 
-            const FoamGridEntityImp<2,dimworld>* old_target = elemStack.top();
+            const FoamGridEntityImp<1,dimworld,ctype>* old_target = elemStack.top();
             elemStack.pop();
 
             // Traverse the tree no deeper than maxlevel
@@ -71,7 +73,7 @@ private:
     int maxlevel_;
 
     /** \brief For depth-first search */
-    std::stack<const FoamGridEntityImp<2,dimworld>*> elemStack;
+    std::stack<const FoamGridEntityImp<1,dimworld,ctype>*> elemStack;
 };
 
 
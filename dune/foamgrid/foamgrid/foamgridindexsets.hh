@@ -7,17 +7,37 @@
 * \brief The index and id sets for the FoamGrid class
 */
 
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
 #include <vector>
-#include <list>
 
 #include <dune/common/version.hh>
+#include <dune/common/tuples.hh>
 
 #include <dune/grid/common/indexidset.hh>
 
 #include "foamgridvertex.hh"  // for FoamGridEntityImp
+#include "foamgridedge.hh"
+#include "foamgridentitystorage.hh"
+#include "foamgridleafindexmap.hh"
 
 namespace Dune {
 
+    /** \brief How the leaf entities of a FoamGrid are numbered
+     *
+     * With levelOrder the leaf entities are numbered level by level, from the finest
+     * level to the coarsest one, and in the order of their creation within a level.
+     * Adaptation appends new entities at the end.  This is cheap, but scatters
+     * neighboring segments over the index range.
+     *
+     * With networkOrder the leaf vertices are numbered along the network by the reverse
+     * Cuthill-McKee algorithm, which keeps the bandwidth of matrices coupling neighboring
+     * vertices small, and the elements follow the numbering of their vertices.  The
+     * numbering is recomputed whenever the leaf index set changes, including adapt().
+     */
+    enum FoamGridLeafOrdering { levelOrder, networkOrder };
+
     /** \todo Take the index types from the host grid */
     template<class GridImp>
     class FoamGridLevelIndexSet :
@@ -30,8 +50,16 @@ namespace Dune {
         /** \brief Dimension of the space that the grid is embedded in */
         enum {dimworld = GridImp::dimensionworld};
 
+        /** \brief The type used for the coordinates */
+        typedef typename GridImp::ctype ctype;
+
     public:
 
+        /** \brief Constructor for an empty level */
+        FoamGridLevelIndexSet(int level = 0)
+            : level_(level), numQuads_(0), numTriangles_(0), numEdges_(0), numVertices_(0)
+        {}
+
         //! get index of an entity
         template<int codim>
         int index (const typename GridImp::Traits::template Codim<codim>::Entity& e) const
@@ -82,6 +110,18 @@ namespace Dune {
             return myTypes_[codim];
         }
 
+        /** \brief Bytes allocated by the index set, including the object itself
+         *
+         * The indices are stored in the entities, hence this does not grow with the level.
+         */
+        std::size_t memoryUsage() const
+        {
+            std::size_t result = sizeof(*this);
+            for (int i=0; i<=dim; i++)
+                result += myTypes_[i].capacity()*sizeof(GeometryType);
+            return result;
+        }
+
         /** \brief Return true if the given entity is contained in the index set
 
         This checks only for the level.  We assume that e belongs to the correct grid
@@ -102,7 +142,7 @@ namespace Dune {
             // ///////////////////////////////
 
             numEdges_ = 0;
-            typename std::list<FoamGridEntityImp<1,dimworld> >::const_iterator edIt;
+            typename FoamGridEntityStorage<FoamGridEntityImp<1,dimworld,ctype> >::const_iterator edIt;
             for (edIt =  Dune::get<1>(grid.entityImps_[level_]).begin();
                  edIt != Dune::get<1>(grid.entityImps_[level_]).end();
                  ++edIt)
@@ -114,16 +154,44 @@ namespace Dune {
             // //////////////////////////////
 
             numVertices_ = 0;
-            typename std::list<FoamGridEntityImp<0,dimworld> >::const_iterator vIt;
+            typename FoamGridEntityStorage<FoamGridEntityImp<0,dimworld,ctype> >::const_iterator vIt;
             for (vIt =  Dune::get<0>(grid.entityImps_[level_]).begin();
                  vIt != Dune::get<0>(grid.entityImps_[level_]).end();
                  ++vIt)
                 /** \todo Remove this const cast */
                 *const_cast<unsigned int*>(&(vIt->levelIndex_)) = numVertices_++;
 
-            // ///////////////////////////////////////////////
-            //   Update the list of geometry types present
-            // ///////////////////////////////////////////////
+            updateTypes();
+        }
+
+        /** \brief Give an element that was appended to the level the next index
+         *
+         * The level indices are the positions in the entity storage, hence this is
+         * only correct as long as no entity of the level has been erased since the
+         * last call to update().
+         */
+        void insert(const FoamGridEntityImp<1,dimworld,ctype>& element)
+        {
+            /** \todo Remove this const cast */
+            *const_cast<unsigned int*>(&(element.levelIndex_)) = numEdges_++;
+            if (numEdges_==1)
+                updateTypes();
+        }
+
+        /** \brief Give a vertex that was appended to the level the next index */
+        void insert(const FoamGridEntityImp<0,dimworld,ctype>& vertex)
+        {
+            /** \todo Remove this const cast */
+            *const_cast<unsigned int*>(&(vertex.levelIndex_)) = numVertices_++;
+            if (numVertices_==1)
+                updateTypes();
+        }
+
+    private:
+
+        /** \brief Update the list of geometry types present */
+        void updateTypes()
+        {
             for (int i=0; i<=dim; i++)
                 myTypes_[i].resize(0);
 
@@ -138,9 +206,10 @@ namespace Dune {
 
             if (numVertices_>0)
                 myTypes_[dim].push_back(GeometryType(0));
-
         }
 
+    public:
+
         int level_;
 
         int numQuads_;
@@ -167,16 +236,25 @@ class FoamGridLeafIndexSet :
     // Grid dimension
     enum {dimworld = remove_const<GridImp>::type::dimensionworld};
 
+    // The type used for the coordinates
+    typedef typename remove_const<GridImp>::type::ctype ctype;
+
 public:
 
     /** \brief Default constructor */
     FoamGridLeafIndexSet()
+    : ordering_(levelOrder)
     {}
 
-    /** \brief Copy constructor */
+    /** \brief Copy constructor
+     *
+     * The leaf entity arrays are not copied: leaf iterators always use the
+     * index set owned by the grid.
+     */
     FoamGridLeafIndexSet(const FoamGridLeafIndexSet& other)
     : size_(other.size_),
-      myTypes_(other.myTypes_)
+      myTypes_(other.myTypes_),
+      ordering_(other.ordering_)
     {}
 
         //! get index of an entity
@@ -196,7 +274,7 @@ public:
                       int i,
                       unsigned int codim) const
         {
-            return GridImp::getRealImplementation(e).target_->subLevelIndex(i,codim);
+            return GridImp::getRealImplementation(e).target_->subLeafIndex(i,codim);
         }
 
     //! get number of entities of given type
@@ -238,12 +316,16 @@ public:
         dune_static_assert(dim==1, "LeafIndexSet::update() only works for 1d grids");
 #endif
 
+        indexMap_.invalidate();
+
 
         // //////////////////////////////
         //   Init the edge indices
         // //////////////////////////////
 
         size_[1] = 0;
+        std::vector<const FoamGridEntityImp<1,dimworld,ctype>*>& leafElements = Dune::get<1>(leafEntities_);
+        leafElements.clear();
 
         for (int i=grid.maxLevel(); i>=0; i--) {
 
@@ -252,12 +334,13 @@ public:
 
             for (; edIt!=edEndIt; ++edIt) {
 
-                const FoamGridEntityImp<1,dimworld>* target = GridImp::getRealImplementation(*edIt).target_;
+                const FoamGridEntityImp<1,dimworld,ctype>* target = GridImp::getRealImplementation(*edIt).target_;
 
-                if (target->isLeaf())
+                if (target->isLeaf()) {
                     // The is a real leaf edge.
                     *const_cast<unsigned int*>(&(target->leafIndex_)) = size_[1]++;
-                else{
+                    leafElements.push_back(target);
+                } else{
                     if(target->nSons_==1)
                         // If there is green refinement an edge might only have
                         // one son. In this case son and father are identical and
@@ -274,6 +357,8 @@ public:
         // //////////////////////////////
 
         size_[0] = 0;
+        std::vector<const FoamGridEntityImp<0,dimworld,ctype>*>& leafVertices = Dune::get<0>(leafEntities_);
+        leafVertices.clear();
 
         for (int i=grid.maxLevel(); i>=0; i--) {
             typename GridImp::Traits::template Codim<dim>::LevelIterator vIt    = grid.template lbegin<dim>(i);
@@ -281,17 +366,20 @@ public:
 
             for (; vIt!=vEndIt; ++vIt) {
 
-                const FoamGridEntityImp<0,dimworld>* target = GridImp::getRealImplementation(*vIt).target_;
+                const FoamGridEntityImp<0,dimworld,ctype>* target = GridImp::getRealImplementation(*vIt).target_;
 
-                if (target->isLeaf())
+                if (target->isLeaf()) {
                     *const_cast<unsigned int*>(&(target->leafIndex_)) = size_[0]++;
-                else
+                    leafVertices.push_back(target);
+                } else
                     *const_cast<unsigned int*>(&(target->leafIndex_)) = target->son_->leafIndex_;
 
             }
 
         }
 
+        applyOrdering();
+
         // ///////////////////////////////////////////////
         //   Update the list of geometry types present
         // ///////////////////////////////////////////////
@@ -309,12 +397,494 @@ public:
 
     }
 
+    /** \brief Bytes allocated on the heap by the index set
+     *
+     * Counts the arrays of the leaf entities, the freed indices and the index map,
+     * but not the object itself, which is part of the grid.
+     */
+    std::size_t memoryUsage() const
+    {
+        std::size_t result = Dune::get<0>(leafEntities_).capacity()*sizeof(const FoamGridEntityImp<0,dimworld,ctype>*)
+            + Dune::get<1>(leafEntities_).capacity()*sizeof(const FoamGridEntityImp<1,dimworld,ctype>*)
+            + indexMap_.memoryUsage();
+        for (int i=0; i<=dim; i++)
+            result += holes_[i].capacity()*sizeof(unsigned int) + myTypes_[i].capacity()*sizeof(GeometryType);
+        return result;
+    }
+
+    /** \brief The numbering policy */
+    FoamGridLeafOrdering ordering() const
+    {
+        return ordering_;
+    }
+
+    /** \brief Set the numbering policy, it takes effect with the next update() or adapt() */
+    void setOrdering(FoamGridLeafOrdering ordering)
+    {
+        ordering_ = ordering;
+    }
+
+    /** \brief Renumber the leaf entities according to the numbering policy
+     *
+     * The entries of the index map are permuted along with the entities, so that
+     * the map still refers to the new numbering.
+     */
+    void applyOrdering()
+    {
+        if (ordering_ != networkOrder)
+            return;
+
+        typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+        typedef FoamGridEntityImp<1,dimworld,ctype> Element;
+
+        std::vector<const Element*>& leafElements = Dune::get<1>(leafEntities_);
+        std::vector<const Vertex*>& leafVertices = Dune::get<0>(leafEntities_);
+        const std::size_t numVertices = leafVertices.size();
+        const std::size_t numElements = leafElements.size();
+
+        // The leaf elements of each leaf vertex
+        std::vector<unsigned int> offsets(numVertices+1, 0), adjacent(2*numElements);
+        for (std::size_t e=0; e<numElements; e++)
+            for (int i=0; i<2; i++)
+                ++offsets[leafElements[e]->vertex_[i]->leafIndex_+1];
+        for (std::size_t v=0; v<numVertices; v++)
+            offsets[v+1] += offsets[v];
+
+        std::vector<unsigned int> position(offsets.begin(), offsets.end()-1);
+        for (std::size_t e=0; e<numElements; e++)
+            for (int i=0; i<2; i++)
+                adjacent[position[leafElements[e]->vertex_[i]->leafIndex_]++] = e;
+
+        // Cuthill-McKee order of the vertices, one connected component after the other
+        std::vector<unsigned int> order;
+        order.reserve(numVertices);
+        std::vector<bool> visited(numVertices, false);
+        std::vector<unsigned int> distance(numVertices, ~0u);
+        for (std::size_t seed=0; seed<numVertices; seed++) {
+            if (visited[seed])
+                continue;
+
+            const unsigned int start = peripheralVertex(seed, offsets, adjacent, distance);
+            const std::size_t first = order.size();
+            order.push_back(start);
+            visited[start] = true;
+            for (std::size_t k=first; k<order.size(); k++) {
+                const std::size_t next = order.size();
+                const unsigned int v = order[k];
+                for (unsigned int a=offsets[v]; a<offsets[v+1]; a++) {
+                    const unsigned int w = otherVertex(adjacent[a], v);
+                    if (!visited[w]) {
+                        visited[w] = true;
+                        order.push_back(w);
+                    }
+                }
+                std::sort(order.begin()+next, order.end(), DegreeLess(offsets));
+            }
+        }
+
+        // Reverse it, then let each element follow its lower numbered vertex
+        std::vector<unsigned int> newVertexIndex(numVertices);
+        for (std::size_t k=0; k<numVertices; k++)
+            newVertexIndex[order[numVertices-1-k]] = k;
+
+        std::vector<unsigned int> newElementIndex(numElements);
+        unsigned int next = 0;
+        for (std::size_t k=0; k<numVertices; k++) {
+            const unsigned int v = order[numVertices-1-k];
+            for (unsigned int a=offsets[v]; a<offsets[v+1]; a++) {
+                const unsigned int e = adjacent[a];
+                if (newVertexIndex[otherVertex(e, v)] > k)
+                    newElementIndex[e] = next++;
+            }
+        }
+        assert(next == numElements);
+
+        permute(leafVertices, newVertexIndex, indexMap_.entries_[0]);
+        permute(leafElements, newElementIndex, indexMap_.entries_[1]);
+    }
+
+    /** \brief Start recording the changes of the numbering in the index map */
+    void beginAdaptation()
+    {
+        indexMap_.reset(size_);
+    }
+
+    /** \brief Hand the leaf indices over to copies of the leaf entities
+     *
+     * The copies vertices[i] and elements[i] take over the leaf index i, and the
+     * index map records every entity as kept.  Used by FoamGrid::flatten().
+     */
+    void transfer(const std::vector<const FoamGridEntityImp<0,dimworld,ctype>*>& vertices,
+                  const std::vector<const FoamGridEntityImp<1,dimworld,ctype>*>& elements)
+    {
+        assert(vertices.size() == Dune::get<0>(leafEntities_).size()
+               && elements.size() == Dune::get<1>(leafEntities_).size());
+
+        Dune::get<0>(leafEntities_) = vertices;
+        Dune::get<1>(leafEntities_) = elements;
+
+        for (std::size_t i=0; i<vertices.size(); i++)
+            *const_cast<unsigned int*>(&(vertices[i]->leafIndex_)) = i;
+        for (std::size_t i=0; i<elements.size(); i++)
+            *const_cast<unsigned int*>(&(elements[i]->leafIndex_)) = i;
+
+        indexMap_.reset(size_);
+    }
+
+    /** \brief Patch the numbering after a leaf element has been bisected
+     *
+     * The first son takes over the index of the element, and the copies of its
+     * vertices that were created with the sons take over the indices of the
+     * vertices.  The second son and the midpoint get new indices at the end.
+     */
+    void refine(const FoamGridEntityImp<1,dimworld,ctype>& element)
+    {
+        typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+
+        std::vector<const FoamGridEntityImp<1,dimworld,ctype>*>& leafElements = Dune::get<1>(leafEntities_);
+        std::vector<const Vertex*>& leafVertices = Dune::get<0>(leafEntities_);
+
+        typedef FoamGridLeafIndexMap<dim> IndexMap;
+        const unsigned int index = element.leafIndex_;
+        indexMap_.entries_[1][index] = IndexMap::makeEntry(index, index, IndexMap::refined, 0);
+        indexMap_.entries_[1].push_back(IndexMap::makeEntry(index, index, IndexMap::refined, 1));
+
+        replace(leafElements, element, *element.sons_[0]);
+        append(leafElements, *element.sons_[1]);
+
+        for (int k=0; k<2; k++) {
+            // The copy is already numbered if a neighbor has been refined before
+            const Vertex* vertex = element.vertex_[k];
+            if (leafVertices[vertex->leafIndex_] == vertex)
+                replace(leafVertices, *vertex, *vertex->son_);
+        }
+
+        append(leafVertices, *element.sons_[0]->vertex_[1]);
+        indexMap_.entries_[0].push_back(IndexMap::makeEntry(element.vertex_[0]->leafIndex_,
+                                                            element.vertex_[1]->leafIndex_,
+                                                            IndexMap::created));
+
+        size_[1] = leafElements.size();
+        size_[0] = leafVertices.size();
+    }
+
+    /** \brief Patch the numbering before the sons of an element are removed
+     *
+     * Has to be called while the sons, the midpoint and the copies of the vertices
+     * of the father are still in place, and after the adjacency of the level of the
+     * sons already reflects all other changes.  The indices that become free are
+     * only reused by compact().
+     */
+    void coarsen(const FoamGridEntityImp<1,dimworld,ctype>& father)
+    {
+        typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+
+        std::vector<const FoamGridEntityImp<1,dimworld,ctype>*>& leafElements = Dune::get<1>(leafEntities_);
+        std::vector<const Vertex*>& leafVertices = Dune::get<0>(leafEntities_);
+
+        typedef FoamGridLeafIndexMap<dim> IndexMap;
+        indexMap_.entries_[1][father.sons_[0]->leafIndex_]
+            = IndexMap::makeEntry(father.sons_[0]->leafIndex_, father.sons_[1]->leafIndex_, IndexMap::coarsened);
+
+        replace(leafElements, *father.sons_[0], father);
+        holes_[1].push_back(father.sons_[1]->leafIndex_);
+
+        holes_[0].push_back(father.sons_[0]->vertex_[1]->leafIndex_);
+
+        for (int k=0; k<2; k++) {
+            // A copy that belongs to the son only vanishes with it
+            const Vertex* copy = father.vertex_[k]->son_;
+            if (copy->nElements_ == 1)
+                replace(leafVertices, *copy, *father.vertex_[k]);
+        }
+    }
+
+    /** \brief Give an element inserted by FoamGrid::grow() the next free leaf index
+     *
+     * \param insertionIndex The number of the element in the growth step, for the index map
+     */
+    void insert(const FoamGridEntityImp<1,dimworld,ctype>& element, unsigned int insertionIndex)
+    {
+        insert(Dune::get<1>(leafEntities_), element, insertionIndex, indexMap_.entries_[1]);
+        size_[1] = Dune::get<1>(leafEntities_).size();
+    }
+
+    /** \brief Give a vertex inserted by FoamGrid::grow() the next free leaf index */
+    void insert(const FoamGridEntityImp<0,dimworld,ctype>& vertex, unsigned int insertionIndex)
+    {
+        insert(Dune::get<0>(leafEntities_), vertex, insertionIndex, indexMap_.entries_[0]);
+        size_[0] = Dune::get<0>(leafEntities_).size();
+    }
+
+    /** \brief Free the leaf index of an element removed by FoamGrid::grow()
+     *
+     * The index is only reused by compact().
+     */
+    void remove(const FoamGridEntityImp<1,dimworld,ctype>& element)
+    {
+        holes_[1].push_back(element.leafIndex_);
+        indexMap_.topologyChanged_ = true;
+    }
+
+    /** \brief Free the leaf index of a vertex removed by FoamGrid::grow() */
+    void remove(const FoamGridEntityImp<0,dimworld,ctype>& vertex)
+    {
+        holes_[0].push_back(vertex.leafIndex_);
+        indexMap_.topologyChanged_ = true;
+    }
+
+    /** \brief Fill the indices freed by coarsen() with the last entities */
+    void compact()
+    {
+        compact(Dune::get<1>(leafEntities_), holes_[1], indexMap_.entries_[1]);
+        compact(Dune::get<0>(leafEntities_), holes_[0], indexMap_.entries_[0]);
+
+        size_[1] = Dune::get<1>(leafEntities_).size();
+        size_[0] = Dune::get<0>(leafEntities_).size();
+
+        updateTypes();
+    }
+
+    /** \brief Set up the index set from leaf indices that are already stored in the entities
+     *
+     * Used when a grid is restored from a backup, to keep the numbering it had.
+     */
+    void restore(const GridImp& grid)
+    {
+        indexMap_.invalidate();
+        Dune::get<1>(leafEntities_).clear();
+        Dune::get<0>(leafEntities_).clear();
+
+        size_[1] = size_[0] = 0;
+        for (int i=0; i<=grid.maxLevel(); i++) {
+            size_[1] += restore(Dune::get<1>(grid.entityImps_[i]), Dune::get<1>(leafEntities_));
+            size_[0] += restore(Dune::get<0>(grid.entityImps_[i]), Dune::get<0>(leafEntities_));
+        }
+
+        if (std::find(Dune::get<1>(leafEntities_).begin(), Dune::get<1>(leafEntities_).end(), nullptr)
+                != Dune::get<1>(leafEntities_).end()
+            || std::find(Dune::get<0>(leafEntities_).begin(), Dune::get<0>(leafEntities_).end(), nullptr)
+                != Dune::get<0>(leafEntities_).end())
+            DUNE_THROW(GridError, "The stored leaf indices are not consecutive");
+
+        updateTypes();
+    }
+
     // Number of entities per dimension
     array<int,dim+1> size_;
 
     /** \brief The GeometryTypes present for each codim */
     array<std::vector<GeometryType>, dim+1> myTypes_;
 
+    /** \brief The leaf entities of each dimension, ordered by their leaf index */
+    tuple<std::vector<const FoamGridEntityImp<0,dimworld,ctype>*>,
+          std::vector<const FoamGridEntityImp<1,dimworld,ctype>*> > leafEntities_;
+
+    /** \brief The origin of the leaf entities after the last adaptation step */
+    FoamGridLeafIndexMap<dim> indexMap_;
+
+private:
+
+    /** \brief Order vertices by their number of leaf elements */
+    struct DegreeLess
+    {
+        DegreeLess(const std::vector<unsigned int>& offsets)
+            : offsets_(offsets)
+        {}
+
+        bool operator()(unsigned int a, unsigned int b) const {
+            return offsets_[a+1]-offsets_[a] < offsets_[b+1]-offsets_[b];
+        }
+
+        const std::vector<unsigned int>& offsets_;
+    };
+
+    /** \brief The leaf index of the vertex of a leaf element that is not the given one */
+    unsigned int otherVertex(unsigned int element, unsigned int vertex) const
+    {
+        const FoamGridEntityImp<1,dimworld,ctype>* e = Dune::get<1>(leafEntities_)[element];
+        return (e->vertex_[0]->leafIndex_ == vertex) ? e->vertex_[1]->leafIndex_ : e->vertex_[0]->leafIndex_;
+    }
+
+    /** \brief A vertex of the component of seed that is far from the others
+     *
+     * Starts a breadth-first search at seed and repeats it from the vertex of smallest
+     * degree in the last layer, as long as the number of layers grows.  On a tree this
+     * ends at one end of a longest path.
+     *
+     * \param distance Scratch space with one entry per vertex, all ~0u, and left so
+     */
+    unsigned int peripheralVertex(unsigned int seed, const std::vector<unsigned int>& offsets,
+                                  const std::vector<unsigned int>& adjacent,
+                                  std::vector<unsigned int>& distance) const
+    {
+        std::vector<unsigned int> layers;
+        unsigned int depth = 0;
+        unsigned int start = seed;
+        while (true) {
+            layers.assign(1, start);
+            distance[start] = 0;
+            for (std::size_t k=0; k<layers.size(); k++) {
+                const unsigned int v = layers[k];
+                for (unsigned int a=offsets[v]; a<offsets[v+1]; a++) {
+                    const unsigned int w = otherVertex(adjacent[a], v);
+                    if (distance[w] == ~0u) {
+                        distance[w] = distance[v]+1;
+                        layers.push_back(w);
+                    }
+                }
+            }
+
+            const unsigned int last = distance[layers.back()];
+            unsigned int candidate = layers.back();
+            for (std::size_t k=layers.size(); k-- > 0 && distance[layers[k]] == last;)
+                if (DegreeLess(offsets)(layers[k], candidate))
+                    candidate = layers[k];
+
+            for (std::size_t k=0; k<layers.size(); k++)
+                distance[layers[k]] = ~0u;
+
+            if (last == 0 || (start != seed && last <= depth))
+                return start;
+            depth = last;
+            start = candidate;
+        }
+    }
+
+    /** \brief Move the entities and the index map entries to their new leaf indices */
+    template <class Entity, class MapEntry>
+    static void permute(std::vector<const Entity*>& entities, const std::vector<unsigned int>& newIndex,
+                        std::vector<MapEntry>& mapEntries)
+    {
+        std::vector<const Entity*> permuted(entities.size());
+        for (std::size_t i=0; i<entities.size(); i++) {
+            permuted[newIndex[i]] = entities[i];
+            setLeafIndex(*entities[i], newIndex[i]);
+        }
+        entities.swap(permuted);
+
+        // The map is empty unless an adaptation is being recorded
+        if (mapEntries.size() == entities.size()) {
+            std::vector<MapEntry> permutedEntries(mapEntries.size());
+            for (std::size_t i=0; i<mapEntries.size(); i++)
+                permutedEntries[newIndex[i]] = mapEntries[i];
+            mapEntries.swap(permutedEntries);
+        }
+    }
+
+    /** \brief Update the list of geometry types present */
+    void updateTypes()
+    {
+        /** \todo This will not work for grids with more than one element type */
+        for (int i=0; i<=dim; i++) {
+            if (size_[dim-i]>0) {
+                myTypes_[i].resize(1);
+                myTypes_[i][0] = GeometryType(GeometryType::simplex, dim-i);
+            } else
+                myTypes_[i].resize(0);
+        }
+    }
+
+    /** \brief Enter the leaf entities of one storage at their leaf index, return their number */
+    template <class Storage, class Entity>
+    static int restore(const Storage& storage, std::vector<const Entity*>& entities)
+    {
+        int count = 0;
+        for (typename Storage::const_iterator it = storage.begin(); it != storage.end(); ++it) {
+            if (!it->isLeaf())
+                continue;
+            if (it->leafIndex_ >= entities.size())
+                entities.resize(it->leafIndex_+1, nullptr);
+            if (entities[it->leafIndex_])
+                DUNE_THROW(GridError, "The stored leaf index " << it->leafIndex_ << " is not unique");
+            entities[it->leafIndex_] = &*it;
+            ++count;
+        }
+        return count;
+    }
+
+    /** \brief Let an entity take over the leaf index of another one */
+    template <class Entity>
+    static void replace(std::vector<const Entity*>& entities, const Entity& from, const Entity& to)
+    {
+        *const_cast<unsigned int*>(&(to.leafIndex_)) = from.leafIndex_;
+        entities[from.leafIndex_] = &to;
+    }
+
+    /** \brief Give an entity the next free leaf index */
+    template <class Entity>
+    static void append(std::vector<const Entity*>& entities, const Entity& entity)
+    {
+        *const_cast<unsigned int*>(&(entity.leafIndex_)) = entities.size();
+        entities.push_back(&entity);
+    }
+
+    /** \brief Append an inserted entity and its entry in the index map */
+    template <class Entity, class MapEntry>
+    void insert(std::vector<const Entity*>& entities, const Entity& entity, unsigned int insertionIndex,
+                std::vector<MapEntry>& mapEntries)
+    {
+        typedef FoamGridLeafIndexMap<dim> IndexMap;
+        append(entities, entity);
+        mapEntries.push_back(IndexMap::makeEntry(insertionIndex, insertionIndex, IndexMap::inserted));
+        indexMap_.topologyChanged_ = true;
+    }
+
+    /** \brief Move the last entities into the holes and shrink the array
+     *
+     * The entries of the index map are moved along with the entities.
+     */
+    template <class Entity, class MapEntry>
+    static void compact(std::vector<const Entity*>& entities, std::vector<unsigned int>& holes,
+                        std::vector<MapEntry>& mapEntries)
+    {
+        // Going from the back, the last entity is never a hole itself
+        std::sort(holes.begin(), holes.end());
+        for (std::vector<unsigned int>::reverse_iterator hole = holes.rbegin(); hole != holes.rend(); ++hole) {
+            if (*hole+1 != entities.size()) {
+                setLeafIndex(*(entities[*hole] = entities.back()), *hole);
+                mapEntries[*hole] = mapEntries.back();
+            }
+            entities.pop_back();
+            mapEntries.pop_back();
+        }
+        holes.clear();
+    }
+
+    /** \brief Renumber a leaf element */
+    static void setLeafIndex(const FoamGridEntityImp<1,dimworld,ctype>& element, unsigned int index)
+    {
+        *const_cast<unsigned int*>(&(element.leafIndex_)) = index;
+    }
+
+    /** \brief Renumber a leaf vertex together with its copies on coarser levels
+     *
+     * All elements containing a copy are sons that keep the corresponding vertex
+     * of their father, hence the next coarser copy is found through any of them.
+     */
+    static void setLeafIndex(const FoamGridEntityImp<0,dimworld,ctype>& leafVertex, unsigned int index)
+    {
+        const FoamGridEntityImp<0,dimworld,ctype>* vertex = &leafVertex;
+        while (true) {
+            *const_cast<unsigned int*>(&(vertex->leafIndex_)) = index;
+            if (vertex->nElements_ == 0)
+                return;
+
+            const FoamGridEntityImp<1,dimworld,ctype>* element = vertex->elements()[0];
+            const int i = (element->vertex_[0] == vertex) ? 0 : 1;
+            if (!element->father_ || element->refinementIndex_ != i)
+                return;
+
+            vertex = element->father_->vertex_[i];
+        }
+    }
+
+    /** \brief Leaf indices freed by coarsen() for each dimension */
+    array<std::vector<unsigned int>, dim+1> holes_;
+
+    /** \brief The numbering policy */
+    FoamGridLeafOrdering ordering_;
+
 };
 
 
@@ -3,12 +3,11 @@
 #ifndef DUNE_FOAMGRID_INTERSECTIONITERATORS_HH
 #define DUNE_FOAMGRID_INTERSECTIONITERATORS_HH
 
+#include <algorithm>
+
 #include "foamgridintersections.hh"
 #include "foamgridvertex.hh"
-
-#include <map>
-
-#include <dune/common/shared_ptr.hh>
+#include "foamgridadjacency.hh"
 
 /** \file
 * \brief The FoamGridLeafIntersectionIterator and FoamGridLevelIntersectionIterator classes
@@ -20,6 +19,57 @@ template<class GridImp>
 class FoamGridLevelIntersectionIterator;
 
 
+/** \brief Navigation between the copies of a vertex on different levels
+ *
+ * When an element is bisected, son k keeps the copy of vertex k of its father
+ * on the next level at local index k, and the new midpoint becomes vertex 1-k
+ * of both sons.  Hence the copies of a vertex can be found by following the
+ * father and son pointers of the elements, without any lookup.
+ */
+template<int dimworld, class ctype>
+struct FoamGridVertexCopies
+{
+    typedef FoamGridEntityImp<0,dimworld,ctype> Vertex;
+    typedef FoamGridEntityImp<1,dimworld,ctype> Element;
+
+    /** \brief Whether vertex i of an element is the copy of a vertex on a coarser level */
+    static bool hasCoarserCopy(const Element* element, int i)
+    {
+        return element->father_ && element->refinementIndex_ == i;
+    }
+
+    /** \brief The coarsest copy of vertex i of an element */
+    static const Vertex* coarsest(const Element* element, int i)
+    {
+        while (hasCoarserCopy(element, i))
+            element = element->father_;
+        return element->vertex_[i];
+    }
+
+    /** \brief Append the leaf elements that contain a vertex or one of its finer copies
+     *
+     * \param vertex The vertex, it has to be its own coarsest copy
+     * \param exclude This element is not appended
+     * \param elements The container the elements are appended to
+     */
+    template<class Container>
+    static void leafElements(const Vertex* vertex, const Element* exclude, Container& elements)
+    {
+        typedef typename FoamGridElementSpan<Element>::const_iterator Iterator;
+        const FoamGridElementSpan<Element> span = vertex->elements();
+        for (Iterator it = span.begin(); it != span.end(); ++it)
+        {
+            const Element* element = *it;
+            const int i = (element->vertex_[0] == vertex) ? 0 : 1;
+            while (!element->isLeaf())
+                element = element->sons_[i];
+            if (element != exclude)
+                elements.push_back(element);
+        }
+    }
+};
+
+
 /** \brief Iterator over all element neighbors
 * \ingroup FoamGrid
 * Mesh entities of codimension 0 ("elements") allow to visit all neighbors, where
@@ -27,6 +77,12 @@ class FoamGridLevelIntersectionIterator;
 * These neighbors are accessed via a IntersectionIterator. This allows the implement
 * non-matching meshes. The number of neighbors may be different from the number
 * of an element!
+*
+* If a vertex of the element has no copies on other levels, which is the case
+* everywhere in a grid that has not been refined, the neighbors are read directly
+* from the adjacency of the vertex.  Otherwise the leaf elements at the vertex are
+* collected into a small buffer inside the iterator, which only allocates at
+* junctions with more than maxInlineNeighbors neighbors.
 */
 template<class GridImp>
 class FoamGridLeafIntersectionIterator
@@ -34,54 +90,34 @@ class FoamGridLeafIntersectionIterator
 
     enum {dimworld=GridImp::dimensionworld};
 
-    typedef std::vector<const FoamGridEntityImp<2,dimworld>*> ElementVector;
+    typedef typename GridImp::ctype ctype;
 
-    typedef std::map<int, ElementVector> MapType;
-public:
-
-    //! Constructor for a given grid entity and a given neighbor
-    FoamGridLeafIntersectionIterator(const FoamGridEntityImp<2,dimworld>* center, int edge)
-        : intersection_(FoamGridLeafIntersection<GridImp>(center,edge)),
-          leafEdges_(make_shared<MapType>())
-    {
-        if(edge==center->corners())
-        {
-            // This is the end iterator
-            return;
-        }
+    typedef FoamGridEntityImp<1,dimworld,ctype> Element;
 
-        for(std::size_t i=0; i<3; ++i)
-            traverseAndPushLeafEdges(center->edges_[i], (*leafEdges_)[i]);
+    typedef FoamGridVertexCopies<dimworld,ctype> Copies;
 
+public:
 
-        // Search for the first intersection.
-        // For each edge there is either one or it is a boundary intersection
-        topLevelEdgeIter_=leafEdges_->find(edge);
-        assert(topLevelEdgeIter_!=leafEdges_->end());
-        assert(edge>0 || topLevelEdgeIter_ == leafEdges_->begin());
-        GridImp::getRealImplementation(intersection_).neighbor_=topLevelEdgeIter_->second.begin();
-        GridImp::getRealImplementation(intersection_).edgeIndex_=edge;
-        GridImp::getRealImplementation(intersection_).neighborEnd_=topLevelEdgeIter_->second.end();
-        assert(*GridImp::getRealImplementation(intersection_).neighbor_);
+    /** \brief Number of neighbors at a vertex that are stored without allocation */
+    enum {maxInlineNeighbors = 8};
 
-        if(center->edges_[edge]->elements_.size()==1){
-            // This is a boundary edge.
-            GridImp::getRealImplementation(intersection_).neighbor_=
-                topLevelEdgeIter_->second.end();
+    //! Constructor for a given grid entity and a given vertex
+    FoamGridLeafIntersectionIterator(const Element* center, int vertex)
+        : intersection_(FoamGridLeafIntersection<GridImp>(center,vertex)),
+          position_(0), skip_(0), buffered_(false)
+    {
+        if (vertex == 2)
+            // This is the end iterator
             return;
-        }
 
-        if(GridImp::getRealImplementation(intersection_).neighbor_ != GridImp::getRealImplementation(intersection_).neighborEnd_
-           && *GridImp::getRealImplementation(intersection_).neighbor_==center)
-        {
-            ++GridImp::getRealImplementation(intersection_).neighbor_;
-        }
+        collectNeighbors();
+        updateNeighbor();
     }
 
     /** \brief Constructor creating the 'one-after-last'-iterator */
-    FoamGridLeafIntersectionIterator(const FoamGridEntityImp<2,dimworld>* center)
-        : intersection_(FoamGridLeafIntersection<GridImp>(center,center->corners())),
-          leafEdges_(make_shared<MapType>())
+    FoamGridLeafIntersectionIterator(const Element* center)
+        : intersection_(FoamGridLeafIntersection<GridImp>(center,2)),
+          position_(0), skip_(0), buffered_(false)
     {
     }
 
@@ -89,63 +125,33 @@ public:
 
     //! equality
     bool equals(const FoamGridLeafIntersectionIterator<GridImp>& other) const {
-        return GridImp::getRealImplementation(intersection_).center_   == GridImp::getRealImplementation(other.intersection_).center_ &&
-            GridImp::getRealImplementation(intersection_).edgeIndex_ == GridImp::getRealImplementation(other.intersection_).edgeIndex_ &&
-            (GridImp::getRealImplementation(intersection_).edgeIndex_ == GridImp::getRealImplementation(intersection_).center_->corners()  ||
-             (*GridImp::getRealImplementation(intersection_).neighbor_ ==
-              *GridImp::getRealImplementation(other.intersection_).neighbor_));
+        return GridImp::getRealImplementation(intersection_).center_      == GridImp::getRealImplementation(other.intersection_).center_ &&
+               GridImp::getRealImplementation(intersection_).vertexIndex_ == GridImp::getRealImplementation(other.intersection_).vertexIndex_ &&
+               position_ == other.position_;
     }
 
     //! prefix increment
     void increment()
     {
-        if(GridImp::getRealImplementation(intersection_).edgeIndex_ == GridImp::getRealImplementation(intersection_).center_->corners())
-        {
-            // This is already the end iterator
+        FoamGridLeafIntersection<GridImp>& intersection = GridImp::getRealImplementation(intersection_);
+
+        if (intersection.vertexIndex_ == 2)
             DUNE_THROW(InvalidStateException, "Cannot increment a one past the end iterator");
-            return;
-        }
-        assert(topLevelEdgeIter_!=leafEdges_->end());
-
-        if(GridImp::getRealImplementation(intersection_).neighbor_ !=
-           GridImp::getRealImplementation(intersection_).neighborEnd_)
-            // increment
-            ++GridImp::getRealImplementation(intersection_).neighbor_;
-
-        if(GridImp::getRealImplementation(intersection_).neighbor_ !=
-           GridImp::getRealImplementation(intersection_).neighborEnd_ &&
-           *(GridImp::getRealImplementation(intersection_).neighbor_) ==
-           GridImp::getRealImplementation(intersection_).center_)
-            // pointing to to the center_ -> increment another time
-            ++GridImp::getRealImplementation(intersection_).neighbor_;
-
-        if(GridImp::getRealImplementation(intersection_).neighbor_ ==
-           GridImp::getRealImplementation(intersection_).neighborEnd_)
+
+        // There is one intersection per neighbor, but at least one per vertex
+        if (++position_ < numNeighbors())
         {
-            assert(topLevelEdgeIter_!=leafEdges_->end());
-            ++topLevelEdgeIter_;
-            ++GridImp::getRealImplementation(intersection_).edgeIndex_;
-            if(topLevelEdgeIter_==leafEdges_->end())
-                return;
-
-            GridImp::getRealImplementation(intersection_).neighbor_
-                = topLevelEdgeIter_->second.begin();
-            GridImp::getRealImplementation(intersection_).neighborEnd_=
-                topLevelEdgeIter_->second.end();
-            if(GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.size()==1){
-                // This is a boundary edge.
-                GridImp::getRealImplementation(intersection_).neighbor_=
-                    GridImp::getRealImplementation(intersection_).neighborEnd_;
-                return;
-
-            }
-            if(GridImp::getRealImplementation(intersection_).neighbor_ != GridImp::getRealImplementation(intersection_).neighborEnd_
-               && *GridImp::getRealImplementation(intersection_).neighbor_==
-               GridImp::getRealImplementation(intersection_).center_)
-            {
-                ++GridImp::getRealImplementation(intersection_).neighbor_;
-            }
+            updateNeighbor();
+            return;
         }
+
+        position_ = 0;
+        if (++intersection.vertexIndex_ == 2)
+            // This is the end iterator
+            return;
+
+        collectNeighbors();
+        updateNeighbor();
     }
 
 
@@ -156,50 +162,75 @@ public:
 
 private:
 
-    //! \brief Pushes all leaf Edges into leafEdges_
-    //!
-    //! On returning leafEdges_ will contain the children
-    //! of edge that do not have any children.
-    //! \param edge The edge whose leafEdge we need.
-    //!
-    void traverseAndPushLeafEdges(FoamGridEntityImp<1,dimworld>* edge,
-                                  ElementVector& leafEdges)
+    /** \brief Find the leaf neighbors at the current vertex */
+    void collectNeighbors()
     {
-        if(edge->isLeaf())
+        FoamGridLeafIntersection<GridImp>& intersection = GridImp::getRealImplementation(intersection_);
+        const Element* center = intersection.center_;
+        const int i = intersection.vertexIndex_;
+
+        if (center->vertex_[i]->son_ == nullptr && !Copies::hasCoarserCopy(center, i))
         {
-            leafEdges.insert(leafEdges.end(), edge->elements_.begin(),
-                              edge->elements_.end());
-#ifndef NDEBUG
-            typedef typename ElementVector::const_iterator
-                iter;
-            for(iter i=leafEdges.begin(); i!=leafEdges.end(); ++i)
-                assert(*i);
-#endif
+            // All leaf neighbors live on the level of the center
+            span_ = center->vertex_[i]->elements();
+            skip_ = std::find(span_.begin(), span_.end(), center) - span_.begin();
+            buffered_ = false;
+            intersection.boundary_ = (span_.size() == 1);
         }
         else
         {
-            traverseAndPushLeafEdges(edge->sons_[0],leafEdges);
-            traverseAndPushLeafEdges(edge->sons_[1],leafEdges);
+            const FoamGridEntityImp<0,dimworld,ctype>* vertex = Copies::coarsest(center, i);
+            buffer_.clear();
+            Copies::leafElements(vertex, center, buffer_);
+            buffered_ = true;
+            intersection.boundary_ = (vertex->nElements_ == 1);
         }
     }
 
+    /** \brief Number of leaf neighbors at the current vertex */
+    unsigned int numNeighbors() const
+    {
+        return buffered_ ? buffer_.size() : span_.size()-1;
+    }
+
+    /** \brief Point the intersection to the neighbor at position_ */
+    void updateNeighbor()
+    {
+        const Element*& neighbor = GridImp::getRealImplementation(intersection_).neighbor_;
+        if (position_ >= numNeighbors())
+            neighbor = nullptr;
+        else if (buffered_)
+            neighbor = buffer_[position_];
+        else
+            neighbor = span_[(position_ < skip_) ? position_ : position_+1];
+    }
+
     mutable MakeableInterfaceObject<Intersection> intersection_;
 
-    //! \brief pointer to map from edge index onto the intersections associated with the edge
-    //!
-    //! This has to be pointer to prevent copying it during copying the iterator.
-    //! Otherwise the stored iterators to its entries would be invalidated.
-    shared_ptr<MapType> leafEdges_;
+    //! \brief Number of the current intersection at the current vertex
+    unsigned int position_;
+
+    //! \brief The elements of the level of the center at the current vertex
+    FoamGridElementSpan<Element> span_;
 
-    //! \brief Iterator pointing to the elements of the current edge.
-    typename std::map<int, ElementVector>::const_iterator
-    topLevelEdgeIter_;
+    //! \brief Position of the center in span_
+    unsigned int skip_;
+
+    //! \brief Whether the neighbors are taken from buffer_ rather than from span_
+    bool buffered_;
+
+    //! \brief The leaf neighbors at the current vertex, if they are not all on one level
+    FoamGridElementBuffer<Element, maxInlineNeighbors> buffer_;
 };
 
 
 
 
-//! \todo Please doc me !
+/** \brief Iterator over the neighbors of an element on the same level
+* \ingroup FoamGrid
+*
+* The neighbors are read directly from the adjacency of the vertices.
+*/
 template<class GridImp>
 class FoamGridLevelIntersectionIterator
 {
@@ -207,71 +238,35 @@ class FoamGridLevelIntersectionIterator
     enum { dim=GridImp::dimension };
     enum { dimworld=GridImp::dimensionworld };
 
+    typedef typename GridImp::ctype ctype;
+
+    typedef FoamGridEntityImp<1,dimworld,ctype> Element;
+
     // Only the codim-0 entity is allowed to call the constructors
     friend class FoamGridEntity<0,dim,GridImp>;
 
     /** \todo Make this private once FoamGridLeafIntersectionIterator doesn't derive from this class anymore */
 protected:
-    //! \brief Constructor for a given grid entity and a given neighbor
+    //! \brief Constructor for a given grid entity and a given vertex
     //! \param center Pointer to the element where the iterator was created.
-    //! \param edge The index of the edge to start the investigation.
-    FoamGridLevelIntersectionIterator(const FoamGridEntityImp<2,dimworld>* center, std::size_t edge)
-        : intersection_(FoamGridLevelIntersection<GridImp>(center,edge))
+    //! \param vertex The index of the vertex to start the investigation.
+    FoamGridLevelIntersectionIterator(const Element* center, int vertex)
+        : intersection_(FoamGridLevelIntersection<GridImp>(center,vertex)),
+          position_(0), skip_(0)
     {
-        if(edge==center->corners())
-        {
+        if (vertex == 2)
             // This is the end iterator
-            GridImp::getRealImplementation(intersection_).neighborIndex_=0;
-            return;
-        }
-
-        if(center->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.size()==1){
-            // This is a boundary edge.
-            GridImp::getRealImplementation(intersection_).neighborIndex_=
-                GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.size();
             return;
-        }
 
-        // Search for the first intersection.
-        // An intersection has either two neighbor elements on the same level
-        // or is a boundary intersection
-        while(GridImp::getRealImplementation(intersection_).edgeIndex_ != center->corners()) // not an  end iterator
-        {
-            GridImp::getRealImplementation(intersection_).neighbor_=GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.begin();
-            GridImp::getRealImplementation(intersection_).neighborIndex_=0;
-            while(GridImp::getRealImplementation(intersection_).neighbor_!=GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.end() &&
-                  (GridImp::getRealImplementation(intersection_).center_==*GridImp::getRealImplementation(intersection_).neighbor_
-                   ||GridImp::getRealImplementation(intersection_).center_->level()!=(*GridImp::getRealImplementation(intersection_).neighbor_)->level()))
-            {
-                ++GridImp::getRealImplementation(intersection_).neighborIndex_;
-                ++GridImp::getRealImplementation(intersection_).neighbor_;
-            }
-            if(GridImp::getRealImplementation(intersection_).neighbor_==GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.end())
-            {
-                if(GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.size()==1)
-                {
-                    // This is a boundary intersection.
-                     GridImp::getRealImplementation(intersection_).neighborIndex_=GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.size();
-                    return;
-                }else
-                    // No valid intersection found on this edge, move to next one.
-                    ++GridImp::getRealImplementation(intersection_).edgeIndex_;
-            }else
-                // intersection with another element found!
-                break;
-        }
-        if(GridImp::getRealImplementation(this->intersection_).edgeIndex_==center->corners())
-        {
-            // This is the end iterator
-            GridImp::getRealImplementation(this->intersection_).neighborIndex_=0;
-        }
+        collectNeighbors();
+        updateNeighbor();
     }
 
     /** \brief Constructor creating the 'one-after-last'-iterator */
-    FoamGridLevelIntersectionIterator(const FoamGridEntityImp<2,dimworld>* center)
-        : intersection_(FoamGridLevelIntersection<GridImp>(center,center->corners()))
+    FoamGridLevelIntersectionIterator(const Element* center)
+        : intersection_(FoamGridLevelIntersection<GridImp>(center,2)),
+          position_(0), skip_(0)
     {
-        GridImp::getRealImplementation(intersection_).neighborIndex_=0;
     }
 
 public:
@@ -280,88 +275,33 @@ public:
 
   //! equality
   bool equals(const FoamGridLevelIntersectionIterator<GridImp>& other) const {
-      return (GridImp::getRealImplementation(this->intersection_).center_   == GridImp::getRealImplementation(other.intersection_).center_)
-          && (GridImp::getRealImplementation(this->intersection_).edgeIndex_ == GridImp::getRealImplementation(other.intersection_).edgeIndex_)
-          && (GridImp::getRealImplementation(this->intersection_).neighborIndex_ == GridImp::getRealImplementation(other.intersection_).neighborIndex_);
+      return (GridImp::getRealImplementation(this->intersection_).center_      == GridImp::getRealImplementation(other.intersection_).center_)
+          && (GridImp::getRealImplementation(this->intersection_).vertexIndex_ == GridImp::getRealImplementation(other.intersection_).vertexIndex_)
+          && (position_ == other.position_);
   }
 
     //! prefix increment
     void increment() {
-        if(GridImp::getRealImplementation(intersection_).edgeIndex_==
-           GridImp::getRealImplementation(intersection_).center_->corners())
-        {
+        FoamGridLevelIntersection<GridImp>& intersection = GridImp::getRealImplementation(intersection_);
+
+        if (intersection.vertexIndex_ == 2)
             // This is already the end iterator
-            GridImp::getRealImplementation(intersection_).neighborIndex_=0;
             return;
-        }
-        if(GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.size()==1)
-        {
-            // This was a boundary intersection.
-            ++GridImp::getRealImplementation(intersection_).edgeIndex_;
-            if(GridImp::getRealImplementation(intersection_).edgeIndex_ < GridImp::getRealImplementation(intersection_).center_->corners()){
-                // There is another edge, initialize neighbor_ iterator.
-                GridImp::getRealImplementation(intersection_).neighbor_=GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.begin();
-                GridImp::getRealImplementation(intersection_).neighborIndex_=0;
-            }
-        }else
-        {
-            // Move to the next intersection of this edge
-            ++GridImp::getRealImplementation(intersection_).neighborIndex_;
-            ++GridImp::getRealImplementation(intersection_).neighbor_;
-        }
 
-        // Search for the first intersection.
-        // An intersection has either two neighbor elements on the same level
-        // or is a boundary intersection
-        while(GridImp::getRealImplementation(intersection_).edgeIndex_ != GridImp::getRealImplementation(intersection_).center_->corners()) // still a valid edge
+        // There is one intersection per neighbor, but at least one per vertex
+        if (++position_ < span_.size()-1)
         {
-            if(GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.size()==1)
-            {
-                // This is a boundary intersection.
-                GridImp::getRealImplementation(intersection_).neighborIndex_
-                    =GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.size();
-                return;
-            }
-
-            while(GridImp::getRealImplementation(intersection_).neighbor_!=GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.end() &&
-                  (GridImp::getRealImplementation(intersection_).center_==*GridImp::getRealImplementation(intersection_).neighbor_
-                   ||GridImp::getRealImplementation(intersection_).center_->level()!=(*GridImp::getRealImplementation(intersection_).neighbor_)->level()))
-            {
-                // Wrong level or neighbor points to center. In both cases this intersection is invalid.
-                ++GridImp::getRealImplementation(intersection_).neighborIndex_;
-                ++GridImp::getRealImplementation(intersection_).neighbor_;
-            }
-            if(GridImp::getRealImplementation(intersection_).neighbor_==
-               GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.end())
-            {
-                if(GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.size()==1)
-                {
-                    // This is a boundary intersection.
-                    GridImp::getRealImplementation(intersection_).neighborIndex_=
-                        GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.size();
-                    return;
-                }
-                else
-                {
-                    // No valid intersection found on this edge, move to next edge.
-                    ++GridImp::getRealImplementation(intersection_).edgeIndex_;
-                    if(GridImp::getRealImplementation(intersection_).edgeIndex_ < GridImp::getRealImplementation(intersection_).center_->corners())
-                    {
-                        // There is another edge, initialize neighbor_ iterator.
-                        GridImp::getRealImplementation(intersection_).neighbor_=GridImp::getRealImplementation(intersection_).center_->edges_[GridImp::getRealImplementation(intersection_).edgeIndex_]->elements_.begin();
-                        GridImp::getRealImplementation(intersection_).neighborIndex_=0;
-                    }
-                }
-            }else
-                // intersection with another element found!
-                break;
+            updateNeighbor();
+            return;
         }
-        if(GridImp::getRealImplementation(intersection_).edgeIndex_==
-           GridImp::getRealImplementation(intersection_).center_->corners())
-        {
+
+        position_ = 0;
+        if (++intersection.vertexIndex_ == 2)
             // This is the end iterator
-            GridImp::getRealImplementation(intersection_).neighborIndex_=0;
-        }
+            return;
+
+        collectNeighbors();
+        updateNeighbor();
     }
 
 
@@ -371,6 +311,30 @@ public:
         return intersection_;
     }
 private:
+
+    /** \brief Look up the elements of the level at the current vertex */
+    void collectNeighbors()
+    {
+        FoamGridLevelIntersection<GridImp>& intersection = GridImp::getRealImplementation(intersection_);
+        const Element* center = intersection.center_;
+        const int i = intersection.vertexIndex_;
+
+        span_ = center->vertex_[i]->elements();
+        skip_ = std::find(span_.begin(), span_.end(), center) - span_.begin();
+
+        // A vertex that has only one element on this level may still have
+        // neighbors on coarser levels
+        intersection.boundary_ = (span_.size() == 1)
+            && FoamGridVertexCopies<dimworld,ctype>::coarsest(center, i)->nElements_ == 1;
+    }
+
+    /** \brief Point the intersection to the neighbor at position_ */
+    void updateNeighbor()
+    {
+        GridImp::getRealImplementation(intersection_).neighbor_
+            = (position_ < span_.size()-1) ? span_[(position_ < skip_) ? position_ : position_+1] : nullptr;
+    }
+
   //**********************************************************
   //  private data
   //**********************************************************
@@ -379,6 +343,15 @@ private:
     */
     mutable MakeableInterfaceObject<Intersection> intersection_;
 
+    //! \brief Number of the current intersection at the current vertex
+    unsigned int position_;
+
+    //! \brief The elements of the level at the current vertex
+    FoamGridElementSpan<Element> span_;
+
+    //! \brief Position of the center in span_
+    unsigned int skip_;
+
 };
 
 
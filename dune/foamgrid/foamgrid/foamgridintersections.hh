@@ -23,6 +23,9 @@ class FoamGridLevelIntersectionIterator;
 //! \brief Base class of all intersections within FoamGrid
 //!
 //! encapsulates common functionality of level and leaf intersections.
+//! An intersection of a one-dimensional grid is a vertex of the inside
+//! element, shared with one neighbor.  At a junction of n segments each
+//! segment has n-1 intersections on the same vertex, one per neighbor.
 template<class GridImp>
 class FoamGridIntersection
 {
@@ -43,17 +46,18 @@ class FoamGridIntersection
         typedef typename GridImp::template Codim<0>::EntityPointer EntityPointer;
         typedef typename GridImp::template Codim<0>::Entity Entity;
 
+        typedef typename GridImp::template Codim<1>::Geometry Geometry;
+        typedef typename GridImp::template Codim<1>::LocalGeometry LocalGeometry;
+
     /**
      * \brief Initalizes an intersection.
      *
-     * After initialization this object always represents the first intersection
-     * related to an edge.
-     * \param edge The index of the edge this intersection lives on.
+     * \param center The element the intersection belongs to
+     * \param vertex The local index of the vertex this intersection lives on.
      */
-
-    FoamGridIntersection(const FoamGridEntityImp<1,dimworld>* center,
-				  int vertex)
-        : center_(center), vertexIndex_(vertex)
+    FoamGridIntersection(const FoamGridEntityImp<1,dimworld,ctype>* center,
+                         int vertex)
+        : center_(center), vertexIndex_(vertex), neighbor_(nullptr), boundary_(false)
     {
     }
 
@@ -66,22 +70,26 @@ class FoamGridIntersection
 
         //! return EntityPointer to the Entity on the outside of this intersection
         //! (that is the neighboring Entity)
-        EntityPointer outside(int id=0) const {
-            // Return the 'other' element on the current vertex
-            return FoamGridEntityPointer<0,GridImp> (*(neighbors_[id]));
+        EntityPointer outside() const {
+            assert(neighbor_);
+            return FoamGridEntityPointer<0,GridImp> (neighbor_);
         }
 
 
     /** \brief return true if intersection is with boundary.
     */
     bool boundary () const {
-	return center_->vertex_[vertexIndex_]->elements_.size()==1;
+        return boundary_;
     }
 
-    /** \brief return the number of neighbors
-     */
-    int NumOfNeighbors () const {
-      return center_->vertex_[vertexIndex_]->elements_.size();
+    //! return true if across the vertex a neighbor exists
+    bool neighbor () const {
+        return neighbor_ != nullptr;
+    }
+
+    //! return information about the Boundary
+    int boundaryId () const {
+        return boundarySegmentIndex();
     }
 
     //! return information about the Boundary
@@ -94,23 +102,44 @@ class FoamGridIntersection
         return GeometryType(GeometryType::simplex, dim-1);
     }
 
-         //! local number of the intersection in the edge that was given in the constructor
+         //! local number of the intersection in the element that was given in the constructor
         int indexInInside () const {
             return vertexIndex_;
         }
 
-        virtual int indexInOutside() const=0;
+        //! local number of the intersection in the neighbor
+        int indexInOutside () const {
+            assert(neighbor_);
+            // All copies of a vertex on different levels share the id
+            return (neighbor_->vertex_[0]->id_ == center_->vertex_[vertexIndex_]->id_) ? 0 : 1;
+        }
+
+        //! the intersection in global coordinates
+        Geometry geometry () const {
+            return Geometry(FoamGridGeometry<dim-1, dimworld, GridImp>(center_->vertex_[vertexIndex_]->pos_));
+        }
+
+        //! the intersection in local coordinates of the inside element
+        LocalGeometry geometryInInside () const {
+            return LocalGeometry(FoamGridGeometry<dim-1, dim, GridImp>(FieldVector<ctype, dim>(vertexIndex_)));
+        }
 
-        //! return outer normal
+        //! the intersection in local coordinates of the outside element
+        LocalGeometry geometryInOutside () const {
+            return LocalGeometry(FoamGridGeometry<dim-1, dim, GridImp>(FieldVector<ctype, dim>(indexInOutside())));
+        }
+
+        //! return outer normal, i.e. the unit tangent of the inside element pointing out of it
         FieldVector<ctype, dimworld> outerNormal (const FieldVector<ctype, dim-1>& local) const {
 
-	    FieldVector<ctype, dimworld> edge = center_->vertex_[vertexIndex_]->pos - center_->vertexIndex_[1-vertexIndex_]->pos;
-	    FieldVector<ctype, dimworld> normal = edge /= edge.two_norm;
+            FieldVector<ctype, dimworld> normal = center_->vertex_[vertexIndex_]->pos_;
+            normal -= center_->vertex_[1-vertexIndex_]->pos_;
+            normal /= normal.two_norm();
 
             return normal;
        }
 
-        //! return outer normal multiplied by the integration element
+        //! return outer normal multiplied by the integration element, which is 1 for a vertex
         FieldVector<ctype, dimworld> integrationOuterNormal (const FieldVector<ctype, dim-1>& local) const {
 
             return this->outerNormal(local);
@@ -125,24 +154,22 @@ class FoamGridIntersection
         //! return unit outer normal at the intersection center
         FieldVector<ctype, dimworld> centerUnitOuterNormal () const {
 
-            return this->unitOuterNormal(FieldVector<ctype,0>(0.5));
+            return this->unitOuterNormal(FieldVector<ctype, dim-1>());
 
         }
-    private:
-
-    //! vector storing the outer normal
-    mutable FieldVector<typename GridImp::ctype, dimworld> outerNormal_;
 
     protected:
 
-    const FoamGridEntityImp<1,dimworld>* center_;
-
-    /** \brief Count on which vertex we are lookin' at.  */
+    const FoamGridEntityImp<1,dimworld,ctype>* center_;
 
+    /** \brief Local index of the vertex we are looking at.  */
     int vertexIndex_;
 
-    /** \brief Iterator to the neighbors of the intersection. */
-    std::vector<typename std::vector<const FoamGridEntityImp<1,dimworld>*>::const_iterator > neighbors_;
+    /** \brief The neighbor across the vertex, nullptr if there is none */
+    const FoamGridEntityImp<1,dimworld,ctype>* neighbor_;
+
+    /** \brief Whether the vertex is on the domain boundary */
+    bool boundary_;
 
 };
 
@@ -152,15 +179,11 @@ class FoamGridLevelIntersection
 {
     friend class FoamGridLevelIntersectionIterator<GridImp>;
 
-    enum {dim=GridImp::dimension};
-
-    typedef typename GridImp::template Codim<1>::Geometry Geometry;
-    typedef typename GridImp::template Codim<1>::LocalGeometry LocalGeometry;
-
 public:
     enum{ dimworld = GridImp::dimensionworld };
+    typedef typename GridImp::ctype ctype;
 
-    FoamGridLevelIntersection(const FoamGridEntityImp<1,dimworld>* center, int vertex)
+    FoamGridLevelIntersection(const FoamGridEntityImp<1,dimworld,ctype>* center, int vertex)
                               : FoamGridIntersection<GridImp>(center, vertex)
     {}
 
@@ -170,90 +193,16 @@ public:
         return true;
     }
 
-    //! local number of codim 1 entity in neighbor where intersection is contained
-//     int indexInOutside (int id=0) const {
-//         assert(this->center_->vertex_[this->vertexIndex_]->elements_.size()>=2);
-//         assert(this->neighborIndex_!=this->center_->vertex_[this->vertexIndex_]->elements_.size());
-//
-//         return std::find((*this->neighbors_[id])->vertex_.begin(), (*this->neighbors_[id])->vertex_.end(),
-//                          this->center_->vertex_[this->vertexIndex_])
-//             - (*this->neighbors_[id])->vertex_.begin();
-//     }
-
-    //! return true if across the edge an neighbor on this level exists
-//     bool neighbor () const {
-//       return this->neighborIndex_!=this->center_->vertex_[this->vertexIndex_]->elements_.size();
-//     }
-
-    //! intersection of codimension 1 of this neighbor with element where
-    //! iteration started.
-    //! Here returned element is in LOCAL coordinates of the element
-    //! where iteration started.
-//     LocalGeometry geometryInInside () const {
-//
-//       std::vector<FieldVector<double, dim> > coordinates(1);
-//
-//       coordinates[0] = this->VertexIndex_;
-//
-//
-//       return LocalGeometry(FoamGridGeometry<dim-1, dim, GridImp>(this->type(), coordinates));
-//     }
-
-    //! intersection of codimension 1 of this neighbor with element where iteration started.
-    //! Here returned element is in LOCAL coordinates of neighbor
-    //! In the LevelIntersection we know that the intersection is conforming
-//     LocalGeometry geometryInOutside () const {
-//
-//     // Get two vertices of the intersection
-//     const Dune::ReferenceElement<double,dim>& refElement
-//         = Dune::ReferenceElements<double, dim>::general(this->center_->type());
-//
-//     std::array<FoamGridEntityImp<0,dimworld>*, 2> vtx;
-//
-//     vtx[0] = this->center_->vertex_[refElement.subEntity(this->edgeIndex_, 1, 0, dim)];
-//     vtx[1] = this->center_->vertex_[refElement.subEntity(this->edgeIndex_, 1, 1, dim)];
-//
-//     std::vector<FieldVector<double, dim> > coordinates(2);
-//
-//     // Find the intersection vertices in local numbering of the outside element
-//     // That way we get the local orientation correctly.
-//     const Dune::ReferenceElement<double,dim>& refElementOther
-//         = Dune::ReferenceElements<double, dim>::general((*this->neighbor_)->type());
-//
-//     for (int i=0; i<refElementOther.size(dim); i++)
-//       for (int j=0; j<2; j++)
-//         if (vtx[j] == (*this->neighbor_)->vertex_[refElementOther.subEntity(0,0,i,dim)])
-//           coordinates[j] = refElement.position(refElement.subEntity(0,0, i, dim),dim);
-//
-//     return LocalGeometry(FoamGridGeometry<dim-1, dim, GridImp>(this->type(), coordinates));
-//   }
-
-  //! intersection of codimension 1 of this neighbor with element where iteration started.
-  //! Here returned element is in GLOBAL coordinates of the element where iteration started.
-//   Geometry geometry () const {
-//
-//     std::vector<FieldVector<double, dimworld> > coordinates(1);;
-//     coordinates[0] = this->center_->vertex_[this->VertexIndex_]->pos_;
-//
-//     return Geometry(FoamGridGeometry<dim-1, dimworld, GridImp>(this->type(), coordinates));
-//   }
-
-
-    private:
-    int neighborIndex_;
-
 };
 
 
 
 
-/** \brief Iterator over all element neighbors
+/** \brief Intersection between leaf elements
 * \ingroup FoamGrid
-* Mesh entities of codimension 0 ("elements") allow to visit all neighbors, where
-* a neighbor is an entity of codimension 0 which has a common entity of codimension 1
-* These neighbors are accessed via a IntersectionIterator. This allows the implement
-* non-matching meshes. The number of neighbors may be different from the number
-* of an element!
+*
+* The neighbor may live on a coarser or a finer level than the inside element.
+* Since an intersection is a single point, it is still conforming.
 */
 template<class GridImp>
 class FoamGridLeafIntersection
@@ -264,92 +213,19 @@ class FoamGridLeafIntersection
 public:
 
     enum {dimworld=GridImp::dimensionworld};
-
-    enum {dim=GridImp::dimension};
-
     typedef typename GridImp::ctype ctype;
 
-    typedef typename GridImp::template Codim<1>::Geometry Geometry;
-    typedef typename GridImp::template Codim<1>::LocalGeometry LocalGeometry;
-
-    FoamGridLeafIntersection(const FoamGridEntityImp<1,FoamGridIntersection<GridImp>::dimworld>* center,
+    FoamGridLeafIntersection(const FoamGridEntityImp<1,dimworld,ctype>* center,
                              int vertex)
         : FoamGridIntersection<GridImp>(center, vertex)
     {}
 
     //! Return true if this is a conforming intersection
     bool conforming () const {
-        DUNE_THROW(Dune::NotImplemented, "FoamGridLeafIntersection::conforming");
-    }
-
-    //! local number of the intersection in the neighbor
-//     int indexInOutside (int id=0) const {
-//         assert(this->neighbors_[id]!=neighborEnd_);
-//         // Move to the father of the edge until its level is the same as
-//         // the level of the neighbor
-//         FoamGridEntityImp<1,dimworld>* edge=this->center_;
-//
-//         while(edge->level()<(*this->neighbors_[id])->level())
-//         {
-//             assert(edge->father_!=nullptr);
-//             edge=edge->father_;
-//         }
-//
-//         assert(edge->level()==(*this->neighbors_[id])->level());
-//         assert(edge->elements_.size()>=2);
-//         return std::find((*this->neighbors_[id])->vertex_.begin(), (*this->neighbors_[id])->vertex_.end(), edge)
-//             - (*this->neighbors_[id])->vertex_.begin();
-//
-//     }
-
-    Geometry geometry () const {
-      DUNE_THROW(Dune::NotImplemented, "FoamGridLeafIntersection::geometry()");
+        // Intersections of a one-dimensional grid are points
+        return true;
     }
 
-    //! intersection of codimension 1 of this neighbor with element where
-    //! iteration started.
-    //! Here returned element is in LOCAL coordinates of the element
-    //! where iteration started.
-//     LocalGeometry geometryInInside () const {
-//
-//         std::vector<FieldVector<double, dim> > coordinates(1);
-//
-//         coordinates[0]=this->center_->vertex_[this->vertexIndex_]->pos_;
-//
-//         return LocalGeometry(FoamGridGeometry<dim-1, dim, GridImp>(this->type(), coordinates));
-//     }
-
-    //! intersection of codimension 1 of this neighbor with element where
-    //! iteration started.
-    //! Here returned element is in LOCAL coordinates of the element
-    //! where iteration started.
-//     LocalGeometry geometryInOutside () const {
-//         /*
-//         if(edgePointer_.level()==(*this->neighbor_)->level())
-//             return FoamGridIntersection<GridImp>::geometryInOutside();
-//         */
-//         std::vector<FieldVector<double, dim> > coordinates(2);
-//
-//         coordinates[0]=(*this->neighbor_)->globalToLocal(edgePointer_->vertex_[0]->pos_);
-//
-//         return LocalGeometry(FoamGridGeometry<dim-1, dim, GridImp>(this->type(), coordinates));
-//     }
-
-     //! return outer normal multiplied by the integration element
-//         FieldVector<ctype, dimworld> integrationOuterNormal (const FieldVector<ctype, dim-1>& local) const {
-//             ctype edgeLength = (edgePointer_->vertex_[0]->pos_ - edgePointer_->vertex_[1]->pos_).two_norm();
-//             FieldVector<ctype, dimworld> normal = this->unitOuterNormal(local);
-//             normal *= edgeLength;
-//             return normal;
-//         }
-    //! return true if across the edge an neighbor on this level exists
-    bool neighbor (int id=0) const {
-        return this->neighbors_[id]!=neighborEnd_;
-    }
-private:
-    FoamGridEntityImp<1,dimworld>* edgePointer_;
-    /** \brief Iterator to the other neighbor of the intersection. */
-    typename std::vector<const FoamGridEntityImp<1,dimworld>*>::const_iterator neighborEnd_;
 };
 
 
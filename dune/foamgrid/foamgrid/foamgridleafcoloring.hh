@@ -0,0 +1,160 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#ifndef DUNE_FOAMGRID_LEAFCOLORING_HH
+#define DUNE_FOAMGRID_LEAFCOLORING_HH
+
+/** \file
+* \brief The FoamGridLeafColoring class
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace Dune {
+
+    /** \brief Coloring of the leaf elements such that no two elements of a color share a vertex
+     *
+     * All elements of one color can be assembled concurrently into vertex based data
+     * without locks.  The coloring is greedy: the elements are visited in leaf index
+     * order and each gets the smallest color not used at any of its vertices.  This
+     * needs at most 2*d-1 colors for a maximal vertex degree d, i.e. a handful for
+     * typical networks.
+     *
+     * For each color the elements are stored in one contiguous array, and begin() and
+     * end() iterate over it.  Within a color the elements keep their leaf index order.
+     *
+     * The coloring refers to the current leaf grid, it has to be computed anew
+     * after the grid has been adapted.
+     *
+     * \tparam GridView A leaf grid view of a FoamGrid
+     */
+    template <class GridView>
+    class FoamGridLeafColoring
+    {
+        typedef typename GridView::Grid Grid;
+
+        enum {dimworld = Grid::dimensionworld};
+        typedef typename Grid::ctype ctype;
+
+        typedef FoamGridEntityImp<1,dimworld,ctype> Element;
+
+    public:
+
+        typedef typename GridView::template Codim<0>::Iterator Iterator;
+
+        /** \brief Color the leaf elements of a view */
+        explicit FoamGridLeafColoring(const GridView& gridView)
+        {
+            const std::vector<const Element*>& elements
+                = Dune::get<1>(gridView.grid().leafIndexSet().leafEntities_);
+            const std::size_t numVertices = gridView.grid().leafIndexSet().size(1);
+
+            // The maximal number of colors is bounded by the vertex degree
+            std::vector<unsigned int> degree(numVertices, 0);
+            for (std::size_t e=0; e<elements.size(); e++)
+                for (int i=0; i<2; i++)
+                    ++degree[elements[e]->vertex_[i]->leafIndex_];
+
+            unsigned int maxDegree = 1;
+            for (std::size_t v=0; v<numVertices; v++)
+                maxDegree = std::max(maxDegree, degree[v]);
+
+            // One bit per color for every vertex: whether an element at the vertex has it
+            const std::size_t words = (2*maxDegree-1 + 63) / 64;
+            std::vector<unsigned long long> used(numVertices*words, 0);
+
+            colors_.resize(elements.size());
+            unsigned int numColors = 0;
+            for (std::size_t e=0; e<elements.size(); e++) {
+                const std::size_t v0 = elements[e]->vertex_[0]->leafIndex_ * words;
+                const std::size_t v1 = elements[e]->vertex_[1]->leafIndex_ * words;
+
+                unsigned int color = 0;
+                for (std::size_t w=0; w<words; w++) {
+                    const unsigned long long free = ~(used[v0+w] | used[v1+w]);
+                    if (free) {
+                        color = 64*w + lowestBit(free);
+                        break;
+                    }
+                }
+
+                const unsigned long long bit = 1ull << (color % 64);
+                used[v0 + color/64] |= bit;
+                used[v1 + color/64] |= bit;
+
+                colors_[e] = color;
+                numColors = std::max(numColors, color+1);
+            }
+
+            // Group the elements by color, keeping their order
+            offsets_.assign(numColors+1, 0);
+            for (std::size_t e=0; e<elements.size(); e++)
+                ++offsets_[colors_[e]+1];
+            for (unsigned int c=0; c<numColors; c++)
+                offsets_[c+1] += offsets_[c];
+
+            elements_.resize(elements.size());
+            std::vector<unsigned int> position(offsets_.begin(), offsets_.end()-1);
+            for (std::size_t e=0; e<elements.size(); e++)
+                elements_[position[colors_[e]]++] = elements[e];
+        }
+
+        /** \brief The number of colors */
+        unsigned int numColors() const {
+            return offsets_.empty() ? 0 : offsets_.size()-1;
+        }
+
+        /** \brief The color of the element with the given leaf index */
+        unsigned int color(std::size_t leafIndex) const {
+            return colors_[leafIndex];
+        }
+
+        /** \brief The number of elements of a color */
+        std::size_t size(unsigned int color) const {
+            return offsets_[color+1] - offsets_[color];
+        }
+
+        /** \brief Iterator to the first element of a color */
+        Iterator begin(unsigned int color) const
+        {
+            typedef typename Iterator::Implementation IteratorImp;
+            if (size(color) == 0)
+                return end(color);
+            const Element* const* first = &elements_[0];
+            return Iterator(IteratorImp(first + offsets_[color], first + offsets_[color+1]));
+        }
+
+        /** \brief Iterator one past the last element of a color */
+        Iterator end(unsigned int color) const
+        {
+            typedef typename Iterator::Implementation IteratorImp;
+            return Iterator(IteratorImp());
+        }
+
+    private:
+
+        /** \brief Position of the lowest set bit of a nonzero word */
+        static unsigned int lowestBit(unsigned long long word)
+        {
+            unsigned int bit = 0;
+            while (!(word & 1ull)) {
+                word >>= 1;
+                ++bit;
+            }
+            return bit;
+        }
+
+        /** \brief The color of each element, by leaf index */
+        std::vector<unsigned int> colors_;
+
+        /** \brief Where the elements of each color begin in elements_, and the end */
+        std::vector<unsigned int> offsets_;
+
+        /** \brief The leaf elements, grouped by color */
+        std::vector<const Element*> elements_;
+    };
+
+}  // namespace Dune
+
+#endif
@@ -0,0 +1,239 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#ifndef DUNE_FOAMGRID_LEAFINDEXMAP_HH
+#define DUNE_FOAMGRID_LEAFINDEXMAP_HH
+
+/** \file
+* \brief The FoamGridLeafIndexMap class
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/array.hh>
+
+namespace Dune {
+
+    template <class GridImp>
+    class FoamGridLeafIndexSet;
+
+    /** \brief Where the leaf entities after the last call to adapt() come from
+     *
+     * For every new leaf index of a vertex or an element, the map tells which
+     * entities of the old leaf grid it corresponds to.  Data attached to the
+     * old leaf grid can therefore be carried over in one linear pass over the
+     * new indices, see transferElementData() and transferVertexData().
+     *
+     * An element either was a leaf before (kept), is a son of an old leaf
+     * element (refined), or is the father of two old leaf elements (coarsened).
+     * A vertex either was a leaf vertex before (kept), possibly as a copy on
+     * another level, or is the midpoint of two old leaf vertices (created).
+     *
+     * FoamGrid::grow() records the map as well.  Entities it inserts have no
+     * origin in the old leaf grid (inserted), and the ones it removes are absent.
+     *
+     * \tparam dim The grid dimension
+     */
+    template <int dim>
+    class FoamGridLeafIndexMap
+    {
+        template <class GridImp>
+        friend class FoamGridLeafIndexSet;
+
+    public:
+
+        enum Origin { kept, refined, coarsened, created, inserted };
+
+        /** \brief The origin of one new leaf entity */
+        struct Entry
+        {
+            /** \brief The old leaf indices the entity is computed from
+             *
+             * Both are the same for kept entities and for sons.  For a coarsened
+             * element these are its sons 0 and 1, for a created vertex the end
+             * points of the segment it bisects.  For an inserted entity both hold
+             * the number returned by FoamGrid::insertVertex() or insertElement().
+             */
+            array<unsigned int,2> oldIndex;
+
+            /** \brief How the entity relates to the old leaf entities, an Origin */
+            unsigned char origin;
+
+            /** \brief For a refined element, the number of the son (0 or 1) */
+            unsigned char childNumber;
+        };
+
+        FoamGridLeafIndexMap()
+            : valid_(false), topologyChanged_(false), generation_(0), oldGeneration_(0)
+        {
+            oldSize_.fill(0);
+        }
+
+        /** \brief Whether the map describes the last change of the leaf indices
+         *
+         * The map is recorded by adapt(), grow() and flatten().  Any other way of
+         * changing the leaf indices, including globalRefine(), invalidates it.
+         */
+        bool valid() const {
+            return valid_;
+        }
+
+        /** \brief A number identifying the current leaf grid
+         *
+         * It changes with every change of the leaf indices, whether the map records
+         * it or not.  Data attached to the leaf grid can remember it, and later check
+         * with oldGeneration() whether the map starts from the leaf grid it belongs to.
+         */
+        unsigned long generation() const {
+            return generation_;
+        }
+
+        /** \brief The generation() of the leaf grid the recorded changes start from */
+        unsigned long oldGeneration() const {
+            return oldGeneration_;
+        }
+
+        /** \brief Whether entities were inserted or removed, rather than only bisected or merged */
+        bool topologyChanged() const {
+            return topologyChanged_;
+        }
+
+        /** \brief Number of leaf entities of given codim after the adaptation */
+        std::size_t size(int codim) const {
+            return entries_[dim-codim].size();
+        }
+
+        /** \brief Number of leaf entities of given codim before the adaptation */
+        std::size_t oldSize(int codim) const {
+            return oldSize_[dim-codim];
+        }
+
+        /** \brief Bytes allocated for the entries */
+        std::size_t memoryUsage() const
+        {
+            std::size_t result = 0;
+            for (int i=0; i<=dim; i++)
+                result += entries_[i].capacity()*sizeof(Entry);
+            return result;
+        }
+
+        /** \brief The origin of the element with the given new leaf index */
+        const Entry& element(std::size_t newIndex) const {
+            assert(valid_);
+            return entries_[dim][newIndex];
+        }
+
+        /** \brief The origin of the vertex with the given new leaf index */
+        const Entry& vertex(std::size_t newIndex) const {
+            assert(valid_);
+            return entries_[0][newIndex];
+        }
+
+        /** \brief Carry data attached to the leaf elements over to the new leaf grid
+         *
+         * Sons get the value of their father, coarsened elements the mean of their
+         * sons, inserted elements a default constructed value.  Thus the value type
+         * needs to support += and *= double.
+         *
+         * \param oldData Values indexed by the old leaf indices
+         * \param newData Resized and filled with values indexed by the new leaf indices
+         */
+        template <class Vector>
+        void transferElementData(const Vector& oldData, Vector& newData) const
+        {
+            transfer(entries_[dim], coarsened, oldData, newData);
+        }
+
+        /** \brief Carry data attached to the leaf vertices over to the new leaf grid
+         *
+         * New midpoints get the mean of the end points of the old segment, which
+         * is the linear interpolation for bisected elements, inserted vertices a
+         * default constructed value.  Thus the value type needs to support += and
+         * *= double.
+         *
+         * \param oldData Values indexed by the old leaf indices
+         * \param newData Resized and filled with values indexed by the new leaf indices
+         */
+        template <class Vector>
+        void transferVertexData(const Vector& oldData, Vector& newData) const
+        {
+            transfer(entries_[0], created, oldData, newData);
+        }
+
+    private:
+
+        /** \brief Start a new adaptation step, in which every entity is kept */
+        void reset(const array<int,dim+1>& size)
+        {
+            for (int i=0; i<=dim; i++) {
+                oldSize_[i] = size[i];
+                entries_[i].resize(size[i]);
+                for (std::size_t k=0; k<entries_[i].size(); k++)
+                    entries_[i][k] = makeEntry(k, k, kept);
+            }
+            valid_ = true;
+            topologyChanged_ = false;
+            oldGeneration_ = generation_++;
+        }
+
+        /** \brief Forget the recorded changes */
+        void invalidate()
+        {
+            for (int i=0; i<=dim; i++)
+                entries_[i].clear();
+            valid_ = false;
+            topologyChanged_ = false;
+            oldGeneration_ = generation_++;
+        }
+
+        static Entry makeEntry(unsigned int oldIndex0, unsigned int oldIndex1,
+                               Origin origin, unsigned char childNumber = 0)
+        {
+            Entry entry;
+            entry.oldIndex[0] = oldIndex0;
+            entry.oldIndex[1] = oldIndex1;
+            entry.origin = origin;
+            entry.childNumber = childNumber;
+            return entry;
+        }
+
+        /** \brief Copy the values, take the mean for the entries with the given origin */
+        template <class Vector>
+        void transfer(const std::vector<Entry>& entries, Origin mean,
+                      const Vector& oldData, Vector& newData) const
+        {
+            assert(valid_);
+            newData.resize(entries.size());
+            for (std::size_t i=0; i<entries.size(); i++) {
+                if (entries[i].origin == inserted) {
+                    newData[i] = typename Vector::value_type();
+                    continue;
+                }
+                newData[i] = oldData[entries[i].oldIndex[0]];
+                if (entries[i].origin == mean) {
+                    newData[i] += oldData[entries[i].oldIndex[1]];
+                    newData[i] *= 0.5;
+                }
+            }
+        }
+
+        /** \brief The entries of each dimension, ordered by the new leaf index */
+        array<std::vector<Entry>, dim+1> entries_;
+
+        /** \brief The number of leaf entities of each dimension before the adaptation */
+        array<std::size_t, dim+1> oldSize_;
+
+        bool valid_;
+
+        /** \brief Whether grow() inserted or removed entities */
+        bool topologyChanged_;
+
+        /** \brief The numbers of the current and of the previous leaf grid */
+        unsigned long generation_;
+        unsigned long oldGeneration_;
+    };
+
+}  // namespace Dune
+
+#endif
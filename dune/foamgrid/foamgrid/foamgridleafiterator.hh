@@ -5,11 +5,19 @@
 * \brief The FoamGridLeafIterator class
 */
 
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
 namespace Dune {
 
 
-/** \brief Iterator over all entities of a given codimension and level of a grid.
+/** \brief Iterator over all leaf entities of a given codimension of a grid.
 *  \ingroup FoamGrid
+*
+*  The leaf index set keeps an array of the leaf entities ordered by leaf index.
+*  This iterator simply walks over that array, hence it never visits entities that
+*  are not leaf entities.
 */
 template<int codim, PartitionIteratorType pitype, class GridImp>
 class FoamGridLeafIterator :
@@ -17,78 +25,83 @@ class FoamGridLeafIterator :
 {
     enum {dim      = GridImp::dimension};
     enum {dimworld = GridImp::dimensionworld};
+    typedef typename GridImp::ctype ctype;
+
+    typedef FoamGridEntityImp<dim-codim,dimworld,ctype> EntityImp;
 
 public:
 
     FoamGridLeafIterator(const GridImp& grid)
-        : FoamGridEntityPointer <codim,GridImp>(nullptr),
-          grid_(&grid)
+        : FoamGridEntityPointer <codim,GridImp>(nullptr)
     {
+        const std::vector<const EntityImp*>& entities
+            = Dune::get<dim-codim>(grid.leafIndexSet().leafEntities_);
 
-        /** \todo Can a make the fullRefineLevel work somehow? */
-        const int fullRefineLevel = 0;
+        current_ = entities.empty() ? nullptr : &entities[0];
+        end_     = current_ + entities.size();
 
-        const std::list<FoamGridEntityImp<dim-codim,dimworld> >& entities = Dune::get<dim-codim>(grid_->entityImps_[fullRefineLevel]);
-        // The &* turns an iterator into a plain pointer
-        GridImp::getRealImplementation(this->virtualEntity_).setToTarget(&*entities.begin());
-        levelIterator_ = entities.begin();
+        if (current_ != end_)
+            GridImp::getRealImplementation(this->virtualEntity_).setToTarget(*current_);
+    }
+
+    /** \brief Iterate over the leaf entities with leaf indices in [begin, end)
+     *
+     * The matching end iterator is the default-constructed one.
+     */
+    FoamGridLeafIterator(const GridImp& grid, std::size_t begin, std::size_t end)
+        : FoamGridEntityPointer <codim,GridImp>(nullptr)
+    {
+        const std::vector<const EntityImp*>& entities
+            = Dune::get<dim-codim>(grid.leafIndexSet().leafEntities_);
+        assert(begin <= end && end <= entities.size());
 
-        if (!GridImp::getRealImplementation(this->virtualEntity_).target_->isLeaf())
-            increment();
+        current_ = (begin == end) ? nullptr : &entities[0] + begin;
+        end_     = (begin == end) ? nullptr : &entities[0] + end;
+
+        if (current_ != end_)
+            GridImp::getRealImplementation(this->virtualEntity_).setToTarget(*current_);
+    }
+
+    /** \brief Iterate over an array of leaf entities other than the one of the index set
+     *
+     * The array must stay alive and unchanged during the traversal.  The matching
+     * end iterator is the default-constructed one.
+     */
+    FoamGridLeafIterator(const EntityImp* const* begin, const EntityImp* const* end)
+        : FoamGridEntityPointer <codim,GridImp>(nullptr),
+          current_(begin),
+          end_(end)
+    {
+        if (current_ != end_)
+            GridImp::getRealImplementation(this->virtualEntity_).setToTarget(*current_);
     }
 
   //! Constructor
     FoamGridLeafIterator()
         : FoamGridEntityPointer <codim,GridImp>(nullptr),
-          grid_(nullptr)
+          current_(nullptr),
+          end_(nullptr)
     {}
 
     //! prefix increment
     void increment() {
-        // Increment until you find a leaf entity
-        do {
-            globalIncrement();
-
-        } while (levelIterator_!=Dune::get<dim-codim>(grid_->entityImps_[grid_->maxLevel()]).end()
-                 && !GridImp::getRealImplementation(this->virtualEntity_).target_->isLeaf());
+        ++current_;
+        GridImp::getRealImplementation(this->virtualEntity_).setToTarget((current_ != end_) ? *current_ : nullptr);
     }
 
 private:
 
-    /** \brief This increment makes the iterator wander over all entities on all levels */
-    void globalIncrement() {
-
-        // Backup current level because it may not be accessible anymore after
-        // setting the pointer to the next entity.
-        const int oldLevel = this->virtualEntity_.level();
-
-        // Increment on this level
-        ++levelIterator_;
-        GridImp::getRealImplementation(this->virtualEntity_).setToTarget(&(*levelIterator_));
-        if (levelIterator_==Dune::get<dim-codim>(grid_->entityImps_[oldLevel]).end())
-            GridImp::getRealImplementation(this->virtualEntity_).setToTarget(nullptr);
-
-        // If beyond the end of this level set to first of next level
-        if (levelIterator_==Dune::get<dim-codim>(grid_->entityImps_[oldLevel]).end() && oldLevel < grid_->maxLevel()) {
-
-            const std::list<FoamGridEntityImp<dim-codim,dimworld> >& entities = Dune::get<dim-codim>(grid_->entityImps_[oldLevel+1]);
-            levelIterator_ = entities.begin();
-            GridImp::getRealImplementation(this->virtualEntity_).setToTarget(&*entities.begin());
-
-        }
-
-    }
-
     // /////////////////////////////////////
     //   Data members
     // /////////////////////////////////////
-    const GridImp* grid_;
 
     // This iterator derives from FoamGridEntityPointer, and that base class stores the value
-    // of the iterator, i.e. the 'pointer' to the entity.  However, that pointer can not be
-    // set to its successor in the level std::list, not even by magic.  Therefore we keep the
-    // same information redundantly in this iterator, which can be incremented.
-    typename std::list<FoamGridEntityImp<dim-codim,dimworld> >::const_iterator levelIterator_;
+    // of the iterator, i.e. the 'pointer' to the entity.  The position in the array of leaf
+    // entities is kept redundantly here, because that is what can be incremented.
+    const EntityImp* const* current_;
+
+    /** \brief One past the last leaf entity */
+    const EntityImp* const* end_;
 };
 
 
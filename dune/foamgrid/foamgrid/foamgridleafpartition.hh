@@ -0,0 +1,159 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#ifndef DUNE_FOAMGRID_LEAFPARTITION_HH
+#define DUNE_FOAMGRID_LEAFPARTITION_HH
+
+/** \file
+* \brief The FoamGridLeafPartition class
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace Dune {
+
+    /** \brief Split the leaf entities of a FoamGrid into contiguous ranges for threads
+     *
+     * The leaf iterators walk over an array of the leaf entities ordered by leaf
+     * index, hence a range of leaf indices can be traversed by its own iterator.
+     * This class splits the leaf elements and the leaf vertices each into a number
+     * of ranges of (almost) the same size, and hands out begin and end iterators
+     * for every range.
+     *
+     * Traversing the grid does not modify it, so the ranges can be traversed
+     * concurrently from several threads, including the intersections of the
+     * elements.  The grid must not be adapted meanwhile, and
+     * FoamGrid::leafCoordinates() has to be called once before the threads start.
+     *
+     * Optionally the halo of each element range is computed: the leaf vertices of its
+     * elements that also belong to elements of other ranges.  Writes to data attached
+     * to halo vertices need synchronization, all other vertex data of an element
+     * range is only touched by that range.
+     *
+     * The partition refers to the current leaf indices, it has to be computed anew
+     * after the grid has been adapted.
+     *
+     * \tparam GridView A leaf grid view of a FoamGrid
+     */
+    template <class GridView>
+    class FoamGridLeafPartition
+    {
+        typedef typename GridView::Grid Grid;
+
+        enum {dim = Grid::dimension};
+        enum {dimworld = Grid::dimensionworld};
+        typedef typename Grid::ctype ctype;
+
+    public:
+
+        /** \brief Split the leaf elements and vertices of a view into ranges
+         *
+         * \param gridView The leaf grid view
+         * \param numRanges The number of ranges, usually the number of threads
+         * \param computeHalo Whether to compute the halo vertices of the element ranges
+         */
+        FoamGridLeafPartition(const GridView& gridView, unsigned int numRanges, bool computeHalo = false)
+            : grid_(&gridView.grid())
+        {
+            assert(numRanges > 0);
+            for (int codim=0; codim<=dim; codim++) {
+                const std::size_t n = grid_->leafIndexSet().size(codim);
+                offsets_[codim].resize(numRanges+1);
+                for (unsigned int r=0; r<=numRanges; r++)
+                    offsets_[codim][r] = (n*r) / numRanges;
+            }
+
+            if (computeHalo)
+                buildHalo();
+        }
+
+        /** \brief The number of ranges */
+        unsigned int size() const {
+            return offsets_[0].size()-1;
+        }
+
+        /** \brief The first leaf index of a range of entities of given codim */
+        std::size_t first(int codim, unsigned int range) const {
+            return offsets_[codim][range];
+        }
+
+        /** \brief One past the last leaf index of a range of entities of given codim */
+        std::size_t last(int codim, unsigned int range) const {
+            return offsets_[codim][range+1];
+        }
+
+        /** \brief Iterator to the first entity of a range */
+        template <int codim>
+        typename GridView::template Codim<codim>::Iterator begin(unsigned int range) const
+        {
+            typedef typename GridView::template Codim<codim>::Iterator Iterator;
+            typedef typename Iterator::Implementation IteratorImp;
+            return Iterator(IteratorImp(*grid_, first(codim, range), last(codim, range)));
+        }
+
+        /** \brief Iterator one past the last entity of a range */
+        template <int codim>
+        typename GridView::template Codim<codim>::Iterator end(unsigned int range) const
+        {
+            typedef typename GridView::template Codim<codim>::Iterator Iterator;
+            typedef typename Iterator::Implementation IteratorImp;
+            return Iterator(IteratorImp());
+        }
+
+        /** \brief The leaf indices of the halo vertices of an element range, sorted
+         *
+         * Empty unless the halo was requested in the constructor.
+         */
+        const std::vector<unsigned int>& halo(unsigned int range) const
+        {
+            static const std::vector<unsigned int> empty;
+            return halo_.empty() ? empty : halo_[range];
+        }
+
+    private:
+
+        /** \brief Find the vertices whose elements belong to more than one range */
+        void buildHalo()
+        {
+            const std::vector<const FoamGridEntityImp<1,dimworld,ctype>*>& elements
+                = Dune::get<1>(grid_->leafIndexSet().leafEntities_);
+            const std::size_t numVertices = Dune::get<0>(grid_->leafIndexSet().leafEntities_).size();
+
+            // The lowest and the highest range touching each vertex
+            std::vector<unsigned int> lowest(numVertices, size()), highest(numVertices, 0);
+            for (unsigned int r=0; r<size(); r++)
+                for (std::size_t e=first(0, r); e<last(0, r); e++)
+                    for (int i=0; i<2; i++) {
+                        const unsigned int v = elements[e]->vertex_[i]->leafIndex_;
+                        lowest[v] = std::min(lowest[v], r);
+                        highest[v] = std::max(highest[v], r);
+                    }
+
+            halo_.resize(size());
+            for (unsigned int r=0; r<size(); r++) {
+                for (std::size_t e=first(0, r); e<last(0, r); e++)
+                    for (int i=0; i<2; i++) {
+                        const unsigned int v = elements[e]->vertex_[i]->leafIndex_;
+                        if (lowest[v] != highest[v])
+                            halo_[r].push_back(v);
+                    }
+
+                std::sort(halo_[r].begin(), halo_[r].end());
+                halo_[r].erase(std::unique(halo_[r].begin(), halo_[r].end()), halo_[r].end());
+            }
+        }
+
+        const Grid* grid_;
+
+        /** \brief The first leaf index of each range and one past the last, for each codim */
+        std::vector<std::size_t> offsets_[dim+1];
+
+        /** \brief The halo vertices of each element range */
+        std::vector<std::vector<unsigned int> > halo_;
+    };
+
+}  // namespace Dune
+
+#endif
@@ -5,6 +5,8 @@
 * \brief The FoamGridLevelIterator class
 */
 
+#include "foamgridentitystorage.hh"
+
 namespace Dune {
 
 
@@ -22,21 +24,22 @@ class FoamGridLevelIterator :
 {
     enum {dim      = GridImp::dimension};
     enum {dimworld = GridImp::dimensionworld};
+    typedef typename GridImp::ctype ctype;
 
     public:
 
         //! Constructor
-    explicit FoamGridLevelIterator(const typename std::list<FoamGridEntityImp<dim-codim,dimworld> >::const_iterator& it)
+    explicit FoamGridLevelIterator(const typename FoamGridEntityStorage<FoamGridEntityImp<dim-codim,dimworld,ctype> >::const_iterator& it)
             : FoamGridEntityPointer<codim,GridImp>(it),
               levelIterator_(it)
         {
-            GridImp::getRealImplementation(this->virtualEntity_).setToTarget(&(*levelIterator_));
+            GridImp::getRealImplementation(this->virtualEntity_).setToTarget(levelIterator_.address());
         }
 
     //! prefix increment
         void increment() {
             ++levelIterator_;
-            GridImp::getRealImplementation(this->virtualEntity_).setToTarget(&(*levelIterator_));
+            GridImp::getRealImplementation(this->virtualEntity_).setToTarget(levelIterator_.address());
         }
 
 
@@ -44,9 +47,9 @@ class FoamGridLevelIterator :
 
     // This iterator derives from FoamGridEntityPointer, and that base class stores the value
     // of the iterator, i.e. the 'pointer' to the entity.  However, that pointer can not be
-    // set to its successor in the level std::list, not even by magic.  Therefore we keep the
+    // set to its successor in the level storage, not even by magic.  Therefore we keep the
     // same information redundantly in this iterator, which can be incremented.
-    typename std::list<FoamGridEntityImp<dim-codim,dimworld> >::const_iterator levelIterator_;
+    typename FoamGridEntityStorage<FoamGridEntityImp<dim-codim,dimworld,ctype> >::const_iterator levelIterator_;
 
 };
 
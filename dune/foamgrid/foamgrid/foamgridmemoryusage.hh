@@ -0,0 +1,80 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#ifndef DUNE_FOAMGRID_MEMORYUSAGE_HH
+#define DUNE_FOAMGRID_MEMORYUSAGE_HH
+
+/** \file
+* \brief The FoamGridMemoryUsage class
+*/
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include <dune/common/array.hh>
+
+namespace Dune {
+
+    /** \brief The memory used by the parts of a FoamGrid, in bytes
+     *
+     * Computed by FoamGrid::memoryUsage() from the capacities of the containers,
+     * hence it counts allocated rather than used memory, e.g. the dead slots of the
+     * entity storage.  It does not account for the overhead of the allocator.
+     */
+    struct FoamGridMemoryUsage
+    {
+        FoamGridMemoryUsage()
+            : leafIndexSet(0), coordinates(0), grid(0)
+        {}
+
+        /** \brief The entity storage of each level, indexed by level and codim */
+        std::vector<array<std::size_t,2> > entities;
+
+        /** \brief The vertex-to-element adjacency of each level */
+        std::vector<std::size_t> adjacency;
+
+        /** \brief The level index set of each level */
+        std::vector<std::size_t> levelIndexSets;
+
+        /** \brief The leaf index set, including the leaf entity arrays and the leaf index map */
+        std::size_t leafIndexSet;
+
+        /** \brief The cached coordinates of the leaf grid and the levels */
+        std::size_t coordinates;
+
+        /** \brief The grid object itself and the changes queued for grow() */
+        std::size_t grid;
+
+        /** \brief The memory of one level: entities, adjacency and index set */
+        std::size_t level(int level) const
+        {
+            return entities[level][0] + entities[level][1] + adjacency[level] + levelIndexSets[level];
+        }
+
+        /** \brief The memory of the whole grid */
+        std::size_t total() const
+        {
+            std::size_t result = leafIndexSet + coordinates + grid;
+            for (std::size_t l=0; l<entities.size(); l++)
+                result += level(l);
+            return result;
+        }
+    };
+
+    /** \brief Write a table of the memory usage, one line per level */
+    inline std::ostream& operator<<(std::ostream& s, const FoamGridMemoryUsage& usage)
+    {
+        s << "level  elements  vertices  adjacency  index set" << std::endl;
+        for (std::size_t l=0; l<usage.entities.size(); l++)
+            s << l << "  " << usage.entities[l][0] << "  " << usage.entities[l][1] << "  "
+              << usage.adjacency[l] << "  " << usage.levelIndexSets[l] << std::endl;
+        s << "leaf index set: " << usage.leafIndexSet << std::endl
+          << "coordinates: " << usage.coordinates << std::endl
+          << "grid: " << usage.grid << std::endl
+          << "total: " << usage.total() << std::endl;
+        return s;
+    }
+
+}  // namespace Dune
+
+#endif
@@ -8,6 +8,8 @@
 #include <dune/grid/common/gridenums.hh>
 #include <dune/grid/common/exceptions.hh>
 
+#include "foamgridadjacency.hh"
+
 
 namespace Dune {
 
@@ -41,20 +43,22 @@ namespace Dune {
      *
      * \tparam dim The dimension of this entity
      * \tparam dimworld The world diemnsion
+     * \tparam ctype The type used for the coordinates
      */
-    template <int dim, int dimworld>
+    template <int dim, int dimworld, class ctype>
     class FoamGridEntityImp
     {};
 
-    template <int dimworld>
-    class FoamGridEntityImp<0,dimworld>
+    template <int dimworld, class ctype>
+    class FoamGridEntityImp<0,dimworld,ctype>
         : public FoamGridEntityBase
     {
     public:
 
-        FoamGridEntityImp(int level, const FieldVector<double, dimworld>& pos, unsigned int id)
+        FoamGridEntityImp(int level, const FieldVector<ctype, dimworld>& pos, unsigned int id)
             : FoamGridEntityBase(level, id),
-              pos_(pos), son_(nullptr)
+              pos_(pos), elementsBegin_(nullptr), nElements_(0), elementsCapacity_(0),
+              boundaryId_(0), son_(nullptr)
         {}
 
         //private:
@@ -76,7 +80,7 @@ namespace Dune {
             return 1;
         }
 
-        FieldVector<double, dimworld> corner(int i) const {
+        FieldVector<ctype, dimworld> corner(int i) const {
             return pos_;
         }
 
@@ -100,15 +104,27 @@ namespace Dune {
             DUNE_THROW(GridError, "Non-existing codimension requested!");
         }
 
-        FieldVector<double, dimworld> pos_;
+        /** \brief The elements on this level that contain this vertex */
+        FoamGridElementSpan<FoamGridEntityImp<1,dimworld,ctype> > elements() const {
+            return FoamGridElementSpan<FoamGridEntityImp<1,dimworld,ctype> >(elementsBegin_, nElements_);
+        }
+
+        FieldVector<ctype, dimworld> pos_;
+
+        /** \brief Start of the range of adjacent elements in the adjacency of the level */
+        const FoamGridEntityImp<1,dimworld,ctype>* const* elementsBegin_;
+
+        /** \brief Number of elements on this level that contain this vertex */
+        unsigned int nElements_;
 
-	std::vector<const FoamGridEntityImp<1,dimworld>*> elements_;
+        /** \brief Number of elements that fit into the range starting at elementsBegin_ */
+        unsigned int elementsCapacity_;
 
 	//only used if the vertex is a boundary vertex
 	unsigned int boundaryId_;
 
         //! Son vertex on the next finer grid
-        FoamGridEntityImp<0,dimworld>* son_;
+        FoamGridEntityImp<0,dimworld,ctype>* son_;
 
     };
 
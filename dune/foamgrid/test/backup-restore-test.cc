@@ -0,0 +1,158 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#include <config.h>
+
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include <dune/grid/test/gridcheck.cc>
+
+#include <dune/foamgrid/foamgrid.hh>
+
+#include "networkgrids.hh"
+
+/** \brief Refine the leaf elements that touch the origin */
+template <class Grid>
+void refineAtJunction(Grid& grid)
+{
+    typedef typename Grid::template Codim<0>::LeafIterator LeafIterator;
+    for (LeafIterator eIt = grid.template leafbegin<0>(); eIt != grid.template leafend<0>(); ++eIt)
+        if (eIt->geometry().corner(0).two_norm() < 1e-10 || eIt->geometry().corner(1).two_norm() < 1e-10)
+            grid.mark(1, *eIt);
+
+    grid.preAdapt();
+    grid.adapt();
+    grid.postAdapt();
+}
+
+/** \brief Refine the leaf elements off the x-axis */
+template <class Grid>
+void refineTeeth(Grid& grid)
+{
+    typedef typename Grid::template Codim<0>::LeafIterator LeafIterator;
+    for (LeafIterator eIt = grid.template leafbegin<0>(); eIt != grid.template leafend<0>(); ++eIt)
+        if (eIt->geometry().center()[1] > 0)
+            grid.mark(1, *eIt);
+
+    grid.preAdapt();
+    grid.adapt();
+    grid.postAdapt();
+}
+
+/** \brief Check that two grids have the same entities, ids and indices on every level and on the leaf */
+template <class Grid>
+void compareGrids(const Grid& a, const Grid& b)
+{
+    if (a.maxLevel() != b.maxLevel())
+        DUNE_THROW(Dune::GridError, "The number of levels differs");
+
+    for (int level=0; level<=a.maxLevel(); level++) {
+        typedef typename Grid::template Codim<0>::LevelIterator ElementIterator;
+        ElementIterator aIt = a.template lbegin<0>(level);
+        ElementIterator bIt = b.template lbegin<0>(level);
+        for (; aIt != a.template lend<0>(level); ++aIt, ++bIt) {
+            if (bIt == b.template lend<0>(level))
+                DUNE_THROW(Dune::GridError, "Level " << level << " has less elements");
+
+            if (a.globalIdSet().id(*aIt) != b.globalIdSet().id(*bIt)
+                || a.levelIndexSet(level).index(*aIt) != b.levelIndexSet(level).index(*bIt)
+                || aIt->isLeaf() != bIt->isLeaf()
+                || (aIt->isLeaf() && a.leafIndexSet().index(*aIt) != b.leafIndexSet().index(*bIt)))
+                DUNE_THROW(Dune::GridError, "Elements on level " << level << " differ");
+
+            if (level > 0 && a.globalIdSet().id(*aIt->father()) != b.globalIdSet().id(*bIt->father()))
+                DUNE_THROW(Dune::GridError, "Fathers of elements on level " << level << " differ");
+
+            for (int i=0; i<2; i++)
+                if (a.globalIdSet().subId(*aIt, i, 1) != b.globalIdSet().subId(*bIt, i, 1)
+                    || (aIt->geometry().corner(i) - bIt->geometry().corner(i)).two_norm() > 0)
+                    DUNE_THROW(Dune::GridError, "Vertices of elements on level " << level << " differ");
+        }
+        if (bIt != b.template lend<0>(level))
+            DUNE_THROW(Dune::GridError, "Level " << level << " has more elements");
+    }
+
+    if (a.size(0) != b.size(0) || a.size(1) != b.size(1))
+        DUNE_THROW(Dune::GridError, "The leaf grids have different sizes");
+
+    typedef typename Grid::template Codim<1>::LeafIterator VertexIterator;
+    for (VertexIterator aIt = a.template leafbegin<1>(), bIt = b.template leafbegin<1>();
+         aIt != a.template leafend<1>(); ++aIt, ++bIt)
+        if (a.globalIdSet().id(*aIt) != b.globalIdSet().id(*bIt)
+            || a.leafIndexSet().index(*aIt) != b.leafIndexSet().index(*bIt))
+            DUNE_THROW(Dune::GridError, "Leaf vertices differ");
+}
+
+int main (int argc, char *argv[]) try
+{
+    typedef Dune::FoamGrid<3> Grid;
+    typedef Dune::BackupRestoreFacility<Grid> BackupRestore;
+
+    if (!Dune::Capabilities::hasBackupRestoreFacilities<Grid>::v)
+        DUNE_THROW(Dune::GridError, "FoamGrid should have backup and restore facilities");
+
+    std::auto_ptr<Grid> grid(makeTJunction<Grid>());
+    grid->globalRefine(1);
+    refineAtJunction(*grid);
+
+    // Through a stream
+    std::stringstream stream;
+    BackupRestore::backup(*grid, stream);
+    std::auto_ptr<Grid> restored(BackupRestore::restore(stream));
+
+    compareGrids(*grid, *restored);
+    gridcheck(*restored);
+
+    // Through a file, which is mapped into memory
+    const std::string filename = "backup-restore-test.foamgrid";
+    BackupRestore::backup(*grid, filename);
+    restored.reset(BackupRestore::restore(filename));
+    std::remove(filename.c_str());
+
+    compareGrids(*grid, *restored);
+
+    // The restored grid has to continue exactly like the original one
+    refineAtJunction(*grid);
+    refineAtJunction(*restored);
+    compareGrids(*grid, *restored);
+
+    // The leaf ordering decides the leaf indices after the next adaptation
+    std::auto_ptr<Grid> comb(makeComb<Grid>(10, 5));
+    comb->setLeafOrdering(Dune::networkOrder);
+    comb->globalRefine(1);
+
+    std::stringstream combStream;
+    BackupRestore::backup(*comb, combStream);
+    restored.reset(BackupRestore::restore(combStream));
+    if (restored->leafOrdering() != Dune::networkOrder)
+        DUNE_THROW(Dune::GridError, "The leaf ordering was not restored");
+    compareGrids(*comb, *restored);
+
+    refineTeeth(*comb);
+    refineTeeth(*restored);
+    compareGrids(*comb, *restored);
+
+    // A truncated backup has to be rejected
+    std::string data = stream.str();
+    std::stringstream truncated(data.substr(0, data.size()-8));
+    bool rejected = false;
+    try {
+        restored.reset(BackupRestore::restore(truncated));
+    } catch (Dune::IOError&) {
+        rejected = true;
+    }
+    if (!rejected)
+        DUNE_THROW(Dune::GridError, "A truncated backup was not rejected");
+
+    return 0;
+}
+// //////////////////////////////////
+//   Error handler
+// /////////////////////////////////
+catch (Dune::Exception e) {
+    std::cout << e << std::endl;
+    return 1;
+}
@@ -0,0 +1,123 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#include <config.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <dune/foamgrid/foamgrid.hh>
+
+#include "networkgrids.hh"
+
+/** \brief Deterministic pseudo-random numbers in [0,1) */
+double uniform(unsigned long& state)
+{
+    state = (state*6364136223846793005ul + 1442695040888963407ul);
+    return (state >> 11) * (1.0/9007199254740992.0);
+}
+
+/** \brief The points of a random walk of n steps in the unit cube */
+std::vector<double> randomWalk(std::size_t n, unsigned long& state)
+{
+    std::vector<double> coordinates(3*(n+1));
+    for (int j=0; j<3; j++)
+        coordinates[j] = 0.5;
+    for (std::size_t i=1; i<=n; i++)
+        for (int j=0; j<3; j++)
+            coordinates[3*i+j] = std::min(1.0, std::max(0.0, coordinates[3*(i-1)+j] + 0.1*(uniform(state)-0.5)));
+    return coordinates;
+}
+
+/** \brief Compare the queries of the tree with a scan over all segments */
+template <class Grid>
+void checkQueries(const Grid& grid, unsigned long& state)
+{
+    typedef Dune::FieldVector<double,3> GlobalCoordinate;
+    typedef typename Grid::template Codim<0>::LeafIterator LeafIterator;
+
+    Dune::FoamGridBoundingBoxTree<3> tree(grid.leafCoordinates());
+    if (tree.size() != static_cast<std::size_t>(grid.size(0)))
+        DUNE_THROW(Dune::GridError, "The tree does not contain all leaf segments");
+
+    const double radius = 0.05;
+    std::vector<std::size_t> result;
+
+    for (int k=0; k<100; k++) {
+        GlobalCoordinate point, lower, upper;
+        for (int j=0; j<3; j++) {
+            point[j] = uniform(state);
+            lower[j] = point[j] - radius;
+            upper[j] = point[j] + radius;
+        }
+
+        // Brute force
+        double nearestDistance = std::numeric_limits<double>::max();
+        std::vector<std::size_t> within, intersecting;
+        for (LeafIterator eIt = grid.template leafbegin<0>(); eIt != grid.template leafend<0>(); ++eIt) {
+            const std::size_t index = grid.leafIndexSet().index(*eIt);
+            const GlobalCoordinate a = eIt->geometry().corner(0);
+            const GlobalCoordinate d = eIt->geometry().corner(1) - a;
+            const double t = (d.two_norm2() > 0) ? std::min(1.0, std::max(0.0, ((point - a)*d) / d.two_norm2())) : 0.0;
+            GlobalCoordinate p = point - a;
+            p.axpy(-t, d);
+            nearestDistance = std::min(nearestDistance, p.two_norm());
+            if (p.two_norm() <= radius)
+                within.push_back(index);
+
+            bool overlaps = true;
+            for (int j=0; j<3; j++)
+                if (std::max(a[j], a[j]+d[j]) < lower[j] || std::min(a[j], a[j]+d[j]) > upper[j])
+                    overlaps = false;
+            if (overlaps)
+                intersecting.push_back(index);
+        }
+
+        double distance;
+        tree.nearest(point, &distance);
+        if (std::abs(distance - nearestDistance) > 1e-12)
+            DUNE_THROW(Dune::GridError, "Nearest segment has distance " << distance << " instead of " << nearestDistance);
+
+        tree.within(point, radius, result);
+        std::sort(result.begin(), result.end());
+        if (result != within)
+            DUNE_THROW(Dune::GridError, "Wrong segments within the radius");
+
+        tree.intersecting(lower, upper, result);
+        std::sort(result.begin(), result.end());
+        if (result != intersecting)
+            DUNE_THROW(Dune::GridError, "Wrong segments intersecting the box");
+    }
+}
+
+int main (int argc, char *argv[]) try
+{
+    typedef Dune::FoamGrid<3> Grid;
+
+    unsigned long state = 1;
+    std::auto_ptr<Grid> grid(makePolyline<Grid>(randomWalk(1000, state)));
+    checkQueries(*grid, state);
+
+    // Refine a part of the network, the tree is built anew
+    typedef Grid::Codim<0>::LeafIterator LeafIterator;
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->geometry().center()[0] < 0.5)
+            grid->mark(1, *eIt);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+
+    checkQueries(*grid, state);
+
+    return 0;
+}
+// //////////////////////////////////
+//   Error handler
+// /////////////////////////////////
+catch (Dune::Exception e) {
+    std::cout << e << std::endl;
+    return 1;
+}
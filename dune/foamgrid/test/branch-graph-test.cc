@@ -0,0 +1,243 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#include <config.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <dune/foamgrid/foamgrid.hh>
+#include <dune/foamgrid/foamgrid/foamgridbranchgraph.hh>
+
+#include "networkgrids.hh"
+
+/** \brief A square loop of four segments */
+template <class Grid>
+Grid* makeLoop()
+{
+    const double coordinates[] = {0,0,0, 1,0,0, 1,1,0, 0,1,0};
+    const unsigned int connectivity[] = {0,1, 1,2, 2,3, 3,0};
+
+    Dune::GridFactory<Grid> factory;
+    factory.insertVertices(coordinates, 4);
+    factory.insertElements(connectivity, 4);
+    return factory.createGrid();
+}
+
+/** \brief Check that the branches are chains between junctions covering the leaf grid
+ *
+ * \return The lengths of the branches, sorted
+ */
+template <class GridView>
+std::vector<double> checkBranches(const Dune::FoamGridBranchGraph<GridView>& graph, const GridView& gridView)
+{
+    typedef Dune::FoamGridBranchGraph<GridView> BranchGraph;
+    typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+    const typename GridView::IndexSet& indexSet = gridView.indexSet();
+
+    // The leaf iterator visits the elements in leaf index order
+    std::vector<typename GridView::template Codim<0>::EntityPointer> elements;
+    std::vector<std::size_t> degree(gridView.size(1), 0);
+    for (ElementIterator eIt = gridView.template begin<0>(); eIt != gridView.template end<0>(); ++eIt) {
+        elements.push_back(eIt);
+        for (int i=0; i<2; i++)
+            ++degree[indexSet.subIndex(*eIt, i, 1)];
+    }
+
+    // Only a closed loop has a junction of degree two
+    for (std::size_t v=0; v<degree.size(); v++) {
+        const unsigned int j = graph.vertexJunction(v);
+        if (degree[v] != 2 && j == BranchGraph::none)
+            DUNE_THROW(Dune::GridError, "Vertex " << v << " of degree " << degree[v] << " is not a junction");
+        if (degree[v] == 2 && j != BranchGraph::none
+            && graph.branchJunction(graph.junctionBranches(j)[0], 1) != graph.branchJunction(graph.junctionBranches(j)[0], 0))
+            DUNE_THROW(Dune::GridError, "Vertex " << v << " of degree 2 is a junction");
+    }
+
+    std::vector<double> lengths;
+    std::size_t numElements = 0;
+    for (std::size_t b=0; b<graph.size(); b++) {
+        unsigned int vertex = graph.junctionVertex(graph.branchJunction(b, 0));
+        double length = 0;
+        for (std::size_t k=0; k<graph.branchSize(b); k++, numElements++) {
+            const unsigned int e = graph.branchElements(b)[k];
+            if (graph.branch(e) != b || graph.position(e) != k)
+                DUNE_THROW(Dune::GridError, "Wrong branch or position of element " << e);
+
+            // The element begins where the previous one ended
+            const int front = graph.forward(e) ? 0 : 1;
+            if (static_cast<unsigned int>(indexSet.subIndex(*elements[e], front, 1)) != vertex)
+                DUNE_THROW(Dune::GridError, "Branch " << b << " is interrupted at position " << k);
+            vertex = indexSet.subIndex(*elements[e], 1-front, 1);
+            length += elements[e]->geometry().volume();
+
+            if (k+1 < graph.branchSize(b) && graph.vertexJunction(vertex) != BranchGraph::none)
+                DUNE_THROW(Dune::GridError, "Branch " << b << " runs through a junction");
+        }
+
+        if (vertex != graph.junctionVertex(graph.branchJunction(b, 1)))
+            DUNE_THROW(Dune::GridError, "Branch " << b << " does not end at its back junction");
+        lengths.push_back(length);
+
+        // Both ends are listed at their junctions
+        for (int i=0; i<2; i++) {
+            const unsigned int j = graph.branchJunction(b, i);
+            if (std::count(graph.junctionBranches(j), graph.junctionBranches(j) + graph.junctionSize(j), b) == 0)
+                DUNE_THROW(Dune::GridError, "Branch " << b << " is missing at junction " << j);
+        }
+    }
+
+    if (numElements != static_cast<std::size_t>(gridView.size(0)))
+        DUNE_THROW(Dune::GridError, "The branches contain " << numElements << " elements");
+
+    std::sort(lengths.begin(), lengths.end());
+    return lengths;
+}
+
+/** \brief Whether two sorted lists of branch lengths agree */
+bool sameLengths(const std::vector<double>& a, const std::vector<double>& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (std::size_t i=0; i<a.size(); i++)
+        if (std::abs(a[i] - b[i]) > 1e-10)
+            return false;
+    return true;
+}
+
+int main (int argc, char *argv[]) try
+{
+    typedef Dune::FoamGrid<3> Grid;
+    typedef Grid::LeafGridView GridView;
+    typedef Dune::FoamGridBranchGraph<GridView> BranchGraph;
+
+    // Backbone ends, inner backbone vertices and tooth tips are the junctions
+    std::auto_ptr<Grid> grid(makeComb<Grid>(5, 3));
+    grid->globalRefine(1);
+
+    BranchGraph graph(grid->leafGridView());
+    checkBranches(graph, grid->leafGridView());
+    if (graph.size() != 9 || graph.numJunctions() != 10)
+        DUNE_THROW(Dune::GridError, "The comb has " << graph.size() << " branches and "
+                   << graph.numJunctions() << " junctions");
+
+    // Refine the teeth and carry the branches over
+    typedef Grid::Codim<0>::LeafIterator LeafIterator;
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->geometry().center()[1] > 0)
+            grid->mark(1, *eIt);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+
+    graph.update(grid->leafIndexMap());
+    std::vector<double> lengths = checkBranches(graph, grid->leafGridView());
+    if (!sameLengths(lengths, checkBranches(BranchGraph(grid->leafGridView()), grid->leafGridView())))
+        DUNE_THROW(Dune::GridError, "The updated branches differ from the recomputed ones after refinement");
+
+    // Coarsen the teeth and refine the backbone in one step
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->level() == 2)
+            grid->mark(-1, *eIt);
+        else if (eIt->geometry().center()[1] == 0)
+            grid->mark(1, *eIt);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+
+    graph.update(grid->leafIndexMap());
+    lengths = checkBranches(graph, grid->leafGridView());
+    if (!sameLengths(lengths, checkBranches(BranchGraph(grid->leafGridView()), grid->leafGridView())))
+        DUNE_THROW(Dune::GridError, "The updated branches differ from the recomputed ones after coarsening");
+
+    // A map of the same size that does not start from the graph is rejected as well
+    LeafIterator son = grid->leafbegin<0>();
+    while (son->level() != 2)
+        ++son;
+    const Grid::Codim<0>::EntityPointer father = son->father();
+    bool refined = false;
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->level() == 2 && eIt->father() == father)
+            grid->mark(-1, *eIt);
+        else if (eIt->level() == 1 && !refined) {
+            grid->mark(1, *eIt);
+            refined = true;
+        }
+    const int numElements = grid->size(0);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+    if (grid->size(0) != numElements)
+        DUNE_THROW(Dune::GridError, "The first adaptation changed the number of elements");
+
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->level() == 1 && eIt->geometry().center()[1] > 0) {
+            grid->mark(1, *eIt);
+            break;
+        }
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+
+    bool thrown = false;
+    try {
+        graph.update(grid->leafIndexMap());
+    } catch (Dune::InvalidStateException) {
+        thrown = true;
+    }
+    if (!thrown)
+        DUNE_THROW(Dune::GridError, "A leaf index map not starting from the graph was accepted");
+    graph.update();
+
+    // A map that does not belong to the graph is rejected
+    grid->globalRefine(1);
+    thrown = false;
+    try {
+        graph.update(grid->leafIndexMap());
+    } catch (Dune::InvalidStateException) {
+        thrown = true;
+    }
+    if (!thrown)
+        DUNE_THROW(Dune::GridError, "An invalid leaf index map was accepted");
+
+    // Rebuilding the graph sees the vertices added since it was constructed
+    graph.update();
+    lengths = checkBranches(graph, grid->leafGridView());
+    if (!sameLengths(lengths, checkBranches(BranchGraph(grid->leafGridView()), grid->leafGridView())))
+        DUNE_THROW(Dune::GridError, "The rebuilt branches differ from the recomputed ones after global refinement");
+
+    // Growth adds vertices, the update rebuilds the branches of the grown grid
+    typedef GridView::Codim<1>::Iterator VertexIterator;
+    const GridView gridView = grid->leafGridView();
+    Dune::FieldVector<double,3> tip(0);
+    tip[0] = -1;
+    const unsigned int newVertex = grid->insertVertex(tip);
+    for (VertexIterator vIt = gridView.begin<1>(); vIt != gridView.end<1>(); ++vIt)
+        if (vIt->geometry().corner(0).two_norm() < 1e-10)
+            grid->insertElement(*vIt, newVertex);
+    grid->grow();
+    grid->postAdapt();
+
+    graph.update(grid->leafIndexMap());
+    lengths = checkBranches(graph, grid->leafGridView());
+    if (!sameLengths(lengths, checkBranches(BranchGraph(grid->leafGridView()), grid->leafGridView())))
+        DUNE_THROW(Dune::GridError, "The updated branches differ from the recomputed ones after growth");
+
+    // A closed loop is one branch from a vertex back to itself
+    std::auto_ptr<Grid> loop(makeLoop<Grid>());
+    BranchGraph loopGraph(loop->leafGridView());
+    checkBranches(loopGraph, loop->leafGridView());
+    if (loopGraph.size() != 1 || loopGraph.numJunctions() != 1 || loopGraph.junctionSize(0) != 2)
+        DUNE_THROW(Dune::GridError, "Wrong branch graph of a loop");
+
+    return 0;
+}
+// //////////////////////////////////
+//   Error handler
+// /////////////////////////////////
+catch (Dune::Exception e) {
+    std::cout << e << std::endl;
+    return 1;
+}
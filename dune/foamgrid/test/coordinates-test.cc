@@ -0,0 +1,135 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#include <config.h>
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <dune/foamgrid/foamgrid.hh>
+
+#include "networkgrids.hh"
+
+/** \brief Check the coordinate store of a view and the segment geometry computed from it
+ *
+ * The batch kernels must agree with the geometries of the elements of the view,
+ * which are numbered like the store by the index set of the view.
+ */
+template <class GridView, class Store>
+void checkSegmentGeometry(const GridView& gridView, const Store& store)
+{
+    enum {dimworld = GridView::dimensionworld};
+    typedef typename GridView::Grid::ctype ctype;
+    typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+
+    const std::size_t n = store.numElements();
+    if (n != static_cast<std::size_t>(gridView.size(0)) || store.numVertices() != static_cast<std::size_t>(gridView.size(1)))
+        DUNE_THROW(Dune::GridError, "The store has " << n << " elements and " << store.numVertices()
+                   << " vertices, the view " << gridView.size(0) << " and " << gridView.size(1));
+
+    // A level may have lost all its elements
+    if (n == 0)
+        return;
+
+    std::vector<ctype> length(n);
+    Dune::array<std::vector<ctype>, dimworld> midpoint, tangent;
+    typename Store::OutputArrays midpointArrays, tangentArrays;
+    for (int i=0; i<dimworld; i++) {
+        midpoint[i].resize(n);
+        tangent[i].resize(n);
+        midpointArrays[i] = &midpoint[i][0];
+        tangentArrays[i] = &tangent[i][0];
+    }
+
+    Dune::computeSegmentLengths(store, &length[0]);
+    Dune::computeSegmentMidpoints(store, midpointArrays);
+    Dune::computeSegmentTangents(store, tangentArrays);
+
+    for (ElementIterator eIt = gridView.template begin<0>(); eIt != gridView.template end<0>(); ++eIt) {
+        const std::size_t e = gridView.indexSet().index(*eIt);
+        const typename GridView::template Codim<0>::Geometry geometry = eIt->geometry();
+        const Dune::FieldVector<ctype,dimworld> center = geometry.center();
+        Dune::FieldVector<ctype,dimworld> direction = geometry.corner(1);
+        direction -= geometry.corner(0);
+        direction /= direction.two_norm();
+
+        if (std::abs(length[e] - geometry.volume()) > 1e-10)
+            DUNE_THROW(Dune::GridError, "Element " << e << " has length " << geometry.volume()
+                       << ", the kernel computed " << length[e]);
+
+        for (int i=0; i<dimworld; i++) {
+            for (int j=0; j<2; j++)
+                if (std::abs(store.coordinates(i)[store.elementVertices(j)[e]] - geometry.corner(j)[i]) > 1e-10)
+                    DUNE_THROW(Dune::GridError, "The store has the wrong vertex " << j << " of element " << e);
+            if (std::abs(midpoint[i][e] - center[i]) > 1e-10)
+                DUNE_THROW(Dune::GridError, "Element " << e << " has the wrong midpoint");
+            if (std::abs(tangent[i][e] - direction[i]) > 1e-10)
+                DUNE_THROW(Dune::GridError, "Element " << e << " has the wrong tangent");
+        }
+    }
+}
+
+/** \brief Check the stores of the leaf grid and of all levels */
+template <class Grid>
+void checkCoordinates(const Grid& grid)
+{
+    checkSegmentGeometry(grid.leafGridView(), grid.leafCoordinates());
+    for (int level=0; level<=grid.maxLevel(); level++)
+        checkSegmentGeometry(grid.levelGridView(level), grid.levelCoordinates(level));
+}
+
+int main (int argc, char *argv[]) try
+{
+    typedef Dune::FoamGrid<3> Grid;
+    typedef Grid::Codim<0>::LeafIterator LeafIterator;
+
+    std::auto_ptr<Grid> grid(makeComb<Grid>(10, 5));
+    checkCoordinates(*grid);
+
+    // Refine the teeth: the stores must be refilled with the new indices
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->geometry().center()[1] > 0)
+            grid->mark(1, *eIt);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+    checkCoordinates(*grid);
+
+    // Coarsen them again
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->level() > 0)
+            grid->mark(-1, *eIt);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+    checkCoordinates(*grid);
+
+    // Extend the backbone beyond the origin and refine it
+    typedef Grid::LeafGridView::Codim<1>::Iterator VertexIterator;
+    const Grid::LeafGridView gridView = grid->leafGridView();
+    Dune::FieldVector<double,3> tip(0);
+    tip[0] = -1;
+    const unsigned int newVertex = grid->insertVertex(tip);
+    for (VertexIterator vIt = gridView.begin<1>(); vIt != gridView.end<1>(); ++vIt)
+        if (vIt->geometry().corner(0).two_norm() < 1e-10)
+            grid->insertElement(*vIt, newVertex);
+    grid->grow();
+    grid->postAdapt();
+    checkCoordinates(*grid);
+
+    grid->globalRefine(1);
+    checkCoordinates(*grid);
+
+    grid->flatten();
+    checkCoordinates(*grid);
+
+    return 0;
+}
+// //////////////////////////////////
+//   Error handler
+// /////////////////////////////////
+catch (Dune::Exception e) {
+    std::cout << e << std::endl;
+    return 1;
+}
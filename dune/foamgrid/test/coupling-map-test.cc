@@ -0,0 +1,152 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#include <config.h>
+
+#include <bitset>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <dune/common/version.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/foamgrid/foamgrid.hh>
+#include <dune/foamgrid/foamgrid/foamgridcouplingmap.hh>
+
+#include "networkgrids.hh"
+
+/** \brief The points of a polyline through the unit cube that crosses many cells diagonally */
+std::vector<double> networkPoints()
+{
+    const std::size_t n = 20;
+    std::vector<double> coordinates(3*(n+1));
+    for (std::size_t i=0; i<=n; i++) {
+        const double t = double(i)/n;
+        coordinates[3*i]   = 0.05 + 0.9*t;
+        coordinates[3*i+1] = 0.5 + 0.4*std::sin(7*t);
+        coordinates[3*i+2] = 0.5 + 0.4*std::cos(5*t);
+    }
+    return coordinates;
+}
+
+/** \brief Check that the parts of every segment cover it and lie in their cells */
+template <class CouplingMap, class FoamGridView, class HostGridView>
+void checkCouplingMap(const CouplingMap& couplingMap, const FoamGridView& foamGridView, const HostGridView& hostGridView)
+{
+    typedef typename FoamGridView::template Codim<0>::Iterator ElementIterator;
+    typedef typename HostGridView::template Codim<0>::Iterator HostIterator;
+    typedef Dune::FieldVector<double,3> GlobalCoordinate;
+
+    // The cells of the host grid are axis-aligned
+    std::vector<GlobalCoordinate> lower(hostGridView.size(0)), upper(hostGridView.size(0));
+    for (HostIterator it = hostGridView.template begin<0>(); it != hostGridView.template end<0>(); ++it) {
+        lower[hostGridView.indexSet().index(*it)] = it->geometry().corner(0);
+        upper[hostGridView.indexSet().index(*it)] = it->geometry().corner(it->geometry().corners()-1);
+    }
+
+    if (couplingMap.size() != static_cast<std::size_t>(foamGridView.size(0)))
+        DUNE_THROW(Dune::GridError, "The coupling map has the wrong number of segments");
+
+    for (ElementIterator eIt = foamGridView.template begin<0>(); eIt != foamGridView.template end<0>(); ++eIt) {
+        const std::size_t index = foamGridView.indexSet().index(*eIt);
+
+        double length = 0;
+        double position = 0;
+        for (typename CouplingMap::const_iterator it = couplingMap.begin(index); it != couplingMap.end(index); ++it) {
+            if (std::abs(it->begin - position) > 1e-10)
+                DUNE_THROW(Dune::GridError, "The parts of segment " << index << " have a gap or overlap");
+            position = it->end;
+            length += it->length;
+
+            const GlobalCoordinate mid = eIt->geometry().global(Dune::FieldVector<double,1>(0.5*(it->begin + it->end)));
+            for (int j=0; j<3; j++)
+                if (mid[j] < lower[it->cell][j] - 1e-10 || mid[j] > upper[it->cell][j] + 1e-10)
+                    DUNE_THROW(Dune::GridError, "A part of segment " << index << " is not in its cell");
+        }
+
+        if (std::abs(position - 1) > 1e-10 || std::abs(length - eIt->geometry().volume()) > 1e-10)
+            DUNE_THROW(Dune::GridError, "The parts of segment " << index << " do not cover it");
+    }
+}
+
+int main (int argc, char *argv[]) try
+{
+    typedef Dune::FoamGrid<3> Grid;
+    typedef Dune::YaspGrid<3> HostGrid;
+    typedef Grid::LeafGridView GridView;
+    typedef HostGrid::LeafGridView HostGridView;
+
+    Dune::FieldVector<double,3> size(1);
+#if DUNE_VERSION_NEWER(DUNE_GRID,2,4)
+    Dune::array<int,3> cells;
+#else
+    Dune::FieldVector<int,3> cells;
+#endif
+    std::fill(cells.begin(), cells.end(), 7);
+    HostGrid hostGrid(size, cells, std::bitset<3>(), 0);
+
+    std::auto_ptr<Grid> grid(makePolyline<Grid>(networkPoints()));
+
+    Dune::FoamGridCouplingMap<GridView, HostGridView> couplingMap(grid->leafGridView(), hostGrid.leafGridView());
+    checkCouplingMap(couplingMap, grid->leafGridView(), hostGrid.leafGridView());
+
+    // Refine half of the network and update incrementally
+    typedef Grid::Codim<0>::LeafIterator LeafIterator;
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->geometry().center()[0] < 0.5)
+            grid->mark(1, *eIt);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+
+    couplingMap.updateFoamGrid();
+    checkCouplingMap(couplingMap, grid->leafGridView(), hostGrid.leafGridView());
+
+    // Two adaptations without an update, where the first keeps the number of segments:
+    // the map of the second does not start from the table, which is recomputed
+    LeafIterator son = grid->leafbegin<0>();
+    while (son->level() == 0)
+        ++son;
+    const Grid::Codim<0>::EntityPointer father = son->father();
+    bool refined = false;
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->level() > 0 && eIt->father() == father)
+            grid->mark(-1, *eIt);
+        else if (eIt->level() == 0 && !refined) {
+            grid->mark(1, *eIt);
+            refined = true;
+        }
+    const int numSegments = grid->size(0);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+    if (grid->size(0) != numSegments)
+        DUNE_THROW(Dune::GridError, "The first adaptation changed the number of segments");
+
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->level() == 0) {
+            grid->mark(1, *eIt);
+            break;
+        }
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+
+    couplingMap.updateFoamGrid();
+    checkCouplingMap(couplingMap, grid->leafGridView(), hostGrid.leafGridView());
+
+    // Refine the host grid
+    hostGrid.globalRefine(1);
+    couplingMap.updateHost();
+    checkCouplingMap(couplingMap, grid->leafGridView(), hostGrid.leafGridView());
+
+    return 0;
+}
+// //////////////////////////////////
+//   Error handler
+// /////////////////////////////////
+catch (Dune::Exception e) {
+    std::cout << e << std::endl;
+    return 1;
+}
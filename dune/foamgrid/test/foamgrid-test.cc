@@ -57,6 +57,87 @@ int main (int argc, char *argv[]) try
         std::cout << "  Calling checkIntersectionIterator" << std::endl;
         checkIntersectionIterator(*gridTJunction);
     }
+    {
+        std::cout << "Checking FoamGrid<3, float> (2d in 3d grid with float coordinates)" << std::endl;
+
+        std::cout << "  Creating grid" << std::endl;
+        std::auto_ptr<FoamGrid<3, float> > gridFloat( GmshReader<FoamGrid<3, float> >::read( dune_foamgrid_path + "tjunction-2d.msh", false, false ) );
+
+        std::cout << "  Calling gridcheck" << std::endl;
+        gridcheck(*gridFloat);
+
+        std::cout << "  Calling checkIntersectionIterator" << std::endl;
+        checkIntersectionIterator(*gridFloat);
+
+        std::cout << "  Refining globally" << std::endl;
+        gridFloat->globalRefine(1);
+        gridcheck(*gridFloat);
+    }
+    {
+        std::cout << "Checking FoamGrid<2> (bulk insertion of a polyline)" << std::endl;
+
+        // A zigzag line of 100 segments
+        const std::size_t n = 100;
+        std::vector<double> coordinates(2*(n+1));
+        std::vector<unsigned int> connectivity(2*n);
+        for (std::size_t i=0; i<=n; i++) {
+            coordinates[2*i]   = i;
+            coordinates[2*i+1] = i%2;
+        }
+        for (std::size_t i=0; i<n; i++) {
+            connectivity[2*i]   = i;
+            connectivity[2*i+1] = i+1;
+        }
+
+        std::cout << "  Creating grid" << std::endl;
+        GridFactory<FoamGrid<2> > factory;
+        factory.reserve(n+1, n);
+        factory.insertVertices(&coordinates[0], n+1);
+        factory.insertElements(&connectivity[0], n);
+        std::auto_ptr<FoamGrid<2> > gridLine(factory.createGrid());
+
+        if (gridLine->size(0) != int(n) || gridLine->size(1) != int(n+1) || gridLine->numBoundarySegments() != 2)
+            DUNE_THROW(GridError, "Wrong size of the grid inserted in bulk");
+
+        std::cout << "  Calling gridcheck" << std::endl;
+        gridcheck(*gridLine);
+
+        std::cout << "  Calling checkIntersectionIterator" << std::endl;
+        checkIntersectionIterator(*gridLine);
+    }
+    {
+        std::cout << "Checking FoamGrid<3> (T-junction from three separate segments)" << std::endl;
+
+        // Every segment has its own copy of the junction point, slightly perturbed
+        double coordinates[6][3] = {{0,0,0}, {-1,0,0}, {1e-9,0,0}, {1,0,0}, {0,-1e-9,0}, {0,1,1}};
+
+        std::cout << "  Creating grid" << std::endl;
+        GridFactory<FoamGrid<3> > factory;
+        factory.setVertexMergeTolerance(1e-6);
+        for (int i=0; i<6; i++) {
+            FieldVector<double,3> pos;
+            for (int j=0; j<3; j++)
+                pos[j] = coordinates[i][j];
+            factory.insertVertex(pos);
+        }
+
+        std::vector<unsigned int> element(2);
+        for (unsigned int i=0; i<3; i++) {
+            element[0] = 2*i;
+            element[1] = 2*i+1;
+            factory.insertElement(GeometryType(1), element);
+        }
+        std::auto_ptr<FoamGrid<3> > gridMerged(factory.createGrid());
+
+        if (gridMerged->size(0) != 3 || gridMerged->size(1) != 4 || gridMerged->numBoundarySegments() != 3)
+            DUNE_THROW(GridError, "The junction vertices were not merged");
+
+        std::cout << "  Calling gridcheck" << std::endl;
+        gridcheck(*gridMerged);
+
+        std::cout << "  Calling checkIntersectionIterator" << std::endl;
+        checkIntersectionIterator(*gridMerged);
+    }
 }
 // //////////////////////////////////
 //   Error handler
@@ -0,0 +1,85 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#include <config.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+
+#include <dune/foamgrid/foamgrid.hh>
+
+#include "networkgrids.hh"
+
+// Count all heap allocations of the program
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+/** \brief Traverse all leaf intersections and return the number of heap allocations */
+template <class GridView>
+std::size_t countAllocations(const GridView& gridView, std::size_t& numIntersections, std::size_t& numBoundary)
+{
+    typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+    typedef typename GridView::IntersectionIterator IntersectionIterator;
+
+    numIntersections = numBoundary = 0;
+    const std::size_t before = allocations;
+
+    for (ElementIterator eIt = gridView.template begin<0>(); eIt != gridView.template end<0>(); ++eIt)
+        for (IntersectionIterator iIt = gridView.ibegin(*eIt); iIt != gridView.iend(*eIt); ++iIt) {
+            ++numIntersections;
+            if (iIt->boundary())
+                ++numBoundary;
+            else if (iIt->neighbor() && iIt->outside() == iIt->inside())
+                DUNE_THROW(Dune::GridError, "An element is its own neighbor");
+        }
+
+    return allocations - before;
+}
+
+int main (int argc, char *argv[]) try
+{
+    typedef Dune::FoamGrid<2> Grid;
+
+    // At a junction of 5 segments each segment has 4 neighbors there
+    std::auto_ptr<Grid> grid(makeStar<Grid>(5, 10));
+
+    std::size_t numIntersections, numBoundary;
+    const std::size_t leafAllocations = countAllocations(grid->leafGridView(), numIntersections, numBoundary);
+
+    std::cout << numIntersections << " leaf intersections, "
+              << leafAllocations << " allocations" << std::endl;
+
+    // 5*4 at the junction, 5 at the tips, and 2 at each of the 5*9 vertices inside the branches
+    if (numIntersections != 20 + 5 + 90 || numBoundary != 5)
+        DUNE_THROW(Dune::GridError, "Wrong number of intersections: " << numIntersections
+                   << ", of which " << numBoundary << " on the boundary");
+
+    if (leafAllocations != 0)
+        DUNE_THROW(Dune::GridError, "Traversing the leaf intersections allocated memory");
+
+    const std::size_t levelAllocations = countAllocations(grid->levelGridView(0), numIntersections, numBoundary);
+    if (levelAllocations != 0)
+        DUNE_THROW(Dune::GridError, "Traversing the level intersections allocated memory");
+
+    return 0;
+}
+// //////////////////////////////////
+//   Error handler
+// /////////////////////////////////
+catch (Dune::Exception e) {
+    std::cout << e << std::endl;
+    return 1;
+}
@@ -0,0 +1,170 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#include <config.h>
+
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <dune/foamgrid/foamgrid.hh>
+#include <dune/foamgrid/foamgrid/foamgridleafcoloring.hh>
+#include <dune/foamgrid/foamgrid/foamgridleafpartition.hh>
+
+#include "networkgrids.hh"
+
+/** \brief Sum the lengths of the elements and count the intersections of one range */
+template <class Partition, class GridView>
+void traverse(const Partition& partition, const GridView& gridView, unsigned int range,
+              double& length, std::size_t& numIntersections)
+{
+    typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+    typedef typename GridView::IntersectionIterator IntersectionIterator;
+
+    length = 0;
+    numIntersections = 0;
+    for (ElementIterator eIt = partition.template begin<0>(range); eIt != partition.template end<0>(range); ++eIt) {
+        length += eIt->geometry().volume();
+        for (IntersectionIterator iIt = gridView.ibegin(*eIt); iIt != gridView.iend(*eIt); ++iIt)
+            ++numIntersections;
+    }
+}
+
+/** \brief Add the lengths of the elements of one color in a range to their vertices */
+template <class Coloring, class GridView>
+void assemble(const Coloring& coloring, const GridView& gridView, unsigned int color,
+              unsigned int range, unsigned int numRanges, std::vector<double>& vertexLength)
+{
+    typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+
+    unsigned int i = 0;
+    for (ElementIterator eIt = coloring.begin(color); eIt != coloring.end(color); ++eIt, ++i) {
+        if (i % numRanges != range)
+            continue;
+        const double length = eIt->geometry().volume();
+        for (int k=0; k<2; k++)
+            vertexLength[gridView.indexSet().subIndex(*eIt, k, 1)] += 0.5*length;
+    }
+}
+
+int main (int argc, char *argv[]) try
+{
+    typedef Dune::FoamGrid<3> Grid;
+    typedef Grid::LeafGridView GridView;
+
+    std::auto_ptr<Grid> grid(makeStar<Grid>(5, 40, 0.1));
+    grid->globalRefine(1);
+    const GridView gridView = grid->leafGridView();
+
+    const unsigned int numThreads = 4;
+    Dune::FoamGridLeafPartition<GridView> partition(gridView, numThreads, true);
+
+    // Every leaf element and vertex is in exactly one range, in leaf index order
+    for (int codim=0; codim<=1; codim++) {
+        std::size_t next = 0;
+        for (unsigned int r=0; r<partition.size(); r++) {
+            if (partition.first(codim, r) != next)
+                DUNE_THROW(Dune::GridError, "The ranges of codim " << codim << " are not contiguous");
+            next = partition.last(codim, r);
+        }
+        if (next != static_cast<std::size_t>(gridView.size(codim)))
+            DUNE_THROW(Dune::GridError, "The ranges of codim " << codim << " do not cover the grid");
+    }
+
+    std::size_t numVertices = 0;
+    for (unsigned int r=0; r<partition.size(); r++)
+        for (GridView::Codim<1>::Iterator vIt = partition.begin<1>(r); vIt != partition.end<1>(r); ++vIt) {
+            const std::size_t index = gridView.indexSet().index(*vIt);
+            if (index < partition.first(1, r) || index >= partition.last(1, r))
+                DUNE_THROW(Dune::GridError, "Vertex " << index << " is not in range " << r);
+            ++numVertices;
+        }
+    if (numVertices != static_cast<std::size_t>(gridView.size(1)))
+        DUNE_THROW(Dune::GridError, "The vertex ranges visit " << numVertices << " vertices");
+
+    // Sequential reference
+    double totalLength;
+    std::size_t totalIntersections;
+    Dune::FoamGridLeafPartition<GridView> single(gridView, 1);
+    traverse(single, gridView, 0, totalLength, totalIntersections);
+
+    // Traverse all ranges concurrently
+    std::vector<double> length(numThreads);
+    std::vector<std::size_t> numIntersections(numThreads);
+    std::vector<std::thread> threads;
+    for (unsigned int r=0; r<numThreads; r++)
+        threads.push_back(std::thread(traverse<Dune::FoamGridLeafPartition<GridView>, GridView>,
+                                      std::cref(partition), std::cref(gridView), r,
+                                      std::ref(length[r]), std::ref(numIntersections[r])));
+    for (unsigned int r=0; r<numThreads; r++)
+        threads[r].join();
+
+    double sumLength = 0;
+    std::size_t sumIntersections = 0;
+    for (unsigned int r=0; r<numThreads; r++) {
+        sumLength += length[r];
+        sumIntersections += numIntersections[r];
+    }
+
+    if (std::abs(sumLength - totalLength) > 1e-10 || sumIntersections != totalIntersections)
+        DUNE_THROW(Dune::GridError, "The concurrent traversal differs from the sequential one");
+
+    // Each cut between two ranges of a chain leaves one shared vertex in both halos
+    std::size_t haloSize = 0;
+    for (unsigned int r=0; r<partition.size(); r++)
+        haloSize += partition.halo(r).size();
+    if (haloSize == 0 || !single.halo(0).empty())
+        DUNE_THROW(Dune::GridError, "Wrong halo sizes");
+
+    // No two elements of the same color share a vertex
+    typedef Dune::FoamGridLeafColoring<GridView> Coloring;
+    Coloring coloring(gridView);
+    if (coloring.numColors() < 5 || coloring.numColors() > 9)
+        DUNE_THROW(Dune::GridError, "A star with 5 arms needs 5 to 9 colors, not " << coloring.numColors());
+
+    std::size_t numColored = 0;
+    for (unsigned int c=0; c<coloring.numColors(); c++) {
+        std::vector<bool> touched(gridView.size(1), false);
+        for (Coloring::Iterator eIt = coloring.begin(c); eIt != coloring.end(c); ++eIt, ++numColored) {
+            if (coloring.color(gridView.indexSet().index(*eIt)) != c)
+                DUNE_THROW(Dune::GridError, "Element of the wrong color in color " << c);
+            for (int k=0; k<2; k++) {
+                const std::size_t v = gridView.indexSet().subIndex(*eIt, k, 1);
+                if (touched[v])
+                    DUNE_THROW(Dune::GridError, "Two elements of color " << c << " share vertex " << v);
+                touched[v] = true;
+            }
+        }
+    }
+    if (numColored != static_cast<std::size_t>(gridView.size(0)))
+        DUNE_THROW(Dune::GridError, "The colors contain " << numColored << " elements");
+
+    // Assemble vertex data color by color, each color concurrently without locks
+    std::vector<double> vertexLength(gridView.size(1), 0.0);
+    for (unsigned int c=0; c<coloring.numColors(); c++) {
+        threads.clear();
+        for (unsigned int r=0; r<numThreads; r++)
+            threads.push_back(std::thread(assemble<Coloring, GridView>,
+                                          std::cref(coloring), std::cref(gridView), c, r, numThreads,
+                                          std::ref(vertexLength)));
+        for (unsigned int r=0; r<numThreads; r++)
+            threads[r].join();
+    }
+
+    double sumVertexLength = 0;
+    for (std::size_t v=0; v<vertexLength.size(); v++)
+        sumVertexLength += vertexLength[v];
+    if (std::abs(sumVertexLength - totalLength) > 1e-10)
+        DUNE_THROW(Dune::GridError, "The colored assembly differs from the sequential one");
+
+    return 0;
+}
+// //////////////////////////////////
+//   Error handler
+// /////////////////////////////////
+catch (Dune::Exception e) {
+    std::cout << e << std::endl;
+    return 1;
+}
@@ -0,0 +1,325 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#include <config.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <dune/foamgrid/foamgrid.hh>
+
+#include "networkgrids.hh"
+
+typedef Dune::FoamGrid<3> Grid;
+typedef Grid::LeafGridView GridView;
+typedef Dune::FieldVector<double,3> Coordinate;
+
+Coordinate makeCoordinate(double x, double y, double z)
+{
+    Coordinate result;
+    result[0] = x;
+    result[1] = y;
+    result[2] = z;
+    return result;
+}
+
+/** \brief The leaf vertex at a position */
+GridView::Codim<1>::EntityPointer findVertex(const GridView& gridView, const Coordinate& pos)
+{
+    typedef GridView::Codim<1>::Iterator VertexIterator;
+    for (VertexIterator vIt = gridView.begin<1>(); vIt != gridView.end<1>(); ++vIt)
+        if ((vIt->geometry().corner(0) - pos).two_norm() < 1e-10)
+            return vIt;
+    DUNE_THROW(Dune::GridError, "No leaf vertex at " << pos);
+}
+
+/** \brief Check the leaf grid after growth
+ *
+ * The leaf indices are consecutive, the neighbor relation is symmetric, and the
+ * boundary segment indices enumerate the boundary intersections.
+ */
+void checkGrid(const Grid& grid, std::size_t numElements, std::size_t numVertices, std::size_t numBoundary, double length)
+{
+    const GridView gridView = grid.leafGridView();
+    const GridView::IndexSet& indexSet = gridView.indexSet();
+
+    if (static_cast<std::size_t>(gridView.size(0)) != numElements || static_cast<std::size_t>(gridView.size(1)) != numVertices)
+        DUNE_THROW(Dune::GridError, "The leaf grid has " << gridView.size(0) << " elements and "
+                   << gridView.size(1) << " vertices, expected " << numElements << " and " << numVertices);
+    if (grid.numBoundarySegments() != numBoundary)
+        DUNE_THROW(Dune::GridError, "The grid has " << grid.numBoundarySegments() << " boundary segments, expected " << numBoundary);
+
+    std::vector<bool> seen(numVertices, false);
+    typedef GridView::Codim<1>::Iterator VertexIterator;
+    for (VertexIterator vIt = gridView.begin<1>(); vIt != gridView.end<1>(); ++vIt) {
+        const std::size_t index = indexSet.index(*vIt);
+        if (index >= numVertices || seen[index])
+            DUNE_THROW(Dune::GridError, "Leaf vertex index " << index << " is out of range or not unique");
+        seen[index] = true;
+    }
+
+    std::vector<bool> boundarySeen(numBoundary, false);
+    seen.assign(numElements, false);
+    double sum = 0;
+
+    typedef GridView::Codim<0>::Iterator ElementIterator;
+    typedef GridView::IntersectionIterator IntersectionIterator;
+    for (ElementIterator eIt = gridView.begin<0>(); eIt != gridView.end<0>(); ++eIt) {
+        const std::size_t index = indexSet.index(*eIt);
+        if (index >= numElements || seen[index])
+            DUNE_THROW(Dune::GridError, "Leaf element index " << index << " is out of range or not unique");
+        seen[index] = true;
+        sum += eIt->geometry().volume();
+
+        for (IntersectionIterator iIt = gridView.ibegin(*eIt); iIt != gridView.iend(*eIt); ++iIt) {
+            if (iIt->boundary()) {
+                const std::size_t segment = iIt->boundarySegmentIndex();
+                if (segment >= numBoundary || boundarySeen[segment])
+                    DUNE_THROW(Dune::GridError, "Boundary segment index " << segment << " is out of range or not unique");
+                boundarySeen[segment] = true;
+            }
+
+            if (!iIt->neighbor())
+                continue;
+
+            bool found = false;
+            GridView::Codim<0>::EntityPointer outside = iIt->outside();
+            for (IntersectionIterator oIt = gridView.ibegin(*outside); oIt != gridView.iend(*outside); ++oIt)
+                if (oIt->neighbor() && oIt->outside() == iIt->inside()
+                    && oIt->indexInInside() == iIt->indexInOutside())
+                    found = true;
+            if (!found)
+                DUNE_THROW(Dune::GridError, "Neighbor relation is not symmetric");
+        }
+    }
+
+    if (std::find(boundarySeen.begin(), boundarySeen.end(), false) != boundarySeen.end())
+        DUNE_THROW(Dune::GridError, "Not every boundary segment index is used");
+    if (std::abs(sum - length) > 1e-10)
+        DUNE_THROW(Dune::GridError, "The total length of the grid is " << sum << ", expected " << length);
+}
+
+/** \brief Check that the leaf index map carries the vertex positions of a growth step over */
+void checkIndexMap(const Grid& grid, const std::vector<Coordinate>& oldPositions,
+                   const std::vector<Coordinate>& insertedPositions)
+{
+    typedef Dune::FoamGridLeafIndexMap<1> IndexMap;
+    const IndexMap& indexMap = grid.leafIndexMap();
+    if (!indexMap.valid() || !indexMap.topologyChanged())
+        DUNE_THROW(Dune::GridError, "grow() did not record the leaf index map");
+
+    std::vector<Coordinate> positions;
+    indexMap.transferVertexData(oldPositions, positions);
+
+    typedef GridView::Codim<1>::Iterator VertexIterator;
+    const GridView gridView = grid.leafGridView();
+    for (VertexIterator vIt = gridView.begin<1>(); vIt != gridView.end<1>(); ++vIt) {
+        const std::size_t index = gridView.indexSet().index(*vIt);
+        const IndexMap::Entry& entry = indexMap.vertex(index);
+        const Coordinate expected = (entry.origin == IndexMap::inserted)
+                                    ? insertedPositions[entry.oldIndex[0]] : positions[index];
+        if ((vIt->geometry().corner(0) - expected).two_norm() > 1e-10)
+            DUNE_THROW(Dune::GridError, "The leaf index map does not describe leaf vertex " << index);
+    }
+}
+
+/** \brief The positions of the leaf vertices, by leaf index */
+std::vector<Coordinate> leafPositions(const Grid& grid)
+{
+    const GridView gridView = grid.leafGridView();
+    std::vector<Coordinate> positions(gridView.size(1));
+    typedef GridView::Codim<1>::Iterator VertexIterator;
+    for (VertexIterator vIt = gridView.begin<1>(); vIt != gridView.end<1>(); ++vIt)
+        positions[gridView.indexSet().index(*vIt)] = vIt->geometry().corner(0);
+    return positions;
+}
+
+int main (int argc, char *argv[]) try
+{
+    std::auto_ptr<Grid> grid(makeTJunction<Grid>(0));
+    checkGrid(*grid, 3, 4, 3, 3);
+
+    // Extend the tip at (1,0,0): the old tip is inside now, the new one takes its boundary segment
+    std::vector<Coordinate> positions = leafPositions(*grid);
+    std::vector<Coordinate> inserted(1, Coordinate(0));
+    inserted[0][0] = 2;
+    const unsigned int tip = grid->insertVertex(inserted[0]);
+    grid->insertElement(*findVertex(grid->leafGridView(), makeCoordinate(1,0,0)), tip);
+    if (!grid->grow())
+        DUNE_THROW(Dune::GridError, "grow() did not change the grid");
+    checkIndexMap(*grid, positions, inserted);
+    grid->postAdapt();
+    checkGrid(*grid, 4, 5, 3, 4);
+
+    // Split the new tip into two, queued in reverse order of growth
+    positions = leafPositions(*grid);
+    inserted.assign(3, Coordinate(0));
+    inserted[0] = makeCoordinate(3,1,0);
+    inserted[1] = makeCoordinate(3,-1,0);
+    inserted[2] = makeCoordinate(2.5,0.5,0);
+    for (int i=0; i<3; i++)
+        grid->insertVertex(inserted[i]);
+    grid->insertElement(2, 0);
+    grid->insertElement(*findVertex(grid->leafGridView(), makeCoordinate(2,0,0)), 2);
+    grid->insertElement(*findVertex(grid->leafGridView(), makeCoordinate(2,0,0)), 1);
+    grid->grow();
+    checkIndexMap(*grid, positions, inserted);
+    grid->postAdapt();
+    const double branchLength = 2*std::sqrt(0.5) + std::sqrt(2.0);
+    checkGrid(*grid, 7, 8, 4, 4 + branchLength);
+
+    // Refine the first segment and attach to its midpoint, which lives on level 1
+    typedef Grid::Codim<0>::LeafIterator LeafIterator;
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->geometry().center()[0] < 0)
+            grid->mark(1, *eIt);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+    checkGrid(*grid, 8, 9, 4, 4 + branchLength);
+
+    // Elements grow() cannot insert are rejected when they are queued
+    bool thrown = false;
+    try {
+        grid->insertElement(*findVertex(grid->leafGridView(), makeCoordinate(-0.5,0,0)),
+                            *findVertex(grid->leafGridView(), makeCoordinate(0,1,0)));
+    } catch (Dune::NotImplemented) {
+        thrown = true;
+    }
+    if (!thrown)
+        DUNE_THROW(Dune::GridError, "An element between vertices on different levels was queued");
+
+    thrown = false;
+    const unsigned int loop = grid->insertVertex(makeCoordinate(-0.5,0,1));
+    try {
+        grid->insertElement(loop, loop);
+    } catch (Dune::GridError) {
+        thrown = true;
+    }
+    if (!thrown)
+        DUNE_THROW(Dune::GridError, "An element from a vertex to itself was queued");
+
+    thrown = false;
+    const unsigned int coincident = grid->insertVertex(makeCoordinate(2,0,0));
+    try {
+        grid->insertElement(*findVertex(grid->leafGridView(), makeCoordinate(2,0,0)), coincident);
+    } catch (Dune::GridError) {
+        thrown = true;
+    }
+    if (!thrown)
+        DUNE_THROW(Dune::GridError, "An element of length zero was queued");
+
+    // Only unused vertices are queued, hence the grid can be adapted again
+    if (grid->grow())
+        DUNE_THROW(Dune::GridError, "grow() changed the grid although all elements were rejected");
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+    checkGrid(*grid, 8, 9, 4, 4 + branchLength);
+
+    positions = leafPositions(*grid);
+    inserted.assign(1, makeCoordinate(-0.5,0,1));
+    grid->insertVertex(inserted[0]);
+    grid->insertElement(*findVertex(grid->leafGridView(), makeCoordinate(-0.5,0,0)), 0);
+    grid->grow();
+    checkIndexMap(*grid, positions, inserted);
+    grid->postAdapt();
+    checkGrid(*grid, 9, 10, 5, 5 + branchLength);
+
+    // The new element can be refined and coarsened like any other
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->geometry().center()[2] > 0)
+            grid->mark(1, *eIt);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+    checkGrid(*grid, 10, 11, 5, 5 + branchLength);
+
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->geometry().center()[2] > 0)
+            grid->mark(-1, *eIt);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+    checkGrid(*grid, 9, 10, 5, 5 + branchLength);
+
+    // The sons carrying the new element cannot be coarsened, their midpoint must stay
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->geometry().center()[0] < 0 && eIt->geometry().center()[2] == 0)
+            grid->mark(-1, *eIt);
+    if (grid->preAdapt())
+        DUNE_THROW(Dune::GridError, "preAdapt() wants to coarsen the sons carrying the new element");
+    grid->adapt();
+    grid->postAdapt();
+    checkGrid(*grid, 9, 10, 5, 5 + branchLength);
+
+    // Prune the branch at the tip again: fewer boundary segments than before
+    positions = leafPositions(*grid);
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->geometry().center()[0] > 2)
+            grid->removeElement(*eIt);
+    grid->grow();
+    checkIndexMap(*grid, positions, std::vector<Coordinate>());
+    grid->postAdapt();
+    checkGrid(*grid, 6, 7, 4, 5);
+
+    // Elements created by grow() have no father, even on level 1
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->geometry().center()[2] > 0 && eIt->hasFather())
+            DUNE_THROW(Dune::GridError, "An inserted element has a father");
+
+    // Elements with a father cannot be removed
+    thrown = false;
+    LeafIterator eIt = grid->leafbegin<0>();
+    while (eIt != grid->leafend<0>() && !eIt->hasFather())
+        ++eIt;
+    if (eIt == grid->leafend<0>())
+        DUNE_THROW(Dune::GridError, "No leaf element has a father");
+    try {
+        grid->removeElement(*eIt);
+    } catch (Dune::NotImplemented) {
+        thrown = true;
+    }
+    if (!thrown)
+        DUNE_THROW(Dune::GridError, "An element with a father was queued for removal");
+
+    // The inserted element cannot be queued twice, and the queue blocks refinement
+    eIt = grid->leafbegin<0>();
+    while (eIt->geometry().center()[2] <= 0)
+        ++eIt;
+    grid->removeElement(*eIt);
+    thrown = false;
+    try {
+        grid->removeElement(*eIt);
+    } catch (Dune::GridError) {
+        thrown = true;
+    }
+    if (!thrown)
+        DUNE_THROW(Dune::GridError, "An element was queued for removal twice");
+
+    thrown = false;
+    try {
+        grid->globalRefine(1);
+    } catch (Dune::InvalidStateException) {
+        thrown = true;
+    }
+    if (!thrown)
+        DUNE_THROW(Dune::GridError, "The grid was refined while changes were queued");
+
+    // The rejected requests left the queue usable
+    if (!grid->grow())
+        DUNE_THROW(Dune::GridError, "grow() did not remove the queued element");
+    grid->postAdapt();
+    checkGrid(*grid, 5, 6, 3, 4);
+
+    return 0;
+}
+// //////////////////////////////////
+//   Error handler
+// /////////////////////////////////
+catch (Dune::Exception e) {
+    std::cout << e << std::endl;
+    return 1;
+}
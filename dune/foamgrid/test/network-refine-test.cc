@@ -0,0 +1,467 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#include <config.h>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <dune/grid/test/gridcheck.cc>
+#include <dune/grid/test/checkintersectionit.cc>
+#include <dune/grid/test/checkgeometryinfather.cc>
+#include <dune/grid/common/gridinfo.hh>
+
+#include <dune/foamgrid/foamgrid.hh>
+
+#include "networkgrids.hh"
+
+/** \brief Check that every leaf neighbor relation is symmetric and count the intersections */
+template <class GridView>
+void checkNeighbors(const GridView& gridView, std::size_t expectedBoundary)
+{
+    typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+    typedef typename GridView::IntersectionIterator IntersectionIterator;
+
+    std::size_t numBoundary = 0;
+    double length = 0;
+
+    for (ElementIterator eIt = gridView.template begin<0>(); eIt != gridView.template end<0>(); ++eIt) {
+        length += eIt->geometry().volume();
+
+        for (IntersectionIterator iIt = gridView.ibegin(*eIt); iIt != gridView.iend(*eIt); ++iIt) {
+            if (iIt->boundary())
+                ++numBoundary;
+            if (!iIt->neighbor())
+                continue;
+
+            // The neighbor has to see this element across the same point
+            bool found = false;
+            typename GridView::template Codim<0>::EntityPointer outside = iIt->outside();
+            for (IntersectionIterator oIt = gridView.ibegin(*outside); oIt != gridView.iend(*outside); ++oIt)
+                if (oIt->neighbor() && oIt->outside() == iIt->inside()
+                    && oIt->indexInInside() == iIt->indexInOutside())
+                    found = true;
+
+            if (!found)
+                DUNE_THROW(Dune::GridError, "Neighbor relation is not symmetric");
+        }
+    }
+
+    if (numBoundary != expectedBoundary)
+        DUNE_THROW(Dune::GridError, "Found " << numBoundary << " boundary intersections, expected " << expectedBoundary);
+
+    if (std::abs(length - (2 + std::sqrt(2.0))) > 1e-10)
+        DUNE_THROW(Dune::GridError, "The total length of the grid changed to " << length);
+}
+
+/** \brief Check that the leaf indices are consecutive and that the vertices of the elements agree with them */
+template <class GridView>
+void checkLeafIndices(const GridView& gridView)
+{
+    typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+    typedef typename GridView::template Codim<1>::Iterator VertexIterator;
+
+    const typename GridView::IndexSet& indexSet = gridView.indexSet();
+
+    std::vector<bool> seen(indexSet.size(1), false);
+    for (VertexIterator vIt = gridView.template begin<1>(); vIt != gridView.template end<1>(); ++vIt) {
+        const std::size_t index = indexSet.index(*vIt);
+        if (index >= seen.size() || seen[index])
+            DUNE_THROW(Dune::GridError, "Leaf vertex index " << index << " is out of range or not unique");
+        seen[index] = true;
+    }
+
+    seen.assign(indexSet.size(0), false);
+    for (ElementIterator eIt = gridView.template begin<0>(); eIt != gridView.template end<0>(); ++eIt) {
+        const std::size_t index = indexSet.index(*eIt);
+        if (index >= seen.size() || seen[index])
+            DUNE_THROW(Dune::GridError, "Leaf element index " << index << " is out of range or not unique");
+        seen[index] = true;
+
+        // The vertex of an element may be a coarser copy of a leaf vertex
+        for (int i=0; i<2; i++) {
+            const Dune::FieldVector<double,3> corner = eIt->geometry().corner(i);
+            const std::size_t subIndex = indexSet.subIndex(*eIt, i, 1);
+
+            bool found = false;
+            for (VertexIterator vIt = gridView.template begin<1>(); vIt != gridView.template end<1>(); ++vIt)
+                if (indexSet.index(*vIt) == subIndex) {
+                    found = true;
+                    if ((vIt->geometry().corner(0) - corner).two_norm() > 1e-10)
+                        DUNE_THROW(Dune::GridError, "Vertex " << i << " of leaf element " << index
+                                   << " has the index of another vertex");
+                }
+
+            if (!found)
+                DUNE_THROW(Dune::GridError, "Vertex " << i << " of leaf element " << index << " has no leaf index");
+        }
+    }
+}
+
+/** \brief The element centers and vertex positions of the leaf grid, by leaf index */
+template <class GridView>
+void leafPositions(const GridView& gridView,
+                   std::vector<Dune::FieldVector<double,3> >& centers,
+                   std::vector<Dune::FieldVector<double,3> >& positions)
+{
+    const typename GridView::IndexSet& indexSet = gridView.indexSet();
+
+    centers.resize(indexSet.size(0));
+    typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+    for (ElementIterator eIt = gridView.template begin<0>(); eIt != gridView.template end<0>(); ++eIt)
+        centers[indexSet.index(*eIt)] = eIt->geometry().center();
+
+    positions.resize(indexSet.size(1));
+    typedef typename GridView::template Codim<1>::Iterator VertexIterator;
+    for (VertexIterator vIt = gridView.template begin<1>(); vIt != gridView.template end<1>(); ++vIt)
+        positions[indexSet.index(*vIt)] = vIt->geometry().corner(0);
+}
+
+/** \brief Adapt the grid and check that the leaf index map carries positions over correctly
+ *
+ * Sons get the center of their father, coarsened elements the mean of the centers of
+ * their sons, i.e. their own center.  The vertex positions are carried over exactly.
+ */
+template <class Grid>
+void adaptAndCheckIndexMap(Grid& grid)
+{
+    typedef Dune::FieldVector<double,3> Coordinate;
+    std::vector<Coordinate> oldCenters, oldPositions, centers, positions, newCenters, newPositions;
+    leafPositions(grid.leafGridView(), oldCenters, oldPositions);
+
+    grid.preAdapt();
+    grid.adapt();
+
+    const Dune::FoamGridLeafIndexMap<1>& indexMap = grid.leafIndexMap();
+    if (!indexMap.valid() || indexMap.oldSize(0) != oldCenters.size() || indexMap.size(0) != static_cast<std::size_t>(grid.size(0)))
+        DUNE_THROW(Dune::GridError, "The leaf index map does not match the grid");
+
+    indexMap.transferElementData(oldCenters, centers);
+    indexMap.transferVertexData(oldPositions, positions);
+    leafPositions(grid.leafGridView(), newCenters, newPositions);
+
+    typedef typename Grid::template Codim<0>::LeafIterator LeafIterator;
+    const typename Grid::LeafIndexSet& indexSet = grid.leafIndexSet();
+    for (LeafIterator eIt = grid.template leafbegin<0>(); eIt != grid.template leafend<0>(); ++eIt) {
+        const std::size_t index = indexSet.index(*eIt);
+        Coordinate expected = newCenters[index];
+        if (indexMap.element(index).origin == Dune::FoamGridLeafIndexMap<1>::refined) {
+            if (indexMap.element(index).childNumber != static_cast<int>(2*eIt->geometryInFather().corner(0)[0] + 0.5))
+                DUNE_THROW(Dune::GridError, "Wrong child number in the leaf index map");
+            expected = eIt->father()->geometry().center();
+        }
+
+        if ((centers[index] - expected).two_norm() > 1e-10)
+            DUNE_THROW(Dune::GridError, "Element data of leaf element " << index << " was not carried over");
+    }
+
+    for (std::size_t i=0; i<positions.size(); i++)
+        if ((positions[i] - newPositions[i]).two_norm() > 1e-10)
+            DUNE_THROW(Dune::GridError, "Vertex data of leaf vertex " << i << " was not carried over");
+
+    grid.postAdapt();
+}
+
+/** \brief The largest difference of the leaf indices of the two vertices of a leaf element */
+template <class GridView>
+std::size_t bandwidth(const GridView& gridView)
+{
+    std::size_t result = 0;
+    typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+    for (ElementIterator eIt = gridView.template begin<0>(); eIt != gridView.template end<0>(); ++eIt) {
+        const std::size_t a = gridView.indexSet().subIndex(*eIt, 0, 1);
+        const std::size_t b = gridView.indexSet().subIndex(*eIt, 1, 1);
+        result = std::max(result, std::max(a, b) - std::min(a, b));
+    }
+    return result;
+}
+
+/** \brief Numbering the leaf entities along the network reduces the bandwidth */
+void checkNetworkOrdering()
+{
+    typedef Dune::FoamGrid<3> Grid;
+    std::auto_ptr<Grid> grid(makeComb<Grid>(20, 10));
+    grid->globalRefine(1);
+
+    // Refine the teeth at every other junction, which appends vertices all over the grid
+    typedef Grid::Codim<0>::LeafIterator LeafIterator;
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (static_cast<int>(eIt->geometry().center()[0] + 0.5) % 2 == 0 && eIt->geometry().center()[1] > 0)
+            grid->mark(1, *eIt);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+
+    const std::size_t levelBandwidth = bandwidth(grid->leafGridView());
+    grid->setLeafOrdering(Dune::networkOrder);
+    const std::size_t networkBandwidth = bandwidth(grid->leafGridView());
+    std::cout << "Bandwidth in level order: " << levelBandwidth
+              << ", in network order: " << networkBandwidth << std::endl;
+
+    if (networkBandwidth >= levelBandwidth)
+        DUNE_THROW(Dune::GridError, "The network order does not reduce the bandwidth");
+    checkLeafIndices(grid->leafGridView());
+
+    // The ordering is kept through adaptation, and the index map follows it
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->level() == 2)
+            grid->mark(-1, *eIt);
+        else if (eIt->geometry().center()[1] == 0)
+            grid->mark(1, *eIt);
+    adaptAndCheckIndexMap(*grid);
+
+    checkLeafIndices(grid->leafGridView());
+    if (bandwidth(grid->leafGridView()) > 2*networkBandwidth)
+        DUNE_THROW(Dune::GridError, "The network order was not applied by adapt()");
+
+    gridcheck(*grid);
+}
+
+/** \brief Flattening keeps the leaf grid, its indices and ids, and drops the hierarchy */
+void checkFlatten()
+{
+    typedef Dune::FoamGrid<3> Grid;
+    typedef Grid::LeafGridView GridView;
+    typedef Dune::FieldVector<double,3> Coordinate;
+
+    std::auto_ptr<Grid> grid(makeTJunction<Grid>());
+    grid->globalRefine(1);
+
+    typedef Grid::Codim<0>::LeafIterator LeafIterator;
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->geometry().center()[2] > 0)
+            grid->mark(1, *eIt);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+
+    std::vector<Coordinate> centers, positions, newCenters, newPositions;
+    leafPositions(grid->leafGridView(), centers, positions);
+
+    const GridView::IndexSet& indexSet = grid->leafIndexSet();
+    std::vector<Grid::GlobalIdSet::IdType> ids(grid->size(1));
+    typedef GridView::Codim<1>::Iterator VertexIterator;
+    for (VertexIterator vIt = grid->leafGridView().begin<1>(); vIt != grid->leafGridView().end<1>(); ++vIt)
+        ids[indexSet.index(*vIt)] = grid->globalIdSet().id(*vIt);
+
+    grid->flatten();
+
+    if (grid->maxLevel() != 0 || grid->size(0, 0) != grid->size(0) || grid->size(0, 1) != grid->size(1))
+        DUNE_THROW(Dune::GridError, "flatten() did not turn the leaf grid into level 0");
+    if (!grid->leafIndexMap().valid() || grid->leafIndexMap().topologyChanged())
+        DUNE_THROW(Dune::GridError, "flatten() did not record the kept leaf entities");
+
+    leafPositions(grid->leafGridView(), newCenters, newPositions);
+    if (newCenters.size() != centers.size() || newPositions.size() != positions.size())
+        DUNE_THROW(Dune::GridError, "flatten() changed the size of the leaf grid");
+    for (std::size_t i=0; i<centers.size(); i++)
+        if ((centers[i] - newCenters[i]).two_norm() > 1e-10)
+            DUNE_THROW(Dune::GridError, "flatten() changed the index of leaf element " << i);
+    for (std::size_t i=0; i<positions.size(); i++)
+        if ((positions[i] - newPositions[i]).two_norm() > 1e-10)
+            DUNE_THROW(Dune::GridError, "flatten() changed the index of leaf vertex " << i);
+
+    for (VertexIterator vIt = grid->leafGridView().begin<1>(); vIt != grid->leafGridView().end<1>(); ++vIt) {
+        const std::size_t index = indexSet.index(*vIt);
+        if (grid->globalIdSet().id(*vIt) != ids[index] || grid->levelIndexSet(0).index(*vIt) != static_cast<int>(index))
+            DUNE_THROW(Dune::GridError, "flatten() changed the id or level index of leaf vertex " << index);
+    }
+
+    checkNeighbors(grid->leafGridView(), 3);
+    checkLeafIndices(grid->leafGridView());
+    gridcheck(*grid);
+
+    // The flat grid can be refined and coarsened down to itself
+    grid->globalRefine(1);
+    checkNeighbors(grid->leafGridView(), 3);
+    grid->globalRefine(-1);
+    if (grid->size(0) != static_cast<int>(centers.size()))
+        DUNE_THROW(Dune::GridError, "Wrong leaf grid size after refining the flat grid");
+    gridcheck(*grid);
+}
+
+/** \brief Compacting the entity storage keeps the grid, its indices and ids */
+void checkCompaction()
+{
+    typedef Dune::FoamGrid<3> Grid;
+    typedef Grid::LeafGridView GridView;
+    typedef Dune::FieldVector<double,3> Coordinate;
+
+    std::auto_ptr<Grid> grid(makeComb<Grid>(40, 20));
+    grid->setCompactionThreshold(1);
+    grid->globalRefine(2);
+
+    // Coarsen the teeth, which leaves most slots of level 2 dead
+    typedef Grid::Codim<0>::LeafIterator LeafIterator;
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->geometry().center()[1] > 0)
+            grid->mark(-1, *eIt);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+    if (grid->bytesReclaimed() != 0)
+        DUNE_THROW(Dune::GridError, "postAdapt() compacted the storage although it was disabled");
+
+    std::vector<Coordinate> centers, positions, newCenters, newPositions;
+    leafPositions(grid->leafGridView(), centers, positions);
+
+    const GridView::IndexSet& indexSet = grid->leafIndexSet();
+    std::vector<Grid::GlobalIdSet::IdType> ids(grid->size(0));
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        ids[indexSet.index(*eIt)] = grid->globalIdSet().id(*eIt);
+
+    const Dune::FoamGridMemoryUsage before = grid->memoryUsage();
+    const std::size_t bytes = grid->compactStorage();
+    std::cout << "Compaction released " << bytes << " bytes" << std::endl;
+    if (bytes == 0)
+        DUNE_THROW(Dune::GridError, "compactStorage() did not release any memory");
+
+    // The memory report sees the released storage
+    const Dune::FoamGridMemoryUsage after = grid->memoryUsage();
+    std::cout << after;
+    if (after.entities.size() != static_cast<std::size_t>(grid->maxLevel()+1) || after.total() + bytes > before.total())
+        DUNE_THROW(Dune::GridError, "The memory usage does not reflect the compaction");
+    if (after.level(2) >= before.level(2) || after.level(0) != before.level(0))
+        DUNE_THROW(Dune::GridError, "The memory usage of level 2 does not reflect the compaction");
+
+    leafPositions(grid->leafGridView(), newCenters, newPositions);
+    for (std::size_t i=0; i<centers.size(); i++)
+        if ((centers[i] - newCenters[i]).two_norm() > 1e-10)
+            DUNE_THROW(Dune::GridError, "compactStorage() changed the index of leaf element " << i);
+    for (std::size_t i=0; i<positions.size(); i++)
+        if ((positions[i] - newPositions[i]).two_norm() > 1e-10)
+            DUNE_THROW(Dune::GridError, "compactStorage() changed the index of leaf vertex " << i);
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (grid->globalIdSet().id(*eIt) != ids[indexSet.index(*eIt)])
+            DUNE_THROW(Dune::GridError, "compactStorage() changed the id of leaf element " << indexSet.index(*eIt));
+
+    checkLeafIndices(grid->leafGridView());
+    checkGeometryInFather(*grid);
+    gridcheck(*grid);
+
+    // Coarsening the teeth once more releases memory in postAdapt() by default
+    grid->setCompactionThreshold(0.25);
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->level() == 1 && eIt->geometry().center()[1] > 0)
+            grid->mark(-1, *eIt);
+    adaptAndCheckIndexMap(*grid);
+    if (grid->bytesReclaimed() == 0)
+        DUNE_THROW(Dune::GridError, "postAdapt() did not compact the storage");
+
+    checkLeafIndices(grid->leafGridView());
+    gridcheck(*grid);
+}
+
+/** \brief Uniform refinement of a locally refined grid bisects every leaf element once */
+void checkGlobalRefineAfterAdapt()
+{
+    typedef Dune::FoamGrid<3> Grid;
+    std::auto_ptr<Grid> grid(makeTJunction<Grid>());
+    grid->globalRefine(1);
+
+    // The leaf elements at the junction are on level 2, the others on level 1
+    typedef Grid::Codim<0>::LeafIterator LeafIterator;
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->geometry().corner(0).two_norm() < 1e-10 || eIt->geometry().corner(1).two_norm() < 1e-10)
+            grid->mark(1, *eIt);
+    adaptAndCheckIndexMap(*grid);
+    if (grid->maxLevel() != 2 || grid->size(0) != 9 || grid->size(1) != 10)
+        DUNE_THROW(Dune::GridError, "Wrong leaf grid size after local refinement");
+
+    grid->globalRefine(1);
+    if (grid->maxLevel() != 3 || grid->size(0) != 18 || grid->size(1) != 19)
+        DUNE_THROW(Dune::GridError, "globalRefine(1) of a locally refined grid gave " << grid->size(0)
+                   << " elements and " << grid->size(1) << " vertices, expected 18 and 19");
+
+    checkNeighbors(grid->leafGridView(), 3);
+    checkLeafIndices(grid->leafGridView());
+    checkGeometryInFather(*grid);
+    gridcheck(*grid);
+}
+
+int main (int argc, char *argv[]) try
+{
+    typedef Dune::FoamGrid<3> Grid;
+    std::auto_ptr<Grid> grid(makeTJunction<Grid>());
+
+    checkNeighbors(grid->leafGridView(), 3);
+
+    // Uniform refinement
+    grid->globalRefine(2);
+    Dune::gridinfo(*grid);
+
+    if (grid->maxLevel() != 2 || grid->size(0) != 12 || grid->size(1) != 13)
+        DUNE_THROW(Dune::GridError, "Wrong leaf grid size after globalRefine(2)");
+
+    checkNeighbors(grid->leafGridView(), 3);
+    checkGeometryInFather(*grid);
+    gridcheck(*grid);
+
+    // Local refinement of the leaf elements at the junction
+    typedef Grid::Codim<0>::LeafIterator LeafIterator;
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->geometry().corner(0).two_norm() < 1e-10 || eIt->geometry().corner(1).two_norm() < 1e-10)
+            grid->mark(1, *eIt);
+
+    adaptAndCheckIndexMap(*grid);
+
+    if (grid->maxLevel() != 3 || grid->size(0) != 15)
+        DUNE_THROW(Dune::GridError, "Wrong leaf grid size after local refinement");
+
+    checkNeighbors(grid->leafGridView(), 3);
+    checkLeafIndices(grid->leafGridView());
+    checkIntersectionIterator(*grid);
+
+    // Refine at one tip and coarsen at the junction in the same step
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->level() == 3)
+            grid->mark(-1, *eIt);
+        else if (eIt->geometry().corner(1)[0] > 1-1e-10)
+            grid->mark(1, *eIt);
+
+    adaptAndCheckIndexMap(*grid);
+
+    if (grid->maxLevel() != 3 || grid->size(0) != 13 || grid->size(1) != 14)
+        DUNE_THROW(Dune::GridError, "Wrong leaf grid size after mixed adaptation");
+
+    checkNeighbors(grid->leafGridView(), 3);
+    checkLeafIndices(grid->leafGridView());
+
+    // Undo the local refinement
+    for (LeafIterator eIt = grid->leafbegin<0>(); eIt != grid->leafend<0>(); ++eIt)
+        if (eIt->level() == 3)
+            grid->mark(-1, *eIt);
+
+    adaptAndCheckIndexMap(*grid);
+
+    if (grid->maxLevel() != 2 || grid->size(0) != 12 || grid->size(1) != 13)
+        DUNE_THROW(Dune::GridError, "Wrong leaf grid size after coarsening");
+
+    checkNeighbors(grid->leafGridView(), 3);
+    checkLeafIndices(grid->leafGridView());
+
+    // Back to the macro grid
+    grid->globalRefine(-2);
+    if (grid->leafIndexMap().valid())
+        DUNE_THROW(Dune::GridError, "globalRefine() did not invalidate the leaf index map");
+    if (grid->maxLevel() != 0 || grid->size(0) != 3)
+        DUNE_THROW(Dune::GridError, "Wrong leaf grid size after globalRefine(-2)");
+
+    checkNeighbors(grid->leafGridView(), 3);
+    gridcheck(*grid);
+
+    checkGlobalRefineAfterAdapt();
+    checkNetworkOrdering();
+    checkFlatten();
+    checkCompaction();
+
+    return 0;
+}
+// //////////////////////////////////
+//   Error handler
+// /////////////////////////////////
+catch (Dune::Exception e) {
+    std::cout << e << std::endl;
+    return 1;
+}
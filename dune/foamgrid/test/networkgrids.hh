@@ -0,0 +1,115 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+#ifndef DUNE_FOAMGRID_NETWORKGRIDS_HH
+#define DUNE_FOAMGRID_NETWORKGRIDS_HH
+
+/** \file
+ * \brief Small networks shared by the tests
+ *
+ * The T-junction and the comb are 3d networks, the star and the polyline
+ * work in any world dimension of at least two.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <dune/foamgrid/foamgrid.hh>
+
+/** \brief A T-junction: three segments from the origin to (-1,0,0), (1,0,0) and (0,1,z)
+ *
+ * \param z The height of the end of the third segment, which lifts it out of the plane of the others
+ */
+template <class Grid>
+Grid* makeTJunction(typename Grid::ctype z = 1)
+{
+    const typename Grid::ctype coordinates[] = {0,0,0, -1,0,0, 1,0,0, 0,1,z};
+    const unsigned int connectivity[] = {0,1, 0,2, 0,3};
+
+    Dune::GridFactory<Grid> factory;
+    factory.insertVertices(coordinates, 4);
+    factory.insertElements(connectivity, 3);
+    return factory.createGrid();
+}
+
+/** \brief A comb: a backbone of n segments with a tooth of m segments at each inner vertex */
+template <class Grid>
+Grid* makeComb(unsigned int n, unsigned int m)
+{
+    std::vector<typename Grid::ctype> coordinates;
+    std::vector<unsigned int> connectivity;
+    for (unsigned int i=0; i<=n; i++) {
+        coordinates.push_back(i);
+        coordinates.push_back(0);
+        coordinates.push_back(0);
+        if (i > 0) {
+            connectivity.push_back(i-1);
+            connectivity.push_back(i);
+        }
+    }
+
+    for (unsigned int i=1; i<n; i++)
+        for (unsigned int k=1; k<=m; k++) {
+            coordinates.push_back(i);
+            coordinates.push_back(k);
+            coordinates.push_back(0);
+            connectivity.push_back(k==1 ? i : coordinates.size()/3-2);
+            connectivity.push_back(coordinates.size()/3-1);
+        }
+
+    Dune::GridFactory<Grid> factory;
+    factory.insertVertices(&coordinates[0], coordinates.size()/3);
+    factory.insertElements(&connectivity[0], connectivity.size()/2);
+    return factory.createGrid();
+}
+
+/** \brief A star of n polylines with m segments each, meeting at the origin
+ *
+ * The k-th vertex of the i-th polyline lies at k(cos(2 pi i/n), sin(2 pi i/n))
+ * in the first two coordinates.
+ *
+ * \param rise The slope of the polylines in the third coordinate, if the world has one
+ */
+template <class Grid>
+Grid* makeStar(unsigned int n, unsigned int m, typename Grid::ctype rise = 0)
+{
+    enum {dimworld = Grid::dimensionworld};
+
+    std::vector<typename Grid::ctype> coordinates(dimworld, 0);
+    std::vector<unsigned int> connectivity;
+    for (unsigned int i=0; i<n; i++)
+        for (unsigned int k=1; k<=m; k++) {
+            coordinates.push_back(k*std::cos(i*2*M_PI/n));
+            coordinates.push_back(k*std::sin(i*2*M_PI/n));
+            for (int j=2; j<dimworld; j++)
+                coordinates.push_back(j==2 ? rise*k : 0);
+            connectivity.push_back(k==1 ? 0 : coordinates.size()/dimworld-2);
+            connectivity.push_back(coordinates.size()/dimworld-1);
+        }
+
+    Dune::GridFactory<Grid> factory;
+    factory.insertVertices(&coordinates[0], coordinates.size()/dimworld);
+    factory.insertElements(&connectivity[0], connectivity.size()/2);
+    return factory.createGrid();
+}
+
+/** \brief A polyline through the given points, one segment between each two consecutive ones
+ *
+ * \param coordinates The coordinates of the points, dimworld values per point
+ */
+template <class Grid>
+Grid* makePolyline(const std::vector<typename Grid::ctype>& coordinates)
+{
+    const std::size_t numVertices = coordinates.size()/Grid::dimensionworld;
+    std::vector<unsigned int> connectivity;
+    for (std::size_t i=1; i<numVertices; i++) {
+        connectivity.push_back(i-1);
+        connectivity.push_back(i);
+    }
+
+    Dune::GridFactory<Grid> factory;
+    factory.insertVertices(&coordinates[0], numVertices);
+    factory.insertElements(&connectivity[0], connectivity.size()/2);
+    return factory.createGrid();
+}
+
+#endif
@@ -0,0 +1,34 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+/** \file
+ * \brief Explicit instantiations of FoamGrid and its factory for libdunefoamgrid
+ *
+ * foamgrid.hh declares these instantiations extern, hence programs that include it
+ * link the grid implementation from the library instead of compiling it again.
+ * Other world dimensions and coordinate types are still instantiated implicitly.
+ */
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <dune/foamgrid/foamgrid.hh>
+
+namespace Dune {
+
+    template class FoamGrid<1>;
+    template class FoamGrid<2>;
+    template class FoamGrid<3>;
+
+    template class FoamGrid<1, float>;
+    template class FoamGrid<2, float>;
+    template class FoamGrid<3, float>;
+
+    template class GridFactory<FoamGrid<1> >;
+    template class GridFactory<FoamGrid<2> >;
+    template class GridFactory<FoamGrid<3> >;
+
+    template class GridFactory<FoamGrid<1, float> >;
+    template class GridFactory<FoamGrid<2, float> >;
+    template class GridFactory<FoamGrid<3, float> >;
+
+}  // namespace Dune
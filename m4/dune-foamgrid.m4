@@ -3,5 +3,7 @@ AC_DEFUN([DUNE_FOAMGRID_CHECKS])
 
 # Additional checks needed to find the module
 AC_DEFUN([DUNE_FOAMGRID_CHECK_MODULE],[
-  DUNE_CHECK_MODULES([dune-foamgrid], [foamgrid/foamgrid.hh])
+  DUNE_CHECK_MODULES([dune-foamgrid], [foamgrid/foamgrid.hh], [dnl
+  Dune::FoamGrid<2> grid;
+  grid.globalRefine(0);])
 ])
@@ -0,0 +1,391 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set ts=8 sw=4 et sts=4:
+/** \file
+ * \brief Timings of the basic FoamGrid operations on synthetic networks
+ *
+ * Usage: foamgrid-benchmark [output file] [min segments] [max segments]
+ *
+ * For every network type and every power of ten between the minimum and the maximum
+ * number of segments (default 10^3 to 10^7) a network is generated and the grid
+ * operations are timed, once with double and once with float coordinates.  Each result
+ * is one line of the comma separated output file (default foamgrid-benchmark.csv), so
+ * that the files of two runs can be compared.
+ */
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/timer.hh>
+
+#include <dune/foamgrid/foamgrid.hh>
+
+/** \brief Vertex coordinates and segment connectivity of a network in 3d */
+struct Network
+{
+    std::vector<double> coordinates;
+    std::vector<unsigned int> connectivity;
+
+    std::size_t numVertices() const { return coordinates.size()/3; }
+    std::size_t numSegments() const { return connectivity.size()/2; }
+
+    unsigned int addVertex(const double* x)
+    {
+        coordinates.insert(coordinates.end(), x, x+3);
+        return numVertices()-1;
+    }
+
+    void addSegment(unsigned int v0, unsigned int v1)
+    {
+        connectivity.push_back(v0);
+        connectivity.push_back(v1);
+    }
+};
+
+/** \brief A binary tree grown at randomly chosen tips, n segments */
+Network randomBinaryTree(std::size_t n, unsigned int seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+
+    // A tip is an end vertex together with the direction of its segment
+    struct Tip { unsigned int vertex; double direction[3]; };
+
+    Network network;
+    const double origin[3] = {0, 0, 0};
+    const double top[3] = {0, 0, 1};
+    network.addVertex(origin);
+    network.addSegment(0, network.addVertex(top));
+    std::vector<Tip> tips(1, Tip{1, {0, 0, 1}});
+
+    while (network.numSegments() < n) {
+        const std::size_t r = std::uniform_int_distribution<std::size_t>(0, tips.size()-1)(generator);
+        const Tip tip = tips[r];
+        tips[r] = tips.back();
+        tips.pop_back();
+
+        for (int child=0; child<2 && network.numSegments()<n; child++) {
+            Tip next;
+            double norm = 0;
+            for (int i=0; i<3; i++) {
+                next.direction[i] = tip.direction[i] + 0.8*uniform(generator);
+                norm += next.direction[i]*next.direction[i];
+            }
+
+            const double length = 0.75 + 0.25*uniform(generator);
+            double x[3];
+            for (int i=0; i<3; i++) {
+                next.direction[i] /= std::sqrt(norm);
+                x[i] = network.coordinates[3*tip.vertex+i] + length*next.direction[i];
+            }
+
+            next.vertex = network.addVertex(x);
+            network.addSegment(tip.vertex, next.vertex);
+            tips.push_back(next);
+        }
+    }
+
+    return network;
+}
+
+/** \brief The edges of a cube lattice, the smallest one with at least n segments */
+Network lattice(std::size_t n)
+{
+    std::size_t k = 2;
+    while (3*k*k*(k-1) < n)
+        k++;
+
+    Network network;
+    for (std::size_t i=0; i<k; i++)
+        for (std::size_t j=0; j<k; j++)
+            for (std::size_t l=0; l<k; l++) {
+                const double x[3] = {double(l), double(j), double(i)};
+                network.addVertex(x);
+            }
+
+    const std::size_t stride[3] = {1, k, k*k};
+    for (std::size_t v=0; v<network.numVertices(); v++)
+        for (int d=0; d<3; d++)
+            if ((v/stride[d]) % k + 1 < k)
+                network.addSegment(v, v+stride[d]);
+
+    return network;
+}
+
+/** \brief A symmetric vessel tree, each vessel split into four segments
+ *
+ * The vessels bifurcate in planes rotated by 90 degrees from one generation to the
+ * next, and shrink by Murray's law.  The tree has the least number of generations
+ * that gives at least n segments.
+ */
+Network vesselTree(std::size_t n)
+{
+    const unsigned int segmentsPerVessel = 4;
+    const double angle = 0.65;
+    const double ratio = std::pow(0.5, 1.0/3.0);
+
+    int generations = 0;
+    while (segmentsPerVessel*((std::size_t(2) << generations)-1) < n)
+        generations++;
+
+    // A vessel starts at a vertex, heads in direction d and bifurcates in the plane of d and u
+    struct Vessel { unsigned int vertex; double d[3]; double u[3]; double length; int generation; };
+
+    Network network;
+    const double origin[3] = {0, 0, 0};
+    network.addVertex(origin);
+    std::vector<Vessel> stack(1, Vessel{0, {0, 0, 1}, {1, 0, 0}, 1.0, 0});
+
+    while (!stack.empty()) {
+        const Vessel vessel = stack.back();
+        stack.pop_back();
+
+        unsigned int vertex = vessel.vertex;
+        for (unsigned int s=1; s<=segmentsPerVessel; s++) {
+            double x[3];
+            for (int i=0; i<3; i++)
+                x[i] = network.coordinates[3*vessel.vertex+i] + vessel.length*s/segmentsPerVessel*vessel.d[i];
+            const unsigned int next = network.addVertex(x);
+            network.addSegment(vertex, next);
+            vertex = next;
+        }
+
+        if (vessel.generation == generations)
+            continue;
+
+        // The next bifurcation plane is spanned by the child direction and d x u
+        const double w[3] = {vessel.d[1]*vessel.u[2] - vessel.d[2]*vessel.u[1],
+                             vessel.d[2]*vessel.u[0] - vessel.d[0]*vessel.u[2],
+                             vessel.d[0]*vessel.u[1] - vessel.d[1]*vessel.u[0]};
+        for (int sign=-1; sign<=1; sign+=2) {
+            Vessel child;
+            child.vertex = vertex;
+            for (int i=0; i<3; i++) {
+                child.d[i] = std::cos(angle)*vessel.d[i] + sign*std::sin(angle)*vessel.u[i];
+                child.u[i] = w[i];
+            }
+            child.length = ratio*vessel.length;
+            child.generation = vessel.generation+1;
+            stack.push_back(child);
+        }
+    }
+
+    return network;
+}
+
+/** \brief Writes one line of results per timed operation */
+class Report
+{
+public:
+    Report(const std::string& filename)
+        : out_(filename.c_str()), checksum_(0)
+    {
+        if (!out_)
+            DUNE_THROW(Dune::IOError, "Could not open " << filename);
+        out_ << "network,ctype,segments,vertices,operation,repetitions,seconds,ns_per_segment" << std::endl;
+    }
+
+    /** \brief Set the network whose operations are reported next */
+    void setNetwork(const std::string& name, const std::string& ctype, const Network& network)
+    {
+        name_ = name;
+        ctype_ = ctype;
+        segments_ = network.numSegments();
+        vertices_ = network.numVertices();
+        std::cout << name_ << " (" << ctype_ << "): " << segments_ << " segments, "
+                  << vertices_ << " vertices" << std::endl;
+    }
+
+    /** \brief Report the total time of a number of repetitions of an operation */
+    void add(const std::string& operation, unsigned int repetitions, double seconds)
+    {
+        const double perRepetition = seconds/repetitions;
+        out_ << name_ << ',' << ctype_ << ',' << segments_ << ',' << vertices_ << ','
+             << operation << ',' << repetitions << ',' << perRepetition << ','
+             << 1e9*perRepetition/segments_ << std::endl;
+        std::cout << "  " << operation << ": " << perRepetition << " s" << std::endl;
+    }
+
+    /** \brief Collect a result of an operation so that it is not optimized away */
+    void consume(double value)
+    {
+        checksum_ += value;
+    }
+
+    double checksum() const
+    {
+        return checksum_;
+    }
+
+private:
+    std::ofstream out_;
+    std::string name_;
+    std::string ctype_;
+    std::size_t segments_;
+    std::size_t vertices_;
+    double checksum_;
+};
+
+/** \brief Repeat the cheap operations on small grids to get measurable times */
+unsigned int repetitions(std::size_t segments)
+{
+    return std::max<std::size_t>(1, 1000000/segments);
+}
+
+/** \brief Iterate over all entities of a codim of a grid view */
+template <int codim, class GridView>
+void timeIteration(const GridView& gridView, const std::string& operation, unsigned int repeat, Report& report)
+{
+    typedef typename GridView::template Codim<codim>::Iterator Iterator;
+    std::size_t sum = 0;
+    Dune::Timer timer;
+    for (unsigned int r=0; r<repeat; r++)
+        for (Iterator it = gridView.template begin<codim>(); it != gridView.template end<codim>(); ++it)
+            sum += gridView.indexSet().index(*it);
+    report.add(operation, repeat, timer.elapsed());
+    report.consume(sum);
+}
+
+/** \brief Time all operations on a grid created from a network */
+template <class Grid>
+void benchmark(const Network& network, Report& report)
+{
+    typedef typename Grid::ctype ctype;
+    typedef typename Grid::LeafGridView LeafGridView;
+    typedef typename Grid::LevelGridView LevelGridView;
+    typedef typename LeafGridView::template Codim<0>::Iterator ElementIterator;
+    typedef typename LeafGridView::IntersectionIterator IntersectionIterator;
+
+    const unsigned int repeat = repetitions(network.numSegments());
+
+    Dune::Timer timer;
+    std::vector<ctype> coordinates(network.coordinates.begin(), network.coordinates.end());
+    Dune::GridFactory<Grid> factory;
+    factory.insertVertices(&coordinates[0], network.numVertices());
+    factory.insertElements(&network.connectivity[0], network.numSegments());
+    std::auto_ptr<Grid> grid(factory.createGrid());
+    report.add("create", 1, timer.elapsed());
+
+    const LeafGridView leafView = grid->leafGridView();
+    const LevelGridView levelView = grid->levelGridView(0);
+    timeIteration<0>(leafView, "leaf-iterate-codim0", repeat, report);
+    timeIteration<1>(leafView, "leaf-iterate-codim1", repeat, report);
+    timeIteration<0>(levelView, "level-iterate-codim0", repeat, report);
+    timeIteration<1>(levelView, "level-iterate-codim1", repeat, report);
+
+    std::size_t neighbors = 0;
+    timer.reset();
+    for (unsigned int r=0; r<repeat; r++)
+        for (ElementIterator eIt = leafView.template begin<0>(); eIt != leafView.template end<0>(); ++eIt)
+            for (IntersectionIterator iIt = leafView.ibegin(*eIt); iIt != leafView.iend(*eIt); ++iIt)
+                if (iIt->neighbor())
+                    neighbors += leafView.indexSet().index(*iIt->outside());
+    report.add("intersections", repeat, timer.elapsed());
+    report.consume(neighbors);
+
+    double sum = 0;
+    typename Grid::template Codim<0>::Geometry::LocalCoordinate local(0.5);
+    timer.reset();
+    for (unsigned int r=0; r<repeat; r++)
+        for (ElementIterator eIt = leafView.template begin<0>(); eIt != leafView.template end<0>(); ++eIt) {
+            const typename Grid::template Codim<0>::Geometry geometry = eIt->geometry();
+            sum += geometry.volume() + geometry.center()[0] + geometry.global(local)[1]
+                + geometry.integrationElement(local);
+        }
+    report.add("geometry", repeat, timer.elapsed());
+    report.consume(sum);
+
+    std::vector<ctype> lengths(network.numSegments());
+    timer.reset();
+    for (unsigned int r=0; r<repeat; r++)
+        Dune::computeSegmentLengths(grid->leafCoordinates(), &lengths[0]);
+    report.add("segment-lengths", repeat, timer.elapsed());
+    report.consume(lengths[0]);
+
+    // setIndices() is private; the leaf part of it is what a renumbering recomputes
+    timer.reset();
+    grid->setLeafOrdering(Dune::levelOrder);
+    report.add("leaf-indices", 1, timer.elapsed());
+
+    timer.reset();
+    grid->setLeafOrdering(Dune::networkOrder);
+    report.add("leaf-indices-network-order", 1, timer.elapsed());
+    grid->setLeafOrdering(Dune::levelOrder);
+
+    timer.reset();
+    grid->globalRefine(1);
+    report.add("global-refine", 1, timer.elapsed());
+
+    timer.reset();
+    grid->globalRefine(-1);
+    report.add("global-coarsen", 1, timer.elapsed());
+
+    // Refine every tenth element and coarsen it again
+    typedef typename Grid::template Codim<0>::LeafIterator LeafIterator;
+    timer.reset();
+    for (LeafIterator eIt = grid->template leafbegin<0>(); eIt != grid->template leafend<0>(); ++eIt)
+        if (grid->leafIndexSet().index(*eIt) % 10 == 0)
+            grid->mark(1, *eIt);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+    report.add("adapt-refine", 1, timer.elapsed());
+
+    timer.reset();
+    for (LeafIterator eIt = grid->template leafbegin<0>(); eIt != grid->template leafend<0>(); ++eIt)
+        if (eIt->level() > 0)
+            grid->mark(-1, *eIt);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+    report.add("adapt-coarsen", 1, timer.elapsed());
+}
+
+/** \brief Time all operations on a network, with double and with float coordinates */
+void benchmarkNetwork(const std::string& name, const Network& network, Report& report)
+{
+    report.setNetwork(name, "double", network);
+    benchmark<Dune::FoamGrid<3> >(network, report);
+
+    report.setNetwork(name, "float", network);
+    benchmark<Dune::FoamGrid<3, float> >(network, report);
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    Dune::MPIHelper::instance(argc, argv);
+
+    const std::string filename = (argc > 1) ? argv[1] : "foamgrid-benchmark.csv";
+    const std::size_t minSegments = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 1000;
+    const std::size_t maxSegments = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 10000000;
+
+    Report report(filename);
+    for (std::size_t n=std::max<std::size_t>(minSegments, 1); n<=maxSegments; n*=10) {
+      benchmarkNetwork("random-binary-tree", randomBinaryTree(n, 42), report);
+      benchmarkNetwork("lattice", lattice(n), report);
+      benchmarkNetwork("vessel-tree", vesselTree(n), report);
+    }
+
+    std::cout << "Results written to " << filename << " (checksum " << report.checksum() << ")" << std::endl;
+    return 0;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+  }
+  return 1;
+}